@@ -2602,6 +2602,296 @@ gen_printf (CORE_ADDR scope, struct gdbarch *gdbarch,
   return ax;
 }
 
+/* Evaluating agent expressions locally.  */
+
+/* Memory references made by one evaluation are served from a few
+   lines of target memory, each read with a single target access.  */
+
+#define AX_EVAL_CACHE_LINES 4
+#define AX_EVAL_CACHE_LINE_SIZE 64
+
+struct ax_eval_cache
+{
+  /* Number of valid lines, and the line to replace next once they
+     are all in use.  */
+  int nlines;
+  int next;
+
+  struct
+  {
+    CORE_ADDR addr;
+    gdb_byte data[AX_EVAL_CACHE_LINE_SIZE];
+  } lines[AX_EVAL_CACHE_LINES];
+};
+
+/* Read LEN bytes of target memory at ADDR into BUF, through CACHE.
+   Returns 0 on success, like target_read_memory.  */
+
+static int
+ax_eval_read_memory (struct ax_eval_cache *cache, CORE_ADDR addr,
+		     gdb_byte *buf, int len)
+{
+  CORE_ADDR base = addr & ~(CORE_ADDR) (AX_EVAL_CACHE_LINE_SIZE - 1);
+  int i;
+
+  /* Don't bother with references that straddle two lines.  */
+  if (addr + len > base + AX_EVAL_CACHE_LINE_SIZE)
+    return target_read_memory (addr, buf, len);
+
+  for (i = 0; i < cache->nlines; i++)
+    if (cache->lines[i].addr == base)
+      {
+	memcpy (buf, cache->lines[i].data + (addr - base), len);
+	return 0;
+      }
+
+  if (cache->nlines < AX_EVAL_CACHE_LINES)
+    i = cache->nlines;
+  else
+    {
+      i = cache->next;
+      cache->next = (cache->next + 1) % AX_EVAL_CACHE_LINES;
+    }
+
+  /* The line may extend into unreadable memory even though the
+     reference itself doesn't; fall back to reading just that.  */
+  if (target_read_memory (base, cache->lines[i].data,
+			  AX_EVAL_CACHE_LINE_SIZE) != 0)
+    return target_read_memory (addr, buf, len);
+
+  cache->lines[i].addr = base;
+  if (i == cache->nlines)
+    cache->nlines++;
+  memcpy (buf, cache->lines[i].data + (addr - base), len);
+  return 0;
+}
+
+/* See ax-gdb.h.  */
+
+int
+ax_eval (struct agent_expr *ax, struct regcache *regcache,
+	 LONGEST *result)
+{
+  struct gdbarch *gdbarch = ax->gdbarch;
+  enum bfd_endian byte_order = gdbarch_byte_order (gdbarch);
+  struct ax_eval_cache cache;
+  ULONGEST *stack, *regs;
+  int sp = 0;
+  int pc = 0;
+  int nregs, reg;
+
+  gdb_assert (ax->flaw == agent_flaw_none && ax->min_height >= 0);
+
+  stack = alloca ((ax->max_height + 1) * sizeof (stack[0]));
+  cache.nlines = cache.next = 0;
+
+  /* Fetch all the registers the expression uses up front, so that
+     the loop below only ever indexes an array.  */
+  nregs = ax->reg_mask_len * 8;
+  regs = alloca ((nregs + 1) * sizeof (regs[0]));
+  for (reg = 0; reg < nregs; reg++)
+    if (ax->reg_mask[reg / 8] & (1 << (reg % 8)))
+      {
+	if (reg >= gdbarch_num_regs (gdbarch)
+	    || register_size (gdbarch, reg) > sizeof (ULONGEST)
+	    || regcache_raw_read_unsigned (regcache, reg,
+					   &regs[reg]) != REG_VALID)
+	  return -1;
+      }
+
+  while (pc < ax->len)
+    {
+      enum agent_op op = ax->buf[pc++];
+      ULONGEST tem;
+      gdb_byte buf[8];
+      int size, i;
+
+      switch (op)
+	{
+	case aop_add:
+	  sp--;
+	  stack[sp - 1] += stack[sp];
+	  break;
+
+	case aop_sub:
+	  sp--;
+	  stack[sp - 1] -= stack[sp];
+	  break;
+
+	case aop_mul:
+	  sp--;
+	  stack[sp - 1] *= stack[sp];
+	  break;
+
+	case aop_div_signed:
+	case aop_div_unsigned:
+	case aop_rem_signed:
+	case aop_rem_unsigned:
+	  sp--;
+	  if (stack[sp] == 0)
+	    return -1;
+	  if (op == aop_div_signed)
+	    stack[sp - 1] = (LONGEST) stack[sp - 1] / (LONGEST) stack[sp];
+	  else if (op == aop_div_unsigned)
+	    stack[sp - 1] /= stack[sp];
+	  else if (op == aop_rem_signed)
+	    stack[sp - 1] = (LONGEST) stack[sp - 1] % (LONGEST) stack[sp];
+	  else
+	    stack[sp - 1] %= stack[sp];
+	  break;
+
+	case aop_lsh:
+	  sp--;
+	  stack[sp - 1] <<= stack[sp];
+	  break;
+
+	case aop_rsh_signed:
+	  sp--;
+	  stack[sp - 1] = (LONGEST) stack[sp - 1] >> stack[sp];
+	  break;
+
+	case aop_rsh_unsigned:
+	  sp--;
+	  stack[sp - 1] >>= stack[sp];
+	  break;
+
+	case aop_log_not:
+	  stack[sp - 1] = !stack[sp - 1];
+	  break;
+
+	case aop_bit_and:
+	  sp--;
+	  stack[sp - 1] &= stack[sp];
+	  break;
+
+	case aop_bit_or:
+	  sp--;
+	  stack[sp - 1] |= stack[sp];
+	  break;
+
+	case aop_bit_xor:
+	  sp--;
+	  stack[sp - 1] ^= stack[sp];
+	  break;
+
+	case aop_bit_not:
+	  stack[sp - 1] = ~stack[sp - 1];
+	  break;
+
+	case aop_equal:
+	  sp--;
+	  stack[sp - 1] = stack[sp - 1] == stack[sp];
+	  break;
+
+	case aop_less_signed:
+	  sp--;
+	  stack[sp - 1] = (LONGEST) stack[sp - 1] < (LONGEST) stack[sp];
+	  break;
+
+	case aop_less_unsigned:
+	  sp--;
+	  stack[sp - 1] = stack[sp - 1] < stack[sp];
+	  break;
+
+	case aop_ext:
+	  size = ax->buf[pc++];
+	  if (size < 64)
+	    {
+	      tem = (ULONGEST) 1 << (size - 1);
+	      stack[sp - 1] &= ((ULONGEST) 1 << size) - 1;
+	      stack[sp - 1] = (stack[sp - 1] ^ tem) - tem;
+	    }
+	  break;
+
+	case aop_zero_ext:
+	  size = ax->buf[pc++];
+	  if (size < 64)
+	    stack[sp - 1] &= ((ULONGEST) 1 << size) - 1;
+	  break;
+
+	case aop_ref8:
+	case aop_ref16:
+	case aop_ref32:
+	case aop_ref64:
+	  size = aop_map[op].data_size / 8;
+	  if (ax_eval_read_memory (&cache, stack[sp - 1], buf, size) != 0)
+	    return -1;
+	  stack[sp - 1] = extract_unsigned_integer (buf, size, byte_order);
+	  break;
+
+	case aop_if_goto:
+	  sp--;
+	  if (stack[sp])
+	    pc = (ax->buf[pc] << 8) + ax->buf[pc + 1];
+	  else
+	    pc += 2;
+	  break;
+
+	case aop_goto:
+	  pc = (ax->buf[pc] << 8) + ax->buf[pc + 1];
+	  break;
+
+	case aop_const8:
+	case aop_const16:
+	case aop_const32:
+	case aop_const64:
+	  size = aop_map[op].op_size;
+	  tem = 0;
+	  for (i = 0; i < size; i++)
+	    tem = (tem << 8) + ax->buf[pc++];
+	  stack[sp++] = tem;
+	  break;
+
+	case aop_reg:
+	  reg = (ax->buf[pc] << 8) + ax->buf[pc + 1];
+	  pc += 2;
+	  stack[sp++] = regs[reg];
+	  break;
+
+	case aop_end:
+	  if (sp == 0)
+	    return -1;
+	  *result = stack[sp - 1];
+	  return 0;
+
+	case aop_dup:
+	  stack[sp] = stack[sp - 1];
+	  sp++;
+	  break;
+
+	case aop_pop:
+	  sp--;
+	  break;
+
+	case aop_pick:
+	  i = ax->buf[pc++];
+	  stack[sp] = stack[sp - 1 - i];
+	  sp++;
+	  break;
+
+	case aop_rot:
+	  tem = stack[sp - 1];
+	  stack[sp - 1] = stack[sp - 2];
+	  stack[sp - 2] = stack[sp - 3];
+	  stack[sp - 3] = tem;
+	  break;
+
+	case aop_swap:
+	  tem = stack[sp - 1];
+	  stack[sp - 1] = stack[sp - 2];
+	  stack[sp - 2] = tem;
+	  break;
+
+	default:
+	  /* Floating point, trace state variables, tracing and printf
+	     only make sense to the agent.  */
+	  return -1;
+	}
+    }
+
+  return -1;
+}
+
 static void
 agent_eval_command_one (char *exp, int eval, CORE_ADDR pc)
 {
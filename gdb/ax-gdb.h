@@ -121,6 +121,20 @@ extern struct agent_expr *gen_printf (CORE_ADDR, struct gdbarch *,
 				      struct format_piece *,
 				      int, struct expression **);
 
+struct regcache;
+
+/* Evaluate the agent expression AX in GDB, reading registers from
+   REGCACHE and memory from the current target.  AX must have been
+   checked by ax_reqs, and be free of flaws.  Returns 0 and stores the
+   value left on top of the stack in *RESULT on success.  Returns -1
+   if AX uses operations only the agent implements, such as floating
+   point and trace state variables, or if evaluation failed, e.g. on
+   a memory error or a division by zero; the caller should then fall
+   back to evaluating the original expression.  */
+
+extern int ax_eval (struct agent_expr *ax, struct regcache *regcache,
+		    LONGEST *result);
+
 extern int trace_kludge;
 extern int trace_string_kludge;
 
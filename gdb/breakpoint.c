@@ -69,6 +69,9 @@
 #include "gdb_regex.h"
 #include "ax-gdb.h"
 #include "dummy-frame.h"
+#include "regcache.h"
+#include "timeval-utils.h"
+#include <sys/time.h>
 
 #include "format.h"
 
@@ -187,6 +190,8 @@ static int breakpoint_1 (char *, int,
 
 static int breakpoint_cond_eval (void *);
 
+static int breakpoint_cond_eval_compiled (struct bp_location *, int *);
+
 static void cleanup_executing_breakpoints (void *);
 
 static void commands_command (char *, int);
@@ -252,6 +257,8 @@ static void update_global_location_list (int);
 
 static void update_global_location_list_nothrow (int);
 
+static void bp_location_target_extensions_add (struct bp_location *bl);
+
 static int is_hardware_watchpoint (const struct breakpoint *bpt);
 
 static void insert_breakpoint_locations (void);
@@ -476,6 +483,11 @@ static const char *condition_evaluation_mode_1 = condition_evaluation_auto;
    condition_evaluation_mode_1.  */
 static const char *condition_evaluation_mode = condition_evaluation_auto;
 
+/* If nonzero, GDB compiles the breakpoint conditions it evaluates to
+   agent expression bytecode, and evaluates that instead of the
+   conditions' expression trees.  */
+static int compile_breakpoint_conditions = 1;
+
 /* Translate a condition evaluation mode MODE into either "host"
    or "target".  This is used mostly to translate from "auto" to the
    real setting that is being used.  It returns the translated
@@ -569,6 +581,11 @@ int target_exact_watchpoints = 0;
 
 struct breakpoint *breakpoint_chain;
 
+/* Last element of BREAKPOINT_CHAIN, so that appending a breakpoint
+   does not need to walk the whole chain.  */
+
+static struct breakpoint *breakpoint_chain_tail;
+
 /* Array is sorted by bp_location_compare - primarily by the ADDRESS.  */
 
 static struct bp_location **bp_location;
@@ -593,6 +610,29 @@ static CORE_ADDR bp_location_placed_address_before_address_max;
 
 static CORE_ADDR bp_location_shadow_len_after_address_max;
 
+/* Generation counter of update_global_location_list.  The elements of
+   BP_LOCATION are exactly the locations whose GLOBAL_GENERATION field
+   equals this value.  Starts at one so that freshly allocated
+   locations (generation zero) never look like members.  */
+
+static unsigned int bp_location_generation = 1;
+
+/* Nesting depth of begin_breakpoint_batch calls.  While nonzero,
+   update_global_location_list calls which may insert locations are
+   deferred; BREAKPOINT_BATCH_PENDING records that one was.  */
+
+static int breakpoint_batch_depth;
+
+/* Nonzero if a location update was deferred while
+   BREAKPOINT_BATCH_DEPTH was nonzero.  */
+
+static int breakpoint_batch_pending;
+
+/* Nonzero if some location was marked condition_modified since the
+   last update_global_location_list call.  */
+
+static int bp_location_conditions_modified;
+
 /* The locations that no longer correspond to any breakpoint, unlinked
    from bp_location array, but for which a hit may still be reported
    by a target.  */
@@ -644,6 +684,7 @@ void
 start_rbreak_breakpoints (void)
 {
   rbreak_start_breakpoint_count = breakpoint_count;
+  begin_breakpoint_batch ();
 }
 
 /* Called at the end of an "rbreak" command to record the last
@@ -653,6 +694,36 @@ void
 end_rbreak_breakpoints (void)
 {
   prev_breakpoint_count = rbreak_start_breakpoint_count;
+  end_breakpoint_batch ();
+}
+
+/* See breakpoint.h.  */
+
+void
+begin_breakpoint_batch (void)
+{
+  breakpoint_batch_depth++;
+}
+
+/* See breakpoint.h.  */
+
+void
+end_breakpoint_batch (void)
+{
+  volatile struct gdb_exception e;
+
+  gdb_assert (breakpoint_batch_depth > 0);
+  if (--breakpoint_batch_depth > 0 || !breakpoint_batch_pending)
+    return;
+
+  breakpoint_batch_pending = 0;
+
+  /* This may run from a cleanup while an error is being thrown, so
+     report insertion failures instead of propagating them.  */
+  TRY_CATCH (e, RETURN_MASK_ERROR)
+    update_global_location_list (1);
+  if (e.reason < 0)
+    exception_print (gdb_stderr, e);
 }
 
 /* Used in run_command to zero the hit count when a new run starts.  */
@@ -663,7 +734,13 @@ clear_breakpoint_hit_counts (void)
   struct breakpoint *b;
 
   ALL_BREAKPOINTS (b)
-    b->hit_count = 0;
+    {
+      b->hit_count = 0;
+      b->cond_eval_count = 0;
+      b->cond_true_count = 0;
+      b->cond_compiled_count = 0;
+      b->cond_eval_usecs = 0;
+    }
 }
 
 /* Allocate a new counted_command_line with reference count of 1.
@@ -763,6 +840,7 @@ mark_breakpoint_modified (struct breakpoint *b)
 
   for (loc = b->loc; loc; loc = loc->next)
     loc->condition_changed = condition_modified;
+  bp_location_conditions_modified = 1;
 }
 
 /* Mark location as "conditions have changed" in case the target supports
@@ -784,6 +862,7 @@ mark_breakpoint_location_modified (struct bp_location *loc)
     return;
 
   loc->condition_changed = condition_modified;
+  bp_location_conditions_modified = 1;
 }
 
 /* Sets the condition-evaluation mode using the static global
@@ -937,6 +1016,11 @@ set_breakpoint_condition (struct breakpoint *b, char *exp,
 	  xfree (loc->cond);
 	  loc->cond = NULL;
 
+	  if (loc->host_cond_bytecode)
+	    free_agent_expr (loc->host_cond_bytecode);
+	  loc->host_cond_bytecode = NULL;
+	  loc->host_cond_compiled = 0;
+
 	  /* No need to free the condition agent expression
 	     bytecode (if we have one).  We will handle this
 	     when we go through update_global_location_list.  */
@@ -1840,9 +1924,19 @@ update_watchpoint (struct watchpoint *b, int reparse)
 
       frame_pspace = get_frame_program_space (get_selected_frame (NULL));
 
+      b->memory_only = 1;
+
       /* Look at each value on the value chain.  */
       for (v = val_chain; v; v = value_next (v))
 	{
+	  /* Values from the history never change, but anything else
+	     that is not in memory, such as registers, can't be watched
+	     by the target as memory.  */
+	  if (VALUE_LVAL (v) != lval_memory
+	      && VALUE_LVAL (v) != not_lval
+	      && deprecated_value_modifiable (v))
+	    b->memory_only = 0;
+
 	  /* If it's a memory location, and GDB actually needed
 	     its contents to evaluate the expression, then we
 	     must watch it.  If the first value returned is
@@ -2003,6 +2097,37 @@ in which its expression is valid.\n"),
 }
 
 
+/* Return non-zero if BL is a location of a software watchpoint which
+   the target may watch on its own, see target_insert_sw_watchpoint.  */
+
+static int
+sw_watchpoint_location_p (const struct bp_location *bl)
+{
+  return (bl->loc_type == bp_loc_other
+	  && bl->owner->type == bp_watchpoint
+	  && ((struct watchpoint *) bl->owner)->memory_only
+	  && bl->length > 0);
+}
+
+/* Return non-zero if the target watches all the locations of software
+   watchpoint W, so that GDB need not single-step the program to check
+   it.  */
+
+static int
+sw_watchpoint_inserted_p (struct watchpoint *w)
+{
+  struct bp_location *bl;
+
+  if (!w->memory_only)
+    return 0;
+
+  for (bl = w->base.loc; bl != NULL; bl = bl->next)
+    if (!sw_watchpoint_location_p (bl) || !bl->inserted)
+      return 0;
+
+  return 1;
+}
+
 /* Returns 1 iff breakpoint location should be
    inserted in the inferior.  We don't differentiate the type of BL's owner
    (breakpoint vs. tracepoint), although insert_location in tracepoint's
@@ -2603,7 +2728,10 @@ insert_bp_location (struct bp_location *bl,
 	    }
 	}
       else
-	bl->inserted = 1;
+	{
+	  bl->inserted = 1;
+	  bp_location_target_extensions_add (bl);
+	}
 
       return val;
     }
@@ -2654,6 +2782,15 @@ insert_bp_location (struct bp_location *bl,
       bl->inserted = (val == 0);
     }
 
+  else if (sw_watchpoint_location_p (bl)
+	   && bl->owner->disposition != disp_del_at_next_stop)
+    {
+      /* If the target can't watch this location, GDB single-steps
+	 the program and checks the watchpoint itself.  */
+      bl->inserted = (target_insert_sw_watchpoint (bl->address,
+						   bl->length) == 0);
+    }
+
   else if (bl->owner->type == bp_catchpoint)
     {
       gdb_assert (bl->owner->ops != NULL
@@ -3669,6 +3806,14 @@ remove_breakpoint_1 (struct bp_location *bl, insertion_state_t is)
 	warning (_("Could not remove hardware watchpoint %d."),
 		 bl->owner->number);
     }
+  else if (bl->loc_type == bp_loc_other && is_watchpoint (bl->owner))
+    {
+      /* A software watchpoint location the target watches for us.
+	 Don't look at the owner's current type or memory_only flag,
+	 they may have changed since this location was inserted.  */
+      bl->inserted = (is == mark_inserted);
+      target_remove_sw_watchpoint (bl->address, bl->length);
+    }
   else if (bl->owner->type == bp_catchpoint
            && breakpoint_enabled (bl->owner)
            && !bl->duplicate)
@@ -4593,6 +4738,54 @@ breakpoint_cond_eval (void *exp)
   return i;
 }
 
+/* Try to evaluate the condition of location BL from its bytecode,
+   compiling it first if needed.  This avoids walking the expression
+   tree, looking up symbols and building values each time the
+   condition is tested.  Returns 1 and sets *VALUE_IS_ZERO if that
+   worked, and 0 if the condition has to be evaluated with
+   breakpoint_cond_eval instead.  */
+
+static int
+breakpoint_cond_eval_compiled (struct bp_location *bl, int *value_is_zero)
+{
+  volatile struct gdb_exception ex;
+  LONGEST result;
+  int status = -1;
+
+  if (!bl->host_cond_compiled)
+    {
+      struct agent_expr *aexpr;
+
+      bl->host_cond_compiled = 1;
+      aexpr = parse_cond_to_aexpr (bl->address, bl->cond);
+      if (aexpr == NULL)
+	return 0;
+
+      ax_reqs (aexpr);
+      if (aexpr->flaw != agent_flaw_none || aexpr->min_height < 0)
+	{
+	  free_agent_expr (aexpr);
+	  return 0;
+	}
+      bl->host_cond_bytecode = aexpr;
+    }
+
+  if (bl->host_cond_bytecode == NULL)
+    return 0;
+
+  /* Leave any error to the full evaluation, which reports it.  */
+  TRY_CATCH (ex, RETURN_MASK_ERROR)
+    {
+      status = ax_eval (bl->host_cond_bytecode, get_current_regcache (),
+			&result);
+    }
+  if (ex.reason < 0 || status != 0)
+    return 0;
+
+  *value_is_zero = (result == 0);
+  return 1;
+}
+
 /* Allocate a new bpstat.  Link it to the FIFO list by BS_LINK_POINTER.  */
 
 static bpstat
@@ -5037,7 +5230,7 @@ static void
 bpstat_check_breakpoint_conditions (bpstat bs, ptid_t ptid)
 {
   int thread_id = pid_to_thread_id (ptid);
-  const struct bp_location *bl;
+  struct bp_location *bl;
   struct breakpoint *b;
 
   /* BS is built for existing struct breakpoint.  */
@@ -5122,10 +5315,29 @@ bpstat_check_breakpoint_conditions (bpstat bs, ptid_t ptid)
 		within_current_scope = 0;
 	    }
 	  if (within_current_scope)
-	    value_is_zero
-	      = catch_errors (breakpoint_cond_eval, cond,
-			      "Error in testing breakpoint condition:\n",
-			      RETURN_MASK_ALL);
+	    {
+	      struct timeval start, end, elapsed;
+	      int compiled = 0;
+
+	      gettimeofday (&start, NULL);
+	      if (w == NULL && compile_breakpoint_conditions)
+		compiled = breakpoint_cond_eval_compiled (bl, &value_is_zero);
+	      if (!compiled)
+		value_is_zero
+		  = catch_errors (breakpoint_cond_eval, cond,
+				  "Error in testing breakpoint condition:\n",
+				  RETURN_MASK_ALL);
+	      gettimeofday (&end, NULL);
+	      timeval_sub (&elapsed, &end, &start);
+
+	      b->cond_eval_count++;
+	      if (!value_is_zero)
+		b->cond_true_count++;
+	      if (compiled)
+		b->cond_compiled_count++;
+	      b->cond_eval_usecs += (elapsed.tv_sec * (LONGEST) 1000000
+				     + elapsed.tv_usec);
+	    }
 	  else
 	    {
 	      warning (_("Watchpoint condition cannot be tested "
@@ -5589,7 +5801,8 @@ bpstat_should_step (void)
   struct breakpoint *b;
 
   ALL_BREAKPOINTS (b)
-    if (breakpoint_enabled (b) && b->type == bp_watchpoint && b->loc != NULL)
+    if (breakpoint_enabled (b) && b->type == bp_watchpoint && b->loc != NULL
+	&& !sw_watchpoint_inserted_p ((struct watchpoint *) b))
       return 1;
   return 0;
 }
@@ -6091,6 +6304,31 @@ print_one_breakpoint_location (struct breakpoint *b,
 	  ui_out_text (uiout, " evals)");
 	}
       ui_out_text (uiout, "\n");
+
+      /* Show how GDB's own evaluations of the condition went.  */
+      if (b->cond_eval_count > 0 && !ui_out_is_mi_like_p (uiout))
+	{
+	  ui_out_text (uiout, "\tcondition evaluated ");
+	  ui_out_field_int (uiout, "cond-evals", b->cond_eval_count);
+	  ui_out_text (uiout, b->cond_eval_count == 1 ? " time" : " times");
+	  ui_out_text (uiout, ", true ");
+	  ui_out_field_int (uiout, "cond-true", b->cond_true_count);
+	  ui_out_text (uiout, b->cond_true_count == 1 ? " time" : " times");
+	  ui_out_text (uiout, ", ");
+	  ui_out_field_fmt (uiout, "cond-usecs", "%.1f",
+			    (double) b->cond_eval_usecs / b->cond_eval_count);
+	  ui_out_text (uiout, " us per evaluation");
+	  if (b->cond_compiled_count == b->cond_eval_count)
+	    ui_out_text (uiout, " (compiled)");
+	  else if (b->cond_compiled_count > 0)
+	    {
+	      ui_out_text (uiout, " (");
+	      ui_out_field_int (uiout, "cond-compiled",
+				b->cond_compiled_count);
+	      ui_out_text (uiout, " compiled)");
+	    }
+	  ui_out_text (uiout, "\n");
+	}
     }
 
   if (!part_of_multiple && b->thread != -1)
@@ -6942,15 +7180,12 @@ add_to_breakpoint_chain (struct breakpoint *b)
   /* Add this breakpoint to the end of the chain so that a list of
      breakpoints will come out in order of increasing numbers.  */
 
-  b1 = breakpoint_chain;
+  b1 = breakpoint_chain_tail;
   if (b1 == 0)
     breakpoint_chain = b;
   else
-    {
-      while (b1->next)
-	b1 = b1->next;
-      b1->next = b;
-    }
+    b1->next = b;
+  breakpoint_chain_tail = b;
 }
 
 /* Initializes breakpoint B with type BPTYPE and no locations yet.  */
@@ -12144,40 +12379,163 @@ bp_location_compare (const void *ap, const void *bp)
   return (a > b) - (a < b);
 }
 
-/* Set bp_location_placed_address_before_address_max and
-   bp_location_shadow_len_after_address_max according to the current
-   content of the bp_location array.  */
+/* Grow bp_location_placed_address_before_address_max and
+   bp_location_shadow_len_after_address_max to cover the shadow of BL,
+   if it has one.  The maxima are only reset once the bp_location
+   array becomes empty, so they are upper bounds over its elements;
+   that is all breakpoint_xfer_memory needs to limit its scan.  */
 
 static void
-bp_location_target_extensions_update (void)
+bp_location_target_extensions_add (struct bp_location *bl)
 {
-  struct bp_location *bl, **blp_tmp;
+  CORE_ADDR start, end, addr;
 
-  bp_location_placed_address_before_address_max = 0;
-  bp_location_shadow_len_after_address_max = 0;
+  if (!bp_location_has_shadow (bl))
+    return;
 
-  ALL_BP_LOCATIONS (bl, blp_tmp)
+  start = bl->target_info.placed_address;
+  end = start + bl->target_info.shadow_len;
+
+  gdb_assert (bl->address >= start);
+  addr = bl->address - start;
+  if (addr > bp_location_placed_address_before_address_max)
+    bp_location_placed_address_before_address_max = addr;
+
+  /* Zero SHADOW_LEN would not pass bp_location_has_shadow.  */
+
+  gdb_assert (bl->address < end);
+  addr = end - bl->address;
+  if (addr > bp_location_shadow_len_after_address_max)
+    bp_location_shadow_len_after_address_max = addr;
+}
+
+/* Return the first element of the sorted range [FIRST, LAST) of
+   bp_location pointers which bp_location_compare orders after LOC.  */
+
+static struct bp_location **
+bp_location_upper_bound (struct bp_location **first,
+			 struct bp_location **last,
+			 struct bp_location *loc)
+{
+  while (first < last)
     {
-      CORE_ADDR start, end, addr;
+      struct bp_location **mid = first + (last - first) / 2;
+
+      if (bp_location_compare (&loc, mid) < 0)
+	last = mid;
+      else
+	first = mid + 1;
+    }
 
-      if (!bp_location_has_shadow (bl))
+  return first;
+}
+
+/* Rebuild the bp_location array from the locations of ALL_BREAKPOINTS,
+   reusing the order of the previous array OLD_LOCATION of
+   OLD_LOCATION_COUNT elements.  Locations which are still present keep
+   their relative order, and only the locations added since the last
+   update are sorted and merged in, so creating or deleting one
+   breakpoint does not re-sort every location.  The whole array is
+   sorted again only if the sort key of a surviving location changed
+   in place (e.g. by make_breakpoint_permanent).  */
+
+static void
+bp_location_rebuild (struct bp_location **old_location,
+		     unsigned old_location_count)
+{
+  struct breakpoint *b;
+  struct bp_location *loc, **locp, **old_locp;
+  VEC(bp_location_p) *added = NULL;
+  struct cleanup *cleanups;
+  unsigned int prev_generation;
+  unsigned kept_count, added_count;
+  int sorted = 1;
+  int ix;
+
+  cleanups = make_cleanup (VEC_cleanup (bp_location_p), &added);
+
+  prev_generation = bp_location_generation++;
+  if (bp_location_generation == 0)
+    bp_location_generation = 1;
+
+  bp_location_count = 0;
+  ALL_BREAKPOINTS (b)
+    for (loc = b->loc; loc; loc = loc->next)
+      {
+	if (loc->global_generation != prev_generation)
+	  VEC_safe_push (bp_location_p, added, loc);
+	loc->global_generation = bp_location_generation;
+	bp_location_count++;
+      }
+
+  bp_location = xmalloc (sizeof (*bp_location) * bp_location_count);
+
+  /* Copy the surviving locations, checking that they are still in
+     order.  Only locations at the same address need the full
+     comparison.  */
+  locp = bp_location;
+  for (old_locp = old_location; old_locp < old_location + old_location_count;
+       old_locp++)
+    {
+      loc = *old_locp;
+      if (loc->global_generation != bp_location_generation)
 	continue;
 
-      start = bl->target_info.placed_address;
-      end = start + bl->target_info.shadow_len;
+      if (sorted && locp > bp_location
+	  && (loc->address < locp[-1]->address
+	      || (loc->address == locp[-1]->address
+		  && bp_location_compare (old_locp, locp - 1) < 0)))
+	sorted = 0;
 
-      gdb_assert (bl->address >= start);
-      addr = bl->address - start;
-      if (addr > bp_location_placed_address_before_address_max)
-	bp_location_placed_address_before_address_max = addr;
+      *locp++ = loc;
+    }
 
-      /* Zero SHADOW_LEN would not pass bp_location_has_shadow.  */
+  kept_count = locp - bp_location;
+  added_count = VEC_length (bp_location_p, added);
+  gdb_assert (kept_count + added_count == bp_location_count);
 
-      gdb_assert (bl->address < end);
-      addr = end - bl->address;
-      if (addr > bp_location_shadow_len_after_address_max)
-	bp_location_shadow_len_after_address_max = addr;
+  if (!sorted)
+    {
+      if (added_count > 0)
+	memcpy (locp, VEC_address (bp_location_p, added),
+		added_count * sizeof (*bp_location));
+      qsort (bp_location, bp_location_count, sizeof (*bp_location),
+	     bp_location_compare);
     }
+  else if (added_count > 0)
+    {
+      struct bp_location **dst = bp_location + bp_location_count;
+      struct bp_location **src = locp;
+
+      qsort (VEC_address (bp_location_p, added), added_count,
+	     sizeof (*bp_location), bp_location_compare);
+
+      /* Merge from the end, so that every surviving element is moved
+	 at most once.  */
+      for (ix = added_count - 1; ix >= 0; ix--)
+	{
+	  struct bp_location **pos;
+
+	  loc = VEC_index (bp_location_p, added, ix);
+	  pos = bp_location_upper_bound (bp_location, src, loc);
+	  dst -= src - pos;
+	  memmove (dst, pos, (src - pos) * sizeof (*bp_location));
+	  *--dst = loc;
+	  src = pos;
+	}
+      gdb_assert (dst == src);
+    }
+
+  if (bp_location_count == 0)
+    {
+      bp_location_placed_address_before_address_max = 0;
+      bp_location_shadow_len_after_address_max = 0;
+    }
+  else
+    for (ix = 0; VEC_iterate (bp_location_p, added, ix, loc); ix++)
+      bp_location_target_extensions_add (loc);
+
+  do_cleanups (cleanups);
 }
 
 /* Download tracepoint locations if they haven't been.  */
@@ -12349,25 +12707,24 @@ update_global_location_list (int should_insert)
   struct bp_location **old_location, **old_locp;
   unsigned old_location_count;
 
+  /* Within a batch, leave everything for end_breakpoint_batch.  Only
+     this function frees locations, so the stale array stays valid;
+     the locations added meanwhile are not inserted yet anyway.
+     Removals (SHOULD_INSERT false) are still done right away, as
+     their callers may free the breakpoint next.  */
+  if (should_insert && breakpoint_batch_depth > 0)
+    {
+      breakpoint_batch_pending = 1;
+      return;
+    }
+
   old_location = bp_location;
   old_location_count = bp_location_count;
   bp_location = NULL;
   bp_location_count = 0;
   cleanups = make_cleanup (xfree, old_location);
 
-  ALL_BREAKPOINTS (b)
-    for (loc = b->loc; loc; loc = loc->next)
-      bp_location_count++;
-
-  bp_location = xmalloc (sizeof (*bp_location) * bp_location_count);
-  locp = bp_location;
-  ALL_BREAKPOINTS (b)
-    for (loc = b->loc; loc; loc = loc->next)
-      *locp++ = loc;
-  qsort (bp_location, bp_location_count, sizeof (*bp_location),
-	 bp_location_compare);
-
-  bp_location_target_extensions_update ();
+  bp_location_rebuild (old_location, old_location_count);
 
   /* Identify bp_location instances that are no longer present in the
      new list, and therefore should be freed.  Note that it's not
@@ -12393,6 +12750,14 @@ update_global_location_list (int should_insert)
       int keep_in_target = 0;
       int removed = 0;
 
+      /* A location which is still present and not inserted needs no
+	 work here, unless locations at its address may need their
+	 target-side conditions updated.  */
+      if (old_loc->global_generation == bp_location_generation
+	  && !old_loc->inserted
+	  && !bp_location_conditions_modified)
+	continue;
+
       /* Skip LOCP entries which will definitely never be needed.
 	 Stop either at or being the one matching OLD_LOC.  */
       while (locp < bp_location + bp_location_count
@@ -12597,6 +12962,18 @@ update_global_location_list (int should_insert)
       struct bp_location **loc_first_p;
       b = loc->owner;
 
+      /* A location alone at its address which is neither marked as a
+	 duplicate nor has a modified condition would be left as is
+	 below; skip it without looking at its breakpoint.  Only
+	 locations at the same address can match each other.  */
+      if (!loc->duplicate
+	  && loc->condition_changed == condition_unchanged
+	  && (locp == bp_location
+	      || locp[-1]->address != loc->address)
+	  && (locp + 1 == bp_location + bp_location_count
+	      || locp[1]->address != loc->address))
+	continue;
+
       if (!unduplicated_should_be_inserted (loc)
 	  || !breakpoint_address_is_meaningful (b)
 	  /* Don't detect duplicate for tracepoint locations because they are
@@ -12658,6 +13035,9 @@ update_global_location_list (int should_insert)
 			"a permanent breakpoint"));
     }
 
+  /* The loop above cleared every condition_modified mark.  */
+  bp_location_conditions_modified = 0;
+
   if (breakpoints_always_inserted_mode ()
       && (have_live_inferiors ()
 	  || (gdbarch_has_global_breakpoints (target_gdbarch ()))))
@@ -12789,6 +13169,8 @@ bp_location_dtor (struct bp_location *self)
   xfree (self->cond);
   if (self->cond_bytecode)
     free_agent_expr (self->cond_bytecode);
+  if (self->host_cond_bytecode)
+    free_agent_expr (self->host_cond_bytecode);
   xfree (self->function_name);
 }
 
@@ -13720,11 +14102,15 @@ delete_breakpoint (struct breakpoint *bpt)
 
   if (breakpoint_chain == bpt)
     breakpoint_chain = bpt->next;
+  if (breakpoint_chain_tail == bpt)
+    breakpoint_chain_tail = NULL;
 
   ALL_BREAKPOINTS (b)
     if (b->next == bpt)
     {
       b->next = bpt->next;
+      if (b->next == NULL)
+	breakpoint_chain_tail = b;
       break;
     }
 
@@ -14431,6 +14817,128 @@ breakpoint_re_set (void)
   create_exception_master_breakpoint ();
 }
 
+/* Return non-zero if B may have new locations in OBJFILE, so that it
+   needs to be re-set now that OBJFILE has been loaded.  Breakpoints
+   whose locations are not given by an ordinary linespec are always
+   re-set.  Otherwise, B's linespec is decoded looking only at
+   OBJFILE's symbols; it is re-set if that finds anything.  */
+
+static int
+breakpoint_re_set_needed_p (struct breakpoint *b, struct objfile *objfile)
+{
+  struct linespec_result canonical;
+  struct bp_location *loc;
+  struct cleanup *cleanups;
+  volatile struct gdb_exception e;
+  char *s;
+  int found = 0;
+
+  if ((b->ops->re_set != bkpt_re_set
+       && b->ops->re_set != tracepoint_re_set
+       && b->ops->re_set != dprintf_re_set)
+      || (b->ops->decode_linespec != bkpt_decode_linespec
+	  && b->ops->decode_linespec != tracepoint_decode_linespec)
+      || b->type == bp_static_tracepoint
+      || b->addr_string == NULL
+      || b->addr_string_range_end != NULL)
+    return 1;
+
+  /* A condition which could not be parsed at some location may parse
+     now that OBJFILE's symbols are available.  */
+  if (b->cond_string != NULL)
+    for (loc = b->loc; loc != NULL; loc = loc->next)
+      if (loc->cond == NULL)
+	return 1;
+
+  cleanups = prepare_re_set_context (b);
+  init_linespec_result (&canonical);
+  make_cleanup_destroy_linespec_result (&canonical);
+  canonical.search_objfile = objfile;
+
+  s = b->addr_string;
+  TRY_CATCH (e, RETURN_MASK_ERROR)
+    {
+      decode_line_full (&s, DECODE_LINE_FUNFIRSTLINE,
+			(struct symtab *) NULL, 0,
+			&canonical, multiple_symbols_all,
+			b->filter);
+    }
+  if (e.reason < 0)
+    {
+      /* Let the full re-set report errors other than not finding
+	 the location in OBJFILE.  */
+      if (e.error != NOT_FOUND_ERROR)
+	found = 1;
+    }
+  else if (!VEC_empty (linespec_sals, canonical.sals)
+	   && VEC_index (linespec_sals, canonical.sals, 0)->sals.nelts > 0)
+    found = 1;
+
+  do_cleanups (cleanups);
+  return found;
+}
+
+/* See breakpoint.h.  Loading an objfile never invalidates the
+   locations found in the others, so the remaining breakpoints are
+   left as they are, and loading shared libraries one at a time does
+   not re-decode every breakpoint against every objfile.  */
+
+void
+breakpoint_re_set_objfile (struct objfile *objfile)
+{
+  struct breakpoint *b, *b_tmp;
+  enum language save_language;
+  int save_input_radix;
+  struct cleanup *old_chain;
+
+  save_language = current_language->la_language;
+  save_input_radix = input_radix;
+  old_chain = save_current_space_and_thread ();
+
+  ALL_BREAKPOINTS_SAFE (b, b_tmp)
+  {
+    char *message;
+    struct cleanup *cleanups;
+
+    if (!breakpoint_re_set_needed_p (b, objfile))
+      continue;
+
+    /* Format possible error msg.  */
+    message = xstrprintf ("Error in re-setting breakpoint %d: ",
+			  b->number);
+    cleanups = make_cleanup (xfree, message);
+    catch_errors (breakpoint_re_set_one, b, message, RETURN_MASK_ALL);
+    do_cleanups (cleanups);
+  }
+  set_language (save_language);
+  input_radix = save_input_radix;
+
+  jit_breakpoint_re_set ();
+
+  do_cleanups (old_chain);
+
+  create_overlay_event_breakpoint ();
+  create_longjmp_master_breakpoint ();
+  create_std_terminate_master_breakpoint ();
+  create_exception_master_breakpoint ();
+}
+
+/* A new_objfile observer.  Shared libraries are added without a full
+   breakpoint_re_set (see new_symfile_objfile and solib_add); re-set
+   the breakpoints which may be affected by them here.  Separate debug
+   objfiles are handled along with the objfile they belong to.  */
+
+static void
+breakpoint_new_objfile (struct objfile *objfile)
+{
+  if (objfile == NULL
+      || (objfile->flags & OBJF_SHARED) == 0
+      || objfile->separate_debug_objfile_backlink != NULL)
+    return;
+
+  breakpoint_re_set_objfile (objfile);
+}
+
 /* Reset the thread number of this breakpoint:
 
    - If the breakpoint is for all threads, leave it as-is.
@@ -16075,6 +16583,7 @@ _initialize_breakpoint (void)
   initialize_breakpoint_ops ();
 
   observer_attach_solib_unloaded (disable_breakpoints_in_unloaded_shlib);
+  observer_attach_new_objfile (breakpoint_new_objfile);
   observer_attach_inferior_exit (clear_syscall_counts);
   observer_attach_memory_changed (invalidate_bp_value_on_memory_change);
 
@@ -16634,6 +17143,20 @@ be set to \"gdb\""),
 			   &breakpoint_set_cmdlist,
 			   &breakpoint_show_cmdlist);
 
+  add_setshow_boolean_cmd ("compile-conditions", class_breakpoint,
+			   &compile_breakpoint_conditions, _("\
+Set whether GDB compiles the breakpoint conditions it evaluates."), _("\
+Show whether GDB compiles the breakpoint conditions it evaluates."), _("\
+When on, GDB translates a breakpoint condition to agent expression\n\
+bytecode the first time it tests it, and runs that bytecode instead of\n\
+evaluating the condition's expression each time the breakpoint is hit.\n\
+Conditions that can't be translated, and evaluations that fail, are\n\
+evaluated as usual."),
+			   NULL,
+			   NULL,
+			   &breakpoint_set_cmdlist,
+			   &breakpoint_show_cmdlist);
+
   add_com ("break-range", class_breakpoint, break_range_command, _("\
 Set a breakpoint for an address range.\n\
 break-range START-LOCATION, END-LOCATION\n\
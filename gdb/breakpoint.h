@@ -351,6 +351,13 @@ struct bp_location
      condition evaluation.  */
   struct agent_expr *cond_bytecode;
 
+  /* COND compiled to agent expression bytecode for GDB to evaluate
+     itself, with ax_eval.  Built the first time the condition is
+     tested; HOST_COND_COMPILED is set once it has been tried, and
+     HOST_COND_BYTECODE is NULL if COND could not be compiled.  */
+  struct agent_expr *host_cond_bytecode;
+  int host_cond_compiled;
+
   /* Signals that the condition has changed since the last time
      we updated the global location list.  This means the condition
      needs to be sent to the target again.  This is used together
@@ -392,6 +399,11 @@ struct bp_location
      should be downloaded and so that `tfind N' always works.  */
   char duplicate;
 
+  /* Generation of update_global_location_list which last found this
+     location in its owner's location list.  Zero if it has never been
+     part of the global bp_location array.  */
+  unsigned int global_generation;
+
   /* If we someday support real thread-specific breakpoints, then
      the breakpoint location will need a thread identifier.  */
 
@@ -750,6 +762,14 @@ struct breakpoint
        aborting, so you can back up to just before the abort.  */
     int hit_count;
 
+    /* Statistics of GDB's own evaluations of the condition: the number
+       of times it was tested, found true, and evaluated from its
+       compiled form, and the total time taken, in microseconds.  */
+    int cond_eval_count;
+    int cond_true_count;
+    int cond_compiled_count;
+    LONGEST cond_eval_usecs;
+
     /* Is breakpoint's condition not yet parsed because we found
        no location initially so had no context to parse
        the condition in.  */
@@ -816,6 +836,13 @@ struct watchpoint
 
   /* The mask address for a masked hardware watchpoint.  */
   CORE_ADDR hw_wp_mask;
+
+  /* Whether the value of this watchpoint only depends on the memory
+     its locations cover.  If so, and the target can watch all those
+     locations while stepping the program itself (see
+     target_insert_sw_watchpoint), GDB need not single-step the
+     program for this software watchpoint.  */
+  int memory_only;
 };
 
 /* Return true if BPT is either a software breakpoint or a hardware
@@ -1166,6 +1193,11 @@ extern void update_breakpoint_locations (struct breakpoint *b,
 
 extern void breakpoint_re_set (void);
 
+/* Re-set only the breakpoints which may have locations in OBJFILE,
+   which has just been loaded.  */
+
+extern void breakpoint_re_set_objfile (struct objfile *objfile);
+
 extern void breakpoint_re_set_thread (struct breakpoint *);
 
 extern struct breakpoint *set_momentary_breakpoint
@@ -1529,6 +1561,15 @@ extern void check_tracepoint_command (char *line, void *closure);
 extern void start_rbreak_breakpoints (void);
 extern void end_rbreak_breakpoints (void);
 
+/* Defer updating the global location list and inserting breakpoint
+   locations into the target while creating many breakpoints.  The
+   outermost end_breakpoint_batch call then does both once for all
+   breakpoints created since the matching begin_breakpoint_batch.
+   Calls nest.  The inferior must not be resumed within a batch.  */
+
+extern void begin_breakpoint_batch (void);
+extern void end_breakpoint_batch (void);
+
 /* Breakpoint iterator function.
 
    Calls a callback function once for each breakpoint, so long as the
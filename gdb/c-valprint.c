@@ -127,6 +127,51 @@ static const struct generic_val_print_decorations c_decorations =
   "void"
 };
 
+/* If TYPE is an array of pointers to characters, elements FIRST to
+   LEN of which are about to be printed as strings, load the beginning
+   of those strings into the data cache together, rather than reading
+   them one at a time as each element is printed.  The other
+   parameters are as for c_val_print.  */
+
+static void
+c_prefetch_array_strings (struct type *type, const gdb_byte *valaddr,
+			  int embedded_offset,
+			  const struct value *original_value,
+			  const struct value_print_options *options,
+			  unsigned int first, unsigned int len)
+{
+  struct type *elttype = check_typedef (TYPE_TARGET_TYPE (type));
+  struct type *chartype;
+  unsigned int eltlen = TYPE_LENGTH (elttype);
+  unsigned int count, i;
+  CORE_ADDR *addrs;
+  struct cleanup *old_chain;
+
+  if (TYPE_CODE (elttype) != TYPE_CODE_PTR
+      || (options->format && options->format != 's'))
+    return;
+
+  chartype = TYPE_TARGET_TYPE (elttype);
+  if (!c_textual_element_type (chartype, options->format))
+    return;
+
+  count = min (len, options->print_max);
+  if (count <= first + 1
+      || !value_bytes_available (original_value, embedded_offset,
+				 count * eltlen))
+    return;
+
+  addrs = xmalloc ((count - first) * sizeof (CORE_ADDR));
+  old_chain = make_cleanup (xfree, addrs);
+  for (i = first; i < count; i++)
+    addrs[i - first] = unpack_pointer (elttype, valaddr + embedded_offset
+				       + i * eltlen);
+
+  prefetch_strings (addrs, count - first,
+		    TYPE_LENGTH (check_typedef (chartype)));
+  do_cleanups (old_chain);
+}
+
 /* See val_print for a description of the various parameters of this
    function; they are identical.  */
 
@@ -230,6 +275,8 @@ c_val_print (struct type *type, const gdb_byte *valaddr,
 		{
 		  i = 0;
 		}
+	      c_prefetch_array_strings (type, valaddr, embedded_offset,
+					original_value, options, i, len);
 	      val_print_array_elements (type, valaddr, embedded_offset,
 					address, stream,
 					recurse, original_value, options, i);
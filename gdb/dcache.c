@@ -395,6 +395,93 @@ dcache_alloc (DCACHE *dcache, CORE_ADDR addr)
   return db;
 }
 
+/* Read NLINES consecutive cache lines starting at ADDR, none of which
+   is in DCACHE, with a single transfer, and add the ones that could be
+   read to DCACHE.  Lines that could not be read are left out; the
+   caller will try them again one at a time.  */
+
+static void
+dcache_read_lines (DCACHE *dcache, CORE_ADDR addr, int nlines)
+{
+  struct mem_region *region;
+  struct cleanup *old_chain;
+  gdb_byte *buf;
+  LONGEST len = (LONGEST) nlines * dcache->line_size;
+  LONGEST res;
+  int i;
+
+  /* Leave lines spanning several memory regions, or in a region that
+     can't be read, to dcache_read_line.  Only read ahead in regions
+     the user or the target did not mark as uncacheable.  */
+  region = lookup_mem_region (addr);
+  if (region->attrib.mode == MEM_WO
+      || (!region->attrib.cache && !default_mem_region_p (region))
+      || (region->hi != 0 && addr + len > region->hi))
+    return;
+
+  buf = xmalloc (len);
+  old_chain = make_cleanup (xfree, buf);
+  res = target_read (&current_target, TARGET_OBJECT_RAW_MEMORY,
+		     NULL, buf, addr, len);
+
+  /* A failed read returns -1.  */
+  if (res < 0)
+    res = 0;
+
+  for (i = 0; i < res / dcache->line_size; i++)
+    {
+      struct dcache_block *db;
+
+      db = dcache_alloc (dcache, addr + i * dcache->line_size);
+      memcpy (db->data, buf + i * dcache->line_size, dcache->line_size);
+    }
+
+  do_cleanups (old_chain);
+}
+
+/* Make sure that the cache lines covering LEN bytes at MEMADDR are in
+   DCACHE, reading each run of consecutive missing lines with a single
+   transfer instead of one transfer per line.  */
+
+static void
+dcache_prefetch_lines (DCACHE *dcache, CORE_ADDR memaddr, int len)
+{
+  CORE_ADDR addr = MASK (dcache, memaddr);
+  CORE_ADDR end = memaddr + len;
+
+  /* Don't bother if the range wraps around the address space.  */
+  if (end < memaddr)
+    return;
+
+  while (addr < end)
+    {
+      CORE_ADDR start;
+      int nlines = 0;
+
+      if (splay_tree_lookup (dcache->tree, (splay_tree_key) addr) != NULL)
+	{
+	  addr += dcache->line_size;
+	  continue;
+	}
+
+      /* Don't read more lines than the cache can hold, or reading the
+	 last lines would evict the first ones.  */
+      start = addr;
+      while (addr < end
+	     && nlines < dcache_size
+	     && splay_tree_lookup (dcache->tree,
+				   (splay_tree_key) addr) == NULL)
+	{
+	  addr += dcache->line_size;
+	  nlines++;
+	}
+
+      /* A single line is read by dcache_peek_byte as usual.  */
+      if (nlines > 1)
+	dcache_read_lines (dcache, start, nlines);
+    }
+}
+
 /* Using the data cache DCACHE, store in *PTR the contents of the byte at
    address ADDR in the remote machine.  
 
@@ -517,6 +604,9 @@ dcache_xfer_memory (struct target_ops *ops, DCACHE *dcache,
       len = res;
     }
       
+  if (!should_write)
+    dcache_prefetch_lines (dcache, memaddr, len);
+
   for (i = 0; i < len; i++)
     {
       if (!xfunc (dcache, memaddr + i, myaddr + i))
@@ -19,6 +19,10 @@
 #include "server.h"
 #include "ax.h"
 #include "format.h"
+#include <stdint.h>
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
 
 static void ax_vdebug (const char *, ...) ATTRIBUTE_PRINTF (1, 2);
 
@@ -128,6 +132,26 @@ CORE_ADDR current_insn_ptr;
 
 int emit_error;
 
+/* Nonzero while compiling code that GDBserver itself will run, as
+   opposed to code for the in-process agent.  The code is then written
+   to GDBserver's own memory, and the emitters' helper calls are
+   resolved to functions in GDBserver rather than in the IPA.  */
+
+int emit_host_code;
+
+/* While EMIT_HOST_CODE is set, the end of the area the code is being
+   written to.  Emitting code past it fails the compilation.  */
+
+CORE_ADDR host_code_end;
+
+/* Return the emit_ops vector to use for the code being compiled.  */
+
+static struct emit_ops *
+current_emit_ops (void)
+{
+  return emit_host_code ? target_host_emit_ops () : target_emit_ops ();
+}
+
 struct bytecode_address
 {
   int pc;
@@ -141,169 +165,226 @@ struct bytecode_address
 void
 emit_prologue (void)
 {
-  target_emit_ops ()->emit_prologue ();
+  current_emit_ops ()->emit_prologue ();
 }
 
 void
 emit_epilogue (void)
 {
-  target_emit_ops ()->emit_epilogue ();
+  current_emit_ops ()->emit_epilogue ();
 }
 
 static void
 emit_add (void)
 {
-  target_emit_ops ()->emit_add ();
+  current_emit_ops ()->emit_add ();
 }
 
 static void
 emit_sub (void)
 {
-  target_emit_ops ()->emit_sub ();
+  current_emit_ops ()->emit_sub ();
 }
 
 static void
 emit_mul (void)
 {
-  target_emit_ops ()->emit_mul ();
+  current_emit_ops ()->emit_mul ();
 }
 
 static void
 emit_lsh (void)
 {
-  target_emit_ops ()->emit_lsh ();
+  current_emit_ops ()->emit_lsh ();
 }
 
 static void
 emit_rsh_signed (void)
 {
-  target_emit_ops ()->emit_rsh_signed ();
+  current_emit_ops ()->emit_rsh_signed ();
 }
 
 static void
 emit_rsh_unsigned (void)
 {
-  target_emit_ops ()->emit_rsh_unsigned ();
+  current_emit_ops ()->emit_rsh_unsigned ();
 }
 
 static void
 emit_ext (int arg)
 {
-  target_emit_ops ()->emit_ext (arg);
+  current_emit_ops ()->emit_ext (arg);
 }
 
 static void
 emit_log_not (void)
 {
-  target_emit_ops ()->emit_log_not ();
+  current_emit_ops ()->emit_log_not ();
 }
 
 static void
 emit_bit_and (void)
 {
-  target_emit_ops ()->emit_bit_and ();
+  current_emit_ops ()->emit_bit_and ();
 }
 
 static void
 emit_bit_or (void)
 {
-  target_emit_ops ()->emit_bit_or ();
+  current_emit_ops ()->emit_bit_or ();
 }
 
 static void
 emit_bit_xor (void)
 {
-  target_emit_ops ()->emit_bit_xor ();
+  current_emit_ops ()->emit_bit_xor ();
 }
 
 static void
 emit_bit_not (void)
 {
-  target_emit_ops ()->emit_bit_not ();
+  current_emit_ops ()->emit_bit_not ();
 }
 
 static void
 emit_equal (void)
 {
-  target_emit_ops ()->emit_equal ();
+  current_emit_ops ()->emit_equal ();
 }
 
 static void
 emit_less_signed (void)
 {
-  target_emit_ops ()->emit_less_signed ();
+  current_emit_ops ()->emit_less_signed ();
 }
 
 static void
 emit_less_unsigned (void)
 {
-  target_emit_ops ()->emit_less_unsigned ();
+  current_emit_ops ()->emit_less_unsigned ();
+}
+
+static void emit_int_call_1 (CORE_ADDR fn, int arg1);
+static void emit_void_call_2 (CORE_ADDR fn, int arg1);
+
+/* The value last read by host_ref_read.  */
+
+static ULONGEST host_ref_value;
+
+/* Read SIZE bytes of inferior memory at ADDR, for compiled code run
+   by GDBserver.  The value is fetched by host_ref_result.  */
+
+static void
+host_ref_read (int size, LONGEST addr)
+{
+  union
+  {
+    uint8_t u8;
+    uint16_t u16;
+    uint32_t u32;
+    uint64_t u64;
+  } cnv;
+
+  memset (&cnv, 0, sizeof (cnv));
+  read_inferior_memory ((CORE_ADDR) addr, (unsigned char *) &cnv, size);
+
+  switch (size)
+    {
+    case 1:
+      host_ref_value = cnv.u8;
+      break;
+    case 2:
+      host_ref_value = cnv.u16;
+      break;
+    case 4:
+      host_ref_value = cnv.u32;
+      break;
+    default:
+      host_ref_value = cnv.u64;
+      break;
+    }
+}
+
+static LONGEST
+host_ref_result (int unused)
+{
+  return host_ref_value;
 }
 
 static void
 emit_ref (int size)
 {
-  target_emit_ops ()->emit_ref (size);
+  if (emit_host_code)
+    {
+      /* GDBserver can't dereference inferior addresses directly, so
+	 call back to read the inferior's memory.  The first call
+	 leaves the address on top of the stack, the second replaces
+	 it with the value read.  */
+      emit_void_call_2 ((CORE_ADDR) (uintptr_t) host_ref_read, size);
+      emit_int_call_1 ((CORE_ADDR) (uintptr_t) host_ref_result, 0);
+    }
+  else
+    current_emit_ops ()->emit_ref (size);
 }
 
 static void
 emit_if_goto (int *offset_p, int *size_p)
 {
-  target_emit_ops ()->emit_if_goto (offset_p, size_p);
+  current_emit_ops ()->emit_if_goto (offset_p, size_p);
 }
 
 static void
 emit_goto (int *offset_p, int *size_p)
 {
-  target_emit_ops ()->emit_goto (offset_p, size_p);
+  current_emit_ops ()->emit_goto (offset_p, size_p);
 }
 
 static void
 write_goto_address (CORE_ADDR from, CORE_ADDR to, int size)
 {
-  target_emit_ops ()->write_goto_address (from, to, size);
+  current_emit_ops ()->write_goto_address (from, to, size);
 }
 
 static void
 emit_const (LONGEST num)
 {
-  target_emit_ops ()->emit_const (num);
+  current_emit_ops ()->emit_const (num);
 }
 
 static void
 emit_reg (int reg)
 {
-  target_emit_ops ()->emit_reg (reg);
+  current_emit_ops ()->emit_reg (reg);
 }
 
 static void
 emit_pop (void)
 {
-  target_emit_ops ()->emit_pop ();
+  current_emit_ops ()->emit_pop ();
 }
 
 static void
 emit_stack_flush (void)
 {
-  target_emit_ops ()->emit_stack_flush ();
+  current_emit_ops ()->emit_stack_flush ();
 }
 
 static void
 emit_zero_ext (int arg)
 {
-  target_emit_ops ()->emit_zero_ext (arg);
+  current_emit_ops ()->emit_zero_ext (arg);
 }
 
 static void
 emit_swap (void)
 {
-  target_emit_ops ()->emit_swap ();
+  current_emit_ops ()->emit_swap ();
 }
 
 static void
 emit_stack_adjust (int n)
 {
-  target_emit_ops ()->emit_stack_adjust (n);
+  current_emit_ops ()->emit_stack_adjust (n);
 }
 
 /* FN's prototype is `LONGEST(*fn)(int)'.  */
@@ -311,7 +392,7 @@ emit_stack_adjust (int n)
 static void
 emit_int_call_1 (CORE_ADDR fn, int arg1)
 {
-  target_emit_ops ()->emit_int_call_1 (fn, arg1);
+  current_emit_ops ()->emit_int_call_1 (fn, arg1);
 }
 
 /* FN's prototype is `void(*fn)(int,LONGEST)'.  */
@@ -319,43 +400,43 @@ emit_int_call_1 (CORE_ADDR fn, int arg1)
 static void
 emit_void_call_2 (CORE_ADDR fn, int arg1)
 {
-  target_emit_ops ()->emit_void_call_2 (fn, arg1);
+  current_emit_ops ()->emit_void_call_2 (fn, arg1);
 }
 
 static void
 emit_eq_goto (int *offset_p, int *size_p)
 {
-  target_emit_ops ()->emit_eq_goto (offset_p, size_p);
+  current_emit_ops ()->emit_eq_goto (offset_p, size_p);
 }
 
 static void
 emit_ne_goto (int *offset_p, int *size_p)
 {
-  target_emit_ops ()->emit_ne_goto (offset_p, size_p);
+  current_emit_ops ()->emit_ne_goto (offset_p, size_p);
 }
 
 static void
 emit_lt_goto (int *offset_p, int *size_p)
 {
-  target_emit_ops ()->emit_lt_goto (offset_p, size_p);
+  current_emit_ops ()->emit_lt_goto (offset_p, size_p);
 }
 
 static void
 emit_ge_goto (int *offset_p, int *size_p)
 {
-  target_emit_ops ()->emit_ge_goto (offset_p, size_p);
+  current_emit_ops ()->emit_ge_goto (offset_p, size_p);
 }
 
 static void
 emit_gt_goto (int *offset_p, int *size_p)
 {
-  target_emit_ops ()->emit_gt_goto (offset_p, size_p);
+  current_emit_ops ()->emit_gt_goto (offset_p, size_p);
 }
 
 static void
 emit_le_goto (int *offset_p, int *size_p)
 {
-  target_emit_ops ()->emit_le_goto (offset_p, size_p);
+  current_emit_ops ()->emit_le_goto (offset_p, size_p);
 }
 
 /* Scan an agent expression for any evidence that the given PC is the
@@ -504,7 +585,7 @@ compile_bytecodes (struct agent_expr *aexpr)
 	  next_op = aexpr->bytes[pc];
 	  if (next_op == gdb_agent_op_if_goto
 	      && !is_goto_target (aexpr, pc)
-	      && target_emit_ops ()->emit_eq_goto)
+	      && current_emit_ops ()->emit_eq_goto)
 	    {
 	      ax_debug ("Combining equal & if_goto");
 	      pc += 1;
@@ -517,7 +598,7 @@ compile_bytecodes (struct agent_expr *aexpr)
 	  else if (next_op == gdb_agent_op_log_not
 		   && (aexpr->bytes[pc + 1] == gdb_agent_op_if_goto)
 		   && !is_goto_target (aexpr, pc + 1)
-		   && target_emit_ops ()->emit_ne_goto)
+		   && current_emit_ops ()->emit_ne_goto)
 	    {
 	      ax_debug ("Combining equal & log_not & if_goto");
 	      pc += 2;
@@ -640,6 +721,10 @@ compile_bytecodes (struct agent_expr *aexpr)
 	  emit_stack_flush ();
 	  arg = aexpr->bytes[pc++];
 	  arg = (arg << 8) + aexpr->bytes[pc++];
+	  /* gdb_host_get_raw_reg only returns registers that fit in a
+	     LONGEST; leave wider ones to the interpreter.  */
+	  if (emit_host_code && register_size (arg) > (int) sizeof (LONGEST))
+	    UNHANDLED;
 	  emit_reg (arg);
 	  break;
 
@@ -788,6 +873,228 @@ compile_bytecodes (struct agent_expr *aexpr)
   return expr_eval_no_error;
 }
 
+/* Fetch register REGNUM from REGCACHE, for code compiled by
+   compile_host_agent_expr.  The compiled code's raw registers
+   argument is the regcache.  */
+
+LONGEST
+gdb_host_get_raw_reg (const unsigned char *raw_regs, int regnum)
+{
+  struct regcache *regcache = (struct regcache *) raw_regs;
+  union
+  {
+    uint8_t u8;
+    uint16_t u16;
+    uint32_t u32;
+    uint64_t u64;
+  } cnv;
+
+  /* Check the size before collecting the register, so that a wide
+     register can't overrun CNV.  */
+  switch (register_size (regnum))
+    {
+    case 8:
+      collect_register (regcache, regnum, &cnv.u64);
+      return cnv.u64;
+    case 4:
+      collect_register (regcache, regnum, &cnv.u32);
+      return cnv.u32;
+    case 2:
+      collect_register (regcache, regnum, &cnv.u16);
+      return cnv.u16;
+    case 1:
+      collect_register (regcache, regnum, &cnv.u8);
+      return cnv.u8;
+    default:
+      internal_error (__FILE__, __LINE__, "unhandled register size");
+    }
+}
+
+/* A compiled agent expression, keyed by its bytecode.  GDB resends
+   breakpoint conditions each time it reinserts a breakpoint, so the
+   same expression is typically compiled many times over.  */
+
+struct host_code
+{
+  struct host_code *next;
+
+  /* A copy of the bytecode.  */
+  int length;
+  unsigned char *bytes;
+
+  /* The compiled code, or NULL if the expression can't be
+     compiled.  */
+  host_agent_expr_fn fn;
+
+  /* The executable area FN lives in, and its size.  */
+  void *area;
+  size_t area_size;
+
+  /* The number of breakpoint conditions using FN.  */
+  int refcount;
+};
+
+/* The cache of compiled expressions, most recently used first.  */
+
+static struct host_code *host_code_cache;
+
+/* How many unused entries to keep in HOST_CODE_CACHE, for when their
+   conditions are sent again.  Older unused entries are freed.  */
+
+#define HOST_CODE_CACHE_UNUSED 16
+
+static void
+free_host_code (struct host_code *hc)
+{
+#ifdef HAVE_SYS_MMAN_H
+  if (hc->area != NULL)
+    munmap (hc->area, hc->area_size);
+#endif
+  free (hc->bytes);
+  free (hc);
+}
+
+/* Free the unused entries of HOST_CODE_CACHE past the first
+   HOST_CODE_CACHE_UNUSED ones.  */
+
+static void
+trim_host_code_cache (void)
+{
+  struct host_code **hcp = &host_code_cache;
+  int unused = 0;
+
+  while (*hcp != NULL)
+    {
+      struct host_code *hc = *hcp;
+
+      if (hc->refcount == 0 && ++unused > HOST_CODE_CACHE_UNUSED)
+	{
+	  *hcp = hc->next;
+	  free_host_code (hc);
+	}
+      else
+	hcp = &hc->next;
+    }
+}
+
+/* Compile AEXPR into a new executable area, and return a new cache
+   entry for it.  The entry's FN is NULL if compilation failed.  */
+
+static struct host_code *
+new_host_code (struct agent_expr *aexpr)
+{
+  struct host_code *hc;
+  CORE_ADDR saved_insn_ptr;
+  enum eval_result_type err;
+
+  hc = xcalloc (1, sizeof (*hc));
+  hc->length = aexpr->length;
+  hc->bytes = xmalloc (aexpr->length);
+  memcpy (hc->bytes, aexpr->bytes, aexpr->length);
+
+  if (target_host_emit_ops () == NULL)
+    return hc;
+
+#ifdef HAVE_SYS_MMAN_H
+  /* Most bytecodes expand to far fewer bytes of host code than this;
+     the longest is a memory reference, which becomes two calls.  The
+     emitters fail the compilation rather than overrun the area.  */
+  hc->area_size = 128 * (aexpr->length + 1);
+  hc->area = mmap (NULL, hc->area_size, PROT_READ | PROT_WRITE | PROT_EXEC,
+		   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (hc->area == MAP_FAILED)
+    {
+      hc->area = NULL;
+      return hc;
+    }
+
+  saved_insn_ptr = current_insn_ptr;
+  current_insn_ptr = (CORE_ADDR) (uintptr_t) hc->area;
+  host_code_end = current_insn_ptr + hc->area_size;
+  emit_host_code = 1;
+  emit_error = 0;
+
+  emit_prologue ();
+  if (emit_error)
+    err = expr_eval_unhandled_opcode;
+  else
+    err = compile_bytecodes (aexpr);
+  if (err == expr_eval_no_error)
+    {
+      emit_epilogue ();
+      if (emit_error)
+	err = expr_eval_unhandled_opcode;
+    }
+
+  emit_host_code = 0;
+  current_insn_ptr = saved_insn_ptr;
+
+  if (err == expr_eval_no_error)
+    hc->fn = (host_agent_expr_fn) hc->area;
+  else
+    {
+      if (debug_threads)
+	fprintf (stderr, "Host compilation of agent expression failed, "
+		 "error code %d\n", err);
+
+      munmap (hc->area, hc->area_size);
+      hc->area = NULL;
+    }
+#endif
+
+  return hc;
+}
+
+host_agent_expr_fn
+compile_host_agent_expr (struct agent_expr *aexpr)
+{
+  struct host_code *hc, **hcp;
+
+  for (hcp = &host_code_cache; *hcp != NULL; hcp = &(*hcp)->next)
+    if ((*hcp)->length == aexpr->length
+	&& memcmp ((*hcp)->bytes, aexpr->bytes, aexpr->length) == 0)
+      break;
+
+  if (*hcp != NULL)
+    {
+      hc = *hcp;
+      *hcp = hc->next;
+    }
+  else
+    hc = new_host_code (aexpr);
+
+  hc->next = host_code_cache;
+  host_code_cache = hc;
+
+  if (hc->fn != NULL)
+    hc->refcount++;
+  else
+    trim_host_code_cache ();
+
+  return hc->fn;
+}
+
+void
+release_host_agent_expr (host_agent_expr_fn fn)
+{
+  struct host_code *hc;
+
+  if (fn == NULL)
+    return;
+
+  for (hc = host_code_cache; hc != NULL; hc = hc->next)
+    if (hc->fn == fn)
+      {
+	gdb_assert (hc->refcount > 0);
+	if (--hc->refcount == 0)
+	  trim_host_code_cache ();
+	return;
+      }
+
+  internal_error (__FILE__, __LINE__,
+		  "releasing unknown compiled agent expression");
+}
+
 #endif
 
 /* Make printf-type calls using arguments supplied from the host.  We
@@ -65,6 +65,27 @@ char *gdb_unparse_agent_expr (struct agent_expr *aexpr);
 void emit_prologue (void);
 void emit_epilogue (void);
 enum eval_result_type compile_bytecodes (struct agent_expr *aexpr);
+
+/* Native code for an agent expression, run by GDBserver itself.
+   REGCACHE supplies the registers; the value of the expression is
+   stored in *VALUE.  */
+typedef enum eval_result_type (*host_agent_expr_fn) (struct regcache *regcache,
+						      ULONGEST *value);
+
+/* Compile AEXPR into native code GDBserver can call to evaluate it,
+   faster than gdb_eval_agent_expr does.  The result is cached, and
+   shared between expressions with the same bytecode; each successful
+   call must be matched by a call to release_host_agent_expr.  Returns
+   NULL if AEXPR can't be compiled for this host.  */
+host_agent_expr_fn compile_host_agent_expr (struct agent_expr *aexpr);
+
+/* Release FN, as returned by compile_host_agent_expr, once the
+   condition it was compiled for is deleted.  */
+void release_host_agent_expr (host_agent_expr_fn fn);
+
+/* Read register REGNUM out of RAW_REGS, which is really a
+   struct regcache, on behalf of host-compiled code.  */
+LONGEST gdb_host_get_raw_reg (const unsigned char *raw_regs, int regnum);
 #endif
 
 /* The context when evaluating agent expression.  */
@@ -38,6 +38,15 @@
 #include <unistd.h>
 #endif
 
+/* Every GNU/Linux host has epoll.  Elsewhere, or if the kernel turns
+   out not to support it, file descriptors are watched with select.  */
+
+#ifdef __linux__
+#define USE_EPOLL 1
+#include <sys/epoll.h>
+#include <fcntl.h>
+#endif
+
 typedef struct gdb_event gdb_event;
 typedef int (event_handler_func) (gdb_fildes_t);
 
@@ -104,13 +113,28 @@ DEFINE_QUEUE_P(gdb_event_p);
    in.  These are the input file descriptor, and the target file
    descriptor.  Each of the elements in the gdb_notifier list is
    basically a description of what kind of events gdb is interested
-   in, for each fd.  */
+   in, for each fd.
+
+   Where available, the file descriptors are watched with epoll, whose
+   cost per wait does not grow with the number of descriptors or with
+   their values; otherwise, select is used.  The select masks are
+   maintained in either case, so that we can fall back to select at
+   any time.  */
 
 static struct
   {
     /* Ptr to head of file handler list.  */
     file_handler *first_file_handler;
 
+#ifdef USE_EPOLL
+    /* The epoll instance watching all the file descriptors, or -1 if
+       select is used instead.  */
+    int epoll_fd;
+
+    /* Number of file descriptors registered with EPOLL_FD.  */
+    int num_epoll_fds;
+#endif
+
     /* Masks to be used in the next call to select.  Bits are set in
        response to calls to create_file_handler.  */
     fd_set check_masks[3];
@@ -165,8 +189,55 @@ void
 initialize_event_loop (void)
 {
   event_queue = QUEUE_alloc (gdb_event_p, gdb_event_xfree);
+
+#ifdef USE_EPOLL
+  /* Fall back to select if the kernel lacks epoll.  */
+  gdb_notifier.epoll_fd = epoll_create (1);
+  if (gdb_notifier.epoll_fd != -1)
+    fcntl (gdb_notifier.epoll_fd, F_SETFD, FD_CLOEXEC);
+#endif
+}
+
+#ifdef USE_EPOLL
+
+/* Return the epoll event bits corresponding to the GDB_READABLE,
+   GDB_WRITABLE and GDB_EXCEPTION bits in MASK.  */
+
+static unsigned int
+mask_to_epoll_events (int mask)
+{
+  unsigned int events = 0;
+
+  if (mask & GDB_READABLE)
+    events |= EPOLLIN;
+  if (mask & GDB_WRITABLE)
+    events |= EPOLLOUT;
+  if (mask & GDB_EXCEPTION)
+    events |= EPOLLPRI;
+  return events;
+}
+
+/* Return the GDB_READABLE, GDB_WRITABLE and GDB_EXCEPTION bits
+   corresponding to the epoll event bits EVENTS.  As with select, a
+   hang-up or error makes the file descriptor readable, so that the
+   handler gets to see the end-of-file or error.  */
+
+static int
+epoll_events_to_mask (unsigned int events)
+{
+  int mask = 0;
+
+  if (events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+    mask |= GDB_READABLE;
+  if (events & EPOLLOUT)
+    mask |= GDB_WRITABLE;
+  if (events & EPOLLPRI)
+    mask |= GDB_EXCEPTION;
+  return mask;
 }
 
+#endif
+
 /* Process one event.  If an event was processed, 1 is returned
    otherwise 0 is returned.  Scan the queue from head to tail,
    processing therefore the high priority events first, by invoking
@@ -302,6 +373,27 @@ create_file_handler (gdb_fildes_t fd, int mask, handler_func *proc,
       file_ptr->next_file = gdb_notifier.first_file_handler;
       gdb_notifier.first_file_handler = file_ptr;
 
+#ifdef USE_EPOLL
+      if (gdb_notifier.epoll_fd != -1)
+	{
+	  struct epoll_event ev;
+
+	  memset (&ev, 0, sizeof (ev));
+	  ev.events = mask_to_epoll_events (mask);
+	  ev.data.ptr = file_ptr;
+	  if (epoll_ctl (gdb_notifier.epoll_fd, EPOLL_CTL_ADD, fd, &ev) == 0)
+	    gdb_notifier.num_epoll_fds++;
+	  else
+	    {
+	      /* Some descriptors, e.g. regular files, can't be watched
+		 with epoll.  The select masks are always kept up to date,
+		 so just switch to select for good.  */
+	      close (gdb_notifier.epoll_fd);
+	      gdb_notifier.epoll_fd = -1;
+	    }
+	}
+#endif
+
       if (mask & GDB_READABLE)
 	FD_SET (fd, &gdb_notifier.check_masks[0]);
       else
@@ -355,6 +447,18 @@ delete_file_handler (gdb_fildes_t fd)
   if (file_ptr == NULL)
     return;
 
+#ifdef USE_EPOLL
+  if (gdb_notifier.epoll_fd != -1)
+    {
+      struct epoll_event ev;
+
+      /* The descriptor may have been closed already, in which case the
+	 kernel dropped it from the epoll set by itself.  */
+      epoll_ctl (gdb_notifier.epoll_fd, EPOLL_CTL_DEL, fd, &ev);
+      gdb_notifier.num_epoll_fds--;
+    }
+#endif
+
   if (file_ptr->mask & GDB_READABLE)
     FD_CLR (fd, &gdb_notifier.check_masks[0]);
   if (file_ptr->mask & GDB_WRITABLE)
@@ -460,6 +564,67 @@ create_file_event (gdb_fildes_t fd)
   return file_event_ptr;
 }
 
+/* Note that FILE_PTR's file descriptor has the events in MASK
+   pending, and queue a file event for it, unless one is queued
+   already.  */
+
+static void
+note_file_ready (file_handler *file_ptr, int mask)
+{
+  /* Enqueue an event only if this is still a new event for this
+     fd.  */
+
+  if (file_ptr->ready_mask == 0)
+    {
+      gdb_event *file_event_ptr = create_file_event (file_ptr->fd);
+
+      QUEUE_enque (gdb_event_p, event_queue, file_event_ptr);
+    }
+  file_ptr->ready_mask = mask;
+}
+
+#ifdef USE_EPOLL
+
+/* The epoll flavor of wait_for_event.  */
+
+static int
+wait_for_event_epoll (void)
+{
+  struct epoll_event events[16];
+  int num_found, i;
+
+  if (gdb_notifier.num_epoll_fds == 0)
+    return -1;
+
+  num_found = epoll_wait (gdb_notifier.epoll_fd, events,
+			  sizeof (events) / sizeof (events[0]), -1);
+  if (num_found == -1)
+    {
+#ifdef EINTR
+      /* Dont print anything if we got a signal, let gdb handle
+	 it.  */
+      if (errno != EINTR)
+	perror_with_name ("epoll_wait");
+#endif
+      return 0;
+    }
+
+  /* Enqueue all detected file events.  Descriptors that are still
+     ready and did not fit in EVENTS are reported by the next call.  */
+  for (i = 0; i < num_found; i++)
+    {
+      file_handler *file_ptr = events[i].data.ptr;
+      int mask = epoll_events_to_mask (events[i].events) & file_ptr->mask;
+
+      if (mask != 0)
+	note_file_ready (file_ptr, mask);
+    }
+
+  return 0;
+}
+
+#endif
+
 /* Called by do_one_event to wait for new events on the monitored file
    descriptors.  Queue file events as they are detected by the poll.
    If there are no events, this function will block in the call to
@@ -476,6 +641,11 @@ wait_for_event (void)
   fflush (stdout);
   fflush (stderr);
 
+#ifdef USE_EPOLL
+  if (gdb_notifier.epoll_fd != -1)
+    return wait_for_event_epoll ();
+#endif
+
   if (gdb_notifier.num_fds == 0)
     return -1;
 
@@ -522,16 +692,7 @@ wait_for_event (void)
       else
 	num_found--;
 
-      /* Enqueue an event only if this is still a new event for this
-	 fd.  */
-
-      if (file_ptr->ready_mask == 0)
-	{
-	  gdb_event *file_event_ptr = create_file_event (file_ptr->fd);
-
-	  QUEUE_enque (gdb_event_p, event_queue, file_event_ptr);
-	}
-      file_ptr->ready_mask = mask;
+      note_file_ready (file_ptr, mask);
     }
 
   return 0;
@@ -62,10 +62,26 @@ struct thread_info
 
   /* Branch trace target information for this thread.  */
   struct btrace_target_info *btrace;
+
+  /* The thread list generation at which this thread was added, or
+     at which its core last changed.  */
+  unsigned int generation;
+
+  /* The core this thread was last reported running on, or -1 if
+     unknown.  */
+  int core;
 };
 
 extern struct inferior_list all_threads;
 
+/* Thread list generation.  Bumped every time a thread is added to or
+   removed from ALL_THREADS, or a thread is seen on a different core.  */
+extern unsigned int thread_list_generation;
+
+int thread_list_delta_available (unsigned int since);
+void for_each_exited_thread (unsigned int since,
+			     void (*callback) (ptid_t, void *), void *data);
+
 void remove_thread (struct thread_info *thread);
 void add_thread (ptid_t ptid, void *target_data);
 
@@ -28,18 +28,100 @@ struct inferior_list all_threads;
 
 struct thread_info *current_inferior;
 
+unsigned int thread_list_generation;
+
+/* A record of a thread that was removed from ALL_THREADS, kept so that
+   GDB can be told about exited threads incrementally.  */
+
+struct exited_thread
+{
+  ptid_t ptid;
+
+  /* The thread list generation at which the thread was removed.  */
+  unsigned int generation;
+};
+
+/* Ring buffer of the most recently exited threads.  */
+
+#define EXITED_THREADS_LOG_SIZE 1024
+
+static struct exited_thread exited_threads_log[EXITED_THREADS_LOG_SIZE];
+
+/* Index of the next slot to fill in EXITED_THREADS_LOG, and number of
+   valid entries.  */
+static int exited_threads_log_next;
+static int exited_threads_log_count;
+
+/* Exit records of generations up to and including this one may have
+   been discarded, so no delta can be computed from an older
+   generation.  */
+static unsigned int exited_threads_log_floor;
+
 #define get_thread(inf) ((struct thread_info *)(inf))
 
+/* Return the hash of the inferior id ID.  */
+
+static unsigned int
+hash_inferior_id (ptid_t id)
+{
+  unsigned int hash;
+
+  hash = ptid_get_pid (id);
+  hash = hash * 31 + (unsigned int) ptid_get_lwp (id);
+  hash = hash * 31 + (unsigned int) ptid_get_tid (id);
+  return hash;
+}
+
+/* Add ENTRY to the hash table of LIST.  */
+
+static void
+hash_inferior (struct inferior_list *list, struct inferior_list_entry *entry)
+{
+  struct inferior_list_entry **bucket;
+
+  bucket = &list->buckets[hash_inferior_id (entry->id) % list->num_buckets];
+  entry->hash_prev = NULL;
+  entry->hash_next = *bucket;
+  if (*bucket != NULL)
+    (*bucket)->hash_prev = entry;
+  *bucket = entry;
+}
+
+/* Make sure the hash table of LIST has room for one more entry,
+   growing and rehashing it if it is getting crowded.  */
+
+static void
+grow_inferior_hash (struct inferior_list *list)
+{
+  struct inferior_list_entry *inf;
+
+  if (list->count < list->num_buckets * 2)
+    return;
+
+  free (list->buckets);
+  list->num_buckets = list->num_buckets == 0 ? 16 : list->num_buckets * 2;
+  list->buckets = xcalloc (list->num_buckets, sizeof (list->buckets[0]));
+
+  for (inf = list->head; inf != NULL; inf = inf->next)
+    hash_inferior (list, inf);
+}
+
 void
 add_inferior_to_list (struct inferior_list *list,
 		      struct inferior_list_entry *new_inferior)
 {
+  grow_inferior_hash (list);
+
   new_inferior->next = NULL;
+  new_inferior->prev = list->tail;
   if (list->tail != NULL)
     list->tail->next = new_inferior;
   else
     list->head = new_inferior;
   list->tail = new_inferior;
+
+  hash_inferior (list, new_inferior);
+  list->count++;
 }
 
 /* Invoke ACTION for each inferior in LIST.  */
@@ -62,27 +144,44 @@ void
 remove_inferior (struct inferior_list *list,
 		 struct inferior_list_entry *entry)
 {
-  struct inferior_list_entry **cur;
+  /* Nothing to do if ENTRY isn't in LIST.  */
+  if (entry->prev == NULL && list->head != entry)
+    return;
 
-  if (list->head == entry)
-    {
-      list->head = entry->next;
-      if (list->tail == entry)
-	list->tail = list->head;
-      return;
-    }
+  if (entry->prev != NULL)
+    entry->prev->next = entry->next;
+  else
+    list->head = entry->next;
 
-  cur = &list->head;
-  while (*cur && (*cur)->next != entry)
-    cur = &(*cur)->next;
+  if (entry->next != NULL)
+    entry->next->prev = entry->prev;
+  else
+    list->tail = entry->prev;
 
-  if (*cur == NULL)
-    return;
+  if (entry->hash_prev != NULL)
+    entry->hash_prev->hash_next = entry->hash_next;
+  else
+    list->buckets[hash_inferior_id (entry->id) % list->num_buckets]
+      = entry->hash_next;
 
-  (*cur)->next = entry->next;
+  if (entry->hash_next != NULL)
+    entry->hash_next->hash_prev = entry->hash_prev;
 
-  if (list->tail == entry)
-    list->tail = *cur;
+  entry->next = entry->prev = NULL;
+  entry->hash_next = entry->hash_prev = NULL;
+  list->count--;
+}
+
+/* Empty LIST, without freeing its entries.  */
+
+void
+clear_inferior_list (struct inferior_list *list)
+{
+  list->head = list->tail = NULL;
+  list->count = 0;
+  if (list->buckets != NULL)
+    memset (list->buckets, 0,
+	    list->num_buckets * sizeof (list->buckets[0]));
 }
 
 void
@@ -93,6 +192,8 @@ add_thread (ptid_t thread_id, void *target_data)
   memset (new_thread, 0, sizeof (*new_thread));
 
   new_thread->entry.id = thread_id;
+  new_thread->generation = ++thread_list_generation;
+  new_thread->core = -1;
   new_thread->last_resume_kind = resume_continue;
   new_thread->last_status.kind = TARGET_WAITKIND_IGNORE;
 
@@ -108,14 +209,8 @@ add_thread (ptid_t thread_id, void *target_data)
 ptid_t
 thread_id_to_gdb_id (ptid_t thread_id)
 {
-  struct inferior_list_entry *inf = all_threads.head;
-
-  while (inf != NULL)
-    {
-      if (ptid_equal (inf->id, thread_id))
-	return thread_id;
-      inf = inf->next;
-    }
+  if (find_inferior_id (&all_threads, thread_id) != NULL)
+    return thread_id;
 
   return null_ptid;
 }
@@ -129,17 +224,7 @@ thread_to_gdb_id (struct thread_info *thread)
 struct thread_info *
 find_thread_ptid (ptid_t ptid)
 {
-  struct inferior_list_entry *inf = all_threads.head;
-
-  while (inf != NULL)
-    {
-      struct thread_info *thread = get_thread (inf);
-      if (ptid_equal (thread->entry.id, ptid))
-	return thread;
-      inf = inf->next;
-    }
-
-  return NULL;
+  return get_thread (find_inferior_id (&all_threads, ptid));
 }
 
 ptid_t
@@ -158,16 +243,73 @@ free_one_thread (struct inferior_list_entry *inf)
   free (thread);
 }
 
+/* Record that the thread with id PTID exited, bumping the thread list
+   generation.  */
+
+static void
+log_exited_thread (ptid_t ptid)
+{
+  struct exited_thread *slot = &exited_threads_log[exited_threads_log_next];
+
+  if (exited_threads_log_count == EXITED_THREADS_LOG_SIZE)
+    {
+      /* Overwriting the oldest record; deltas from before it can no
+	 longer be computed.  */
+      exited_threads_log_floor = slot->generation;
+    }
+  else
+    exited_threads_log_count++;
+
+  slot->ptid = ptid;
+  slot->generation = ++thread_list_generation;
+  exited_threads_log_next
+    = (exited_threads_log_next + 1) % EXITED_THREADS_LOG_SIZE;
+}
+
 void
 remove_thread (struct thread_info *thread)
 {
   if (thread->btrace != NULL)
     target_disable_btrace (thread->btrace);
 
+  log_exited_thread (thread->entry.id);
   remove_inferior (&all_threads, (struct inferior_list_entry *) thread);
   free_one_thread (&thread->entry);
 }
 
+/* Return non-zero if the changes to the thread list since generation
+   SINCE can be described incrementally, i.e., all threads that exited
+   after SINCE are still recorded.  */
+
+int
+thread_list_delta_available (unsigned int since)
+{
+  return (since != 0
+	  && since <= thread_list_generation
+	  && since >= exited_threads_log_floor);
+}
+
+/* Call CALLBACK for each thread that exited after generation SINCE,
+   oldest first.  */
+
+void
+for_each_exited_thread (unsigned int since,
+			void (*callback) (ptid_t, void *), void *data)
+{
+  int first = (exited_threads_log_next - exited_threads_log_count
+	       + EXITED_THREADS_LOG_SIZE) % EXITED_THREADS_LOG_SIZE;
+  int i;
+
+  for (i = 0; i < exited_threads_log_count; i++)
+    {
+      struct exited_thread *rec
+	= &exited_threads_log[(first + i) % EXITED_THREADS_LOG_SIZE];
+
+      if (rec->generation > since)
+	callback (rec->ptid, data);
+    }
+}
+
 /* Find the first inferior_list_entry E in LIST for which FUNC (E, ARG)
    returns non-zero.  If no entry is found then return NULL.  */
 
@@ -193,14 +335,16 @@ find_inferior (struct inferior_list *list,
 struct inferior_list_entry *
 find_inferior_id (struct inferior_list *list, ptid_t id)
 {
-  struct inferior_list_entry *inf = list->head;
+  struct inferior_list_entry *inf;
 
-  while (inf != NULL)
-    {
-      if (ptid_equal (inf->id, id))
-	return inf;
-      inf = inf->next;
-    }
+  if (list->buckets == NULL)
+    return NULL;
+
+  for (inf = list->buckets[hash_inferior_id (id) % list->num_buckets];
+       inf != NULL;
+       inf = inf->hash_next)
+    if (ptid_equal (inf->id, id))
+      return inf;
 
   return NULL;
 }
@@ -229,14 +373,15 @@ set_inferior_regcache_data (struct thread_info *inferior, void *data)
   inferior->regcache_data = data;
 }
 
-#define clear_list(LIST) \
-  do { (LIST)->head = (LIST)->tail = NULL; } while (0)
-
 void
 clear_inferiors (void)
 {
   for_each_inferior (&all_threads, free_one_thread);
-  clear_list (&all_threads);
+  clear_inferior_list (&all_threads);
+
+  /* The threads just freed were not logged as exited, so force the
+     next thread list request to be answered in full.  */
+  exited_threads_log_floor = ++thread_list_generation;
 
   clear_dlls ();
 
@@ -223,6 +223,8 @@ static int finish_step_over (struct lwp_info *lwp);
 static CORE_ADDR get_stop_pc (struct lwp_info *lwp);
 static int kill_lwp (unsigned long lwpid, int signo);
 static void linux_enable_event_reporting (int pid);
+static int linux_fast_tracepoint_collecting
+  (struct lwp_info *lwp, struct fast_tpoint_collect_status *status);
 
 /* True if the low target can hardware single-step.  Such targets
    don't need a BREAKPOINT_REINSERT_ADDR callback.  */
@@ -1494,6 +1496,28 @@ handle_tracepoints (struct lwp_info *lwp)
      actions.  */
   tpoint_related_event |= tracepoint_was_hit (tinfo, lwp->stop_pc);
 
+  /* If the in-process agent found the condition of a fast conditional
+     breakpoint true, run to the relocated original instruction in the
+     jump pad, and report the breakpoint hit from there.  */
+  if (fast_gdb_breakpoint_hit (lwp->stop_pc))
+    {
+      struct fast_tpoint_collect_status status;
+
+      if (linux_fast_tracepoint_collecting (lwp, &status) == 1)
+	{
+	  if (debug_threads)
+	    fprintf (stderr, "LWP %ld hit fast breakpoint at 0x%s\n",
+		     lwpid_of (lwp), paddress (status.tpoint_addr));
+
+	  lwp->collecting_fast_tracepoint = 1;
+	  lwp->reporting_fast_breakpoint = 1;
+	  if (lwp->exit_jump_pad_bkpt == NULL)
+	    lwp->exit_jump_pad_bkpt
+	      = set_breakpoint_at (status.adjusted_insn_addr, NULL);
+	  tpoint_related_event = 1;
+	}
+    }
+
   lwp->suspended--;
 
   gdb_assert (lwp->suspended == 0);
@@ -2315,6 +2339,9 @@ linux_wait_1 (ptid_t ptid,
   int maybe_internal_trap;
   int report_to_gdb;
   int trace_event;
+  int fast_breakpoint_event;
+  int sw_watch_step;
+  int sw_watch_triggered;
 
   /* Translate generic target options into linux options.  */
   options = __WALL;
@@ -2324,6 +2351,9 @@ linux_wait_1 (ptid_t ptid,
 retry:
   bp_explains_trap = 0;
   trace_event = 0;
+  fast_breakpoint_event = 0;
+  sw_watch_step = 0;
+  sw_watch_triggered = 0;
   ourstatus->kind = TARGET_WAITKIND_IGNORE;
 
   /* If we were only supposed to resume one thread, only wait for
@@ -2453,6 +2483,16 @@ retry:
 	 breakpoints.  */
       trace_event = handle_tracepoints (event_child);
 
+      /* If GDB has software watchpoints, check whether the watched
+	 memory changed.  If not, and we were only stepping for them,
+	 this trap is ours.  */
+      if (sw_watchpoints_p ())
+	{
+	  sw_watch_triggered = sw_watchpoint_triggered ();
+	  sw_watch_step = (event_child->stepping
+			   && current_inferior->last_resume_kind != resume_step);
+	}
+
       if (bp_explains_trap)
 	{
 	  /* If we stepped or ran into an internal breakpoint, we've
@@ -2508,6 +2548,8 @@ retry:
 
   if (event_child->collecting_fast_tracepoint)
     {
+      struct fast_tpoint_collect_status status;
+
       if (debug_threads)
 	fprintf (stderr, "\
 LWP %ld was trying to move out of the jump pad (%d).  \
@@ -2518,7 +2560,7 @@ Check if we're already there.\n",
       trace_event = 1;
 
       event_child->collecting_fast_tracepoint
-	= linux_fast_tracepoint_collecting (event_child, NULL);
+	= linux_fast_tracepoint_collecting (event_child, &status);
 
       if (event_child->collecting_fast_tracepoint != 1)
 	{
@@ -2549,6 +2591,30 @@ Check if we're already there.\n",
 	    }
 	}
 
+      if (event_child->reporting_fast_breakpoint
+	  && event_child->collecting_fast_tracepoint == 2
+	  && event_child->stop_pc == status.adjusted_insn_addr)
+	{
+	  struct regcache *regcache = get_thread_regcache (current_inferior, 1);
+
+	  /* The thread is about to execute the relocated instruction,
+	     with the registers as they were at the fast breakpoint's
+	     address.  Make it look like it trapped on a breakpoint
+	     there.  */
+	  if (debug_threads)
+	    fprintf (stderr, "Reporting fast breakpoint hit at 0x%s.\n",
+		     paddress (status.tpoint_addr));
+
+	  (*the_low_target.set_pc) (regcache,
+				    status.tpoint_addr
+				    + the_low_target.decr_pc_after_break);
+	  event_child->stop_pc = status.tpoint_addr;
+	  event_child->collecting_fast_tracepoint = 0;
+	  event_child->reporting_fast_breakpoint = 0;
+	  event_child->need_step_over = 0;
+	  fast_breakpoint_event = 1;
+	}
+
       if (event_child->collecting_fast_tracepoint == 0)
 	{
 	  if (debug_threads)
@@ -2626,10 +2692,12 @@ Check if we're already there.\n",
      internal breakpoint and still reporting the event to GDB.  If we
      don't, we're out of luck, GDB won't see the breakpoint hit.  */
   report_to_gdb = (!maybe_internal_trap
+		   || fast_breakpoint_event
 		   || current_inferior->last_resume_kind == resume_step
 		   || event_child->stopped_by_watchpoint
+		   || sw_watch_triggered
 		   || (!step_over_finished
-		       && !bp_explains_trap && !trace_event)
+		       && !bp_explains_trap && !trace_event && !sw_watch_step)
 		   || (gdb_breakpoint_here (event_child->stop_pc)
 		       && gdb_condition_true_at_breakpoint (event_child->stop_pc)
 		       && gdb_no_commands_at_breakpoint (event_child->stop_pc)));
@@ -2649,6 +2717,8 @@ Check if we're already there.\n",
 	    fprintf (stderr, "Step-over finished.\n");
 	  if (trace_event)
 	    fprintf (stderr, "Tracepoint event.\n");
+	  if (sw_watch_step)
+	    fprintf (stderr, "Software watchpoint step.\n");
 	}
 
       /* We're not reporting this breakpoint to GDB, so apply the
@@ -2683,6 +2753,8 @@ Check if we're already there.\n",
 	fprintf (stderr, "GDB wanted to single-step, reporting event.\n");
       if (event_child->stopped_by_watchpoint)
 	fprintf (stderr, "Stopped by watchpoint.\n");
+      if (sw_watch_triggered)
+	fprintf (stderr, "Software watchpoint triggered.\n");
       if (gdb_breakpoint_here (event_child->stop_pc))
 	fprintf (stderr, "Stopped by GDB breakpoint.\n");
       if (debug_threads)
@@ -3266,6 +3338,19 @@ lwp %ld wants to get out of fast tracepoint jump pad single-stepping\n",
       step = 1;
     }
 
+  /* Likewise if GDB asked us to check software watchpoints after each
+     instruction.  */
+  if (!step
+      && get_thread_process (get_lwp_thread (lwp))->sw_watchpoints != NULL
+      && can_hardware_single_step ())
+    {
+      if (debug_threads)
+	fprintf (stderr,
+		 "lwp %ld has software watchpoints -> forcing step.\n",
+		 lwpid_of (lwp));
+      step = 1;
+    }
+
   if (debug_threads && the_low_target.get_pc != NULL)
     {
       struct regcache *regcache = get_thread_regcache (current_inferior, 1);
@@ -4395,6 +4480,56 @@ linux_store_registers (struct regcache *regcache, int regno)
 }
 
 
+#if defined HAVE_PROCESS_VM_READV && defined HAVE_PROCESS_VM_WRITEV
+#define USE_PROCESS_VM 1
+
+/* Zero if process_vm_readv/process_vm_writev turned out not to be
+   implemented by the running kernel.  */
+static int linux_process_vm_works = 1;
+
+/* Transfer LEN bytes between debugger memory at MYADDR and the
+   memory of process PID at MEMADDR with a single process_vm_readv
+   (or, if WRITE, process_vm_writev) call.  Returns the number of
+   bytes transferred, which may be short if part of the range is
+   inaccessible, or -1 on error.  */
+
+static int
+linux_process_vm_xfer (int pid, CORE_ADDR memaddr, unsigned char *myaddr,
+		       int len, int write)
+{
+  struct iovec local_iov, remote_iov;
+  ssize_t bytes;
+
+  local_iov.iov_base = myaddr;
+  local_iov.iov_len = len;
+  remote_iov.iov_base = (void *) (uintptr_t) memaddr;
+  remote_iov.iov_len = len;
+
+  if (write)
+    bytes = process_vm_writev (pid, &local_iov, 1, &remote_iov, 1, 0);
+  else
+    bytes = process_vm_readv (pid, &local_iov, 1, &remote_iov, 1, 0);
+
+  if (bytes < 0 && errno == ENOSYS)
+    linux_process_vm_works = 0;
+
+  return bytes;
+}
+#endif
+
+/* Report, if debugging, how many system calls it took to transfer
+   LEN bytes at MEMADDR.  */
+
+static void
+linux_debug_memory_xfer (const char *func, CORE_ADDR memaddr, int len,
+			 int syscalls)
+{
+  if (debug_threads && syscalls > 0)
+    fprintf (stderr, "%s: %d bytes at %s in %d syscalls "
+	     "(%d bytes/syscall)\n",
+	     func, len, paddress (memaddr), syscalls, len / syscalls);
+}
+
 /* Copy LEN bytes from inferior's memory starting at MEMADDR
    to debugger memory starting at MYADDR.  */
 
@@ -4409,6 +4544,36 @@ linux_read_memory (CORE_ADDR memaddr, unsigned char *myaddr, int len)
   register int i;
   int ret;
   int fd;
+  CORE_ADDR orig_memaddr = memaddr;
+  int orig_len = len;
+  int syscalls = 0;
+
+#ifdef USE_PROCESS_VM
+  /* Try process_vm_readv first; it reads the whole range with a
+     single system call, and needs no file descriptor.  */
+  if (linux_process_vm_works && len > 0)
+    {
+      int bytes;
+
+      bytes = linux_process_vm_xfer (pid, memaddr, myaddr, len, 0);
+      syscalls++;
+      if (bytes == len)
+	{
+	  linux_debug_memory_xfer ("linux_read_memory", orig_memaddr,
+				   orig_len, syscalls);
+	  return 0;
+	}
+
+      /* Some data was read, we'll try to get the rest some other
+	 way.  */
+      if (bytes > 0)
+	{
+	  memaddr += bytes;
+	  myaddr += bytes;
+	  len -= bytes;
+	}
+    }
+#endif
 
   /* Try using /proc.  Don't bother for one word.  */
   if (len >= 3 * sizeof (long))
@@ -4435,8 +4600,13 @@ linux_read_memory (CORE_ADDR memaddr, unsigned char *myaddr, int len)
 #endif
 
       close (fd);
+      syscalls++;
       if (bytes == len)
-	return 0;
+	{
+	  linux_debug_memory_xfer ("linux_read_memory", orig_memaddr,
+				   orig_len, syscalls);
+	  return 0;
+	}
 
       /* Some data was read, we'll try to get the rest with ptrace.  */
       if (bytes > 0)
@@ -4469,6 +4639,7 @@ linux_read_memory (CORE_ADDR memaddr, unsigned char *myaddr, int len)
 	break;
     }
   ret = errno;
+  syscalls += ret ? i + 1 : i;
 
   /* Copy appropriate bytes out of the buffer.  */
   if (i > 0)
@@ -4480,6 +4651,8 @@ linux_read_memory (CORE_ADDR memaddr, unsigned char *myaddr, int len)
 	      i < len ? i : len);
     }
 
+  linux_debug_memory_xfer ("linux_read_memory", orig_memaddr, orig_len,
+			   syscalls);
   return ret;
 }
 
@@ -4491,18 +4664,13 @@ static int
 linux_write_memory (CORE_ADDR memaddr, const unsigned char *myaddr, int len)
 {
   register int i;
-  /* Round starting address down to longword boundary.  */
-  register CORE_ADDR addr = memaddr & -(CORE_ADDR) sizeof (PTRACE_XFER_TYPE);
-  /* Round ending address up; get number of longwords that makes.  */
-  register int count
-    = (((memaddr + len) - addr) + sizeof (PTRACE_XFER_TYPE) - 1)
-    / sizeof (PTRACE_XFER_TYPE);
-
-  /* Allocate buffer of that many longwords.  */
-  register PTRACE_XFER_TYPE *buffer = (PTRACE_XFER_TYPE *)
-    alloca (count * sizeof (PTRACE_XFER_TYPE));
-
+  register CORE_ADDR addr;
+  register int count;
+  register PTRACE_XFER_TYPE *buffer;
   int pid = lwpid_of (get_thread_lwp (current_inferior));
+  CORE_ADDR orig_memaddr = memaddr;
+  int orig_len = len;
+  int syscalls = 0;
 
   if (len == 0)
     {
@@ -4524,6 +4692,44 @@ linux_write_memory (CORE_ADDR memaddr, const unsigned char *myaddr, int len)
 	       val, (long)memaddr);
     }
 
+#ifdef USE_PROCESS_VM
+  /* Try process_vm_writev first.  It honours page protections, so it
+     fails on read-only pages such as program text, which we still
+     write with ptrace below.  Breakpoints are mostly inserted in
+     text, so don't bother for one word.  */
+  if (linux_process_vm_works && len >= 3 * sizeof (long))
+    {
+      int bytes;
+
+      bytes = linux_process_vm_xfer (pid, memaddr, (unsigned char *) myaddr,
+				     len, 1);
+      syscalls++;
+      if (bytes == len)
+	{
+	  linux_debug_memory_xfer ("linux_write_memory", orig_memaddr,
+				   orig_len, syscalls);
+	  return 0;
+	}
+
+      /* Some data was written, we'll write the rest with ptrace.  */
+      if (bytes > 0)
+	{
+	  memaddr += bytes;
+	  myaddr += bytes;
+	  len -= bytes;
+	}
+    }
+#endif
+
+  /* Round starting address down to longword boundary.  */
+  addr = memaddr & -(CORE_ADDR) sizeof (PTRACE_XFER_TYPE);
+  /* Round ending address up; get number of longwords that makes.  */
+  count = ((((memaddr + len) - addr) + sizeof (PTRACE_XFER_TYPE) - 1)
+	   / sizeof (PTRACE_XFER_TYPE));
+
+  /* Allocate buffer of that many longwords.  */
+  buffer = (PTRACE_XFER_TYPE *) alloca (count * sizeof (PTRACE_XFER_TYPE));
+
   /* Fill start and end extra bytes of buffer with existing memory data.  */
 
   errno = 0;
@@ -4532,6 +4738,7 @@ linux_write_memory (CORE_ADDR memaddr, const unsigned char *myaddr, int len)
   buffer[0] = ptrace (PTRACE_PEEKTEXT, pid,
 		      (PTRACE_ARG3_TYPE) (uintptr_t) addr,
 		      (PTRACE_ARG4_TYPE) 0);
+  syscalls++;
   if (errno)
     return errno;
 
@@ -4545,6 +4752,7 @@ linux_write_memory (CORE_ADDR memaddr, const unsigned char *myaddr, int len)
 		  (PTRACE_ARG3_TYPE) (uintptr_t) (addr + (count - 1)
 						  * sizeof (PTRACE_XFER_TYPE)),
 		  (PTRACE_ARG4_TYPE) 0);
+      syscalls++;
       if (errno)
 	return errno;
     }
@@ -4564,10 +4772,13 @@ linux_write_memory (CORE_ADDR memaddr, const unsigned char *myaddr, int len)
 		 about coercing an 8 byte integer to a 4 byte pointer.  */
 	      (PTRACE_ARG3_TYPE) (uintptr_t) addr,
 	      (PTRACE_ARG4_TYPE) buffer[i]);
+      syscalls++;
       if (errno)
 	return errno;
     }
 
+  linux_debug_memory_xfer ("linux_write_memory", orig_memaddr, orig_len,
+			   syscalls);
   return 0;
 }
 
@@ -4797,11 +5008,27 @@ linux_read_auxv (CORE_ADDR offset, unsigned char *myaddr, unsigned int len)
 
 /* These breakpoint and watchpoint related wrapper functions simply
    pass on the function call if the target has registered a
-   corresponding function.  */
+   corresponding function.  Software watchpoints are handled here for
+   all targets that can single-step in hardware.  */
 
 static int
 linux_insert_point (char type, CORE_ADDR addr, int len)
 {
+  if (type == '5')
+    {
+      int ret;
+
+      if (!can_hardware_single_step ())
+	return 1;
+
+      ret = prepare_to_access_memory ();
+      if (ret)
+	return -1;
+      ret = set_sw_watchpoint (addr, len);
+      done_accessing_memory ();
+      return ret;
+    }
+
   if (the_low_target.insert_point != NULL)
     return the_low_target.insert_point (type, addr, len);
   else
@@ -4812,6 +5039,9 @@ linux_insert_point (char type, CORE_ADDR addr, int len)
 static int
 linux_remove_point (char type, CORE_ADDR addr, int len)
 {
+  if (type == '5')
+    return delete_sw_watchpoint (addr, len);
+
   if (the_low_target.remove_point != NULL)
     return the_low_target.remove_point (type, addr, len);
   else
@@ -5362,6 +5592,15 @@ linux_emit_ops (void)
     return NULL;
 }
 
+static struct emit_ops *
+linux_host_emit_ops (void)
+{
+  if (the_low_target.host_emit_ops != NULL)
+    return (*the_low_target.host_emit_ops) ();
+  else
+    return NULL;
+}
+
 static int
 linux_get_min_fast_tracepoint_insn_len (void)
 {
@@ -5941,6 +6180,7 @@ static struct target_ops linux_target_ops = {
   NULL,
   NULL,
 #endif
+  linux_host_emit_ops,
 };
 
 static void
@@ -168,6 +168,10 @@ struct linux_target_ops
      for use as a fast tracepoint.  */
   int (*get_min_fast_tracepoint_insn_len) (void);
 
+  /* Return the bytecode operations vector for code run by GDBserver
+     itself.  Returns NULL if host bytecode compilation is not
+     supported.  */
+  struct emit_ops *(*host_emit_ops) (void);
 };
 
 extern struct linux_target_ops the_low_target;
@@ -265,6 +269,11 @@ struct lwp_info
      a exit-jump-pad-quickly breakpoint.  This is it.  */
   struct breakpoint *exit_jump_pad_bkpt;
 
+  /* True if the condition of a fast conditional breakpoint was found
+     true by the in-process agent, and this lwp is moving out of the
+     breakpoint's jump pad so that the hit can be reported to GDB.  */
+  int reporting_fast_breakpoint;
+
   /* True if the LWP was seen stop at an internal breakpoint and needs
      stepping over later when it is resumed.  */
   int need_step_over;
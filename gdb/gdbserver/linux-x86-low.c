@@ -1371,7 +1371,20 @@ x86_supports_tracepoints (void)
 static void
 append_insns (CORE_ADDR *to, size_t len, const unsigned char *buf)
 {
-  write_inferior_memory (*to, buf, len);
+  /* Code compiled for GDBserver itself lives in our own address
+     space.  Fail the compilation rather than write past the area
+     reserved for it.  */
+  if (emit_host_code)
+    {
+      if (*to + len > host_code_end)
+	{
+	  emit_error = 1;
+	  return;
+	}
+      memcpy ((void *) (uintptr_t) *to, buf, len);
+    }
+  else
+    write_inferior_memory (*to, buf, len);
   *to += len;
 }
 
@@ -1424,8 +1437,11 @@ amd64_install_fast_tracepoint_jump_pad (CORE_ADDR tpoint, CORE_ADDR tpaddr,
 
   /* Build the jump pad.  */
 
-  /* First, do tracepoint data collection.  Save registers.  */
+  /* First, do tracepoint data collection.  Save registers.  Leave
+     the code at TPADDR's red zone alone; it may be in a leaf
+     function that keeps its locals there.  */
   i = 0;
+  i += push_opcode (&buf[i], "48 8d 64 24 80");	/* lea -0x80(%rsp),%rsp */
   /* Need to ensure stack pointer saved first.  */
   buf[i++] = 0x54; /* push %rsp */
   buf[i++] = 0x55; /* push %rbp */
@@ -1444,6 +1460,13 @@ amd64_install_fast_tracepoint_jump_pad (CORE_ADDR tpoint, CORE_ADDR tpaddr,
   buf[i++] = 0x41; buf[i++] = 0x51; /* push %r9 */
   buf[i++] = 0x41; buf[i++] = 0x50; /* push %r8 */
   buf[i++] = 0x9c; /* pushfq */
+  append_insns (&buildaddr, i, buf);
+
+  /* Make the saved %rsp the one of the code at TPADDR.  This must
+     come after saving the flags.  */
+  i = 0;
+  i += push_opcode (&buf[i], "48 81 84 24 80 00 00 00");
+  i += push_opcode (&buf[i], "80 00 00 00");	/* addq $0x80,0x80(%rsp) */
   buf[i++] = 0x48; /* movl <addr>,%rdi */
   buf[i++] = 0xbf;
   *((unsigned long *)(buf + i)) = (unsigned long) tpaddr;
@@ -2144,7 +2167,7 @@ amd64_write_goto_address (CORE_ADDR from, CORE_ADDR to, int size)
     }
 
   memcpy (buf, &diff, sizeof (int));
-  write_inferior_memory (from, buf, sizeof (int));
+  append_insns (&from, sizeof (int), buf);
 }
 
 static void
@@ -2173,6 +2196,14 @@ amd64_emit_call (CORE_ADDR fn)
   /* The destination function being in the shared library, may be
      >31-bits away off the compiled code pad.  */
 
+  /* The bytecode stack leaves %rsp at an arbitrary alignment, but
+     the ABI wants it 16-byte aligned at the call.  Stash the current
+     %rsp in callee-saved %rbx, and align.  */
+  EMIT_ASM (amd64_call_align,
+	    "push %rbx\n\t"
+	    "mov %rsp,%rbx\n\t"
+	    "and $-16,%rsp");
+
   buildaddr = current_insn_ptr;
 
   offset64 = fn - (buildaddr + 1 /* call op */ + 4 /* 32-bit offset */);
@@ -2184,22 +2215,29 @@ amd64_emit_call (CORE_ADDR fn)
       /* Offset is too large for a call.  Use callq, but that requires
 	 a register, so avoid it if possible.  Use r10, since it is
 	 call-clobbered, we don't have to push/pop it.  */
-      buf[i++] = 0x48; /* mov $fn,%r10 */
+      buf[i++] = 0x49; /* mov $fn,%r10 */
       buf[i++] = 0xba;
       memcpy (buf + i, &fn, 8);
       i += 8;
-      buf[i++] = 0xff; /* callq *%r10 */
+      buf[i++] = 0x41; /* callq *%r10 */
+      buf[i++] = 0xff;
       buf[i++] = 0xd2;
     }
   else
     {
       int offset32 = offset64; /* we know we can't overflow here.  */
+
+      buf[i++] = 0xe8; /* call <reladdr> */
       memcpy (buf + i, &offset32, 4);
       i += 4;
     }
 
   append_insns (&buildaddr, i, buf);
   current_insn_ptr = buildaddr;
+
+  EMIT_ASM (amd64_call_unalign,
+	    "mov %rbx,%rsp\n\t"
+	    "pop %rbx");
 }
 
 static void
@@ -2209,9 +2247,14 @@ amd64_emit_reg (int reg)
   int i;
   CORE_ADDR buildaddr;
 
-  /* Assume raw_regs is still in %rdi.  */
+  /* %rdi may have been clobbered by an earlier call; reload raw_regs
+     from where the prologue saved it.  */
   buildaddr = current_insn_ptr;
   i = 0;
+  buf[i++] = 0x48; /* mov -8(%rbp),%rdi */
+  buf[i++] = 0x8b;
+  buf[i++] = 0x7d;
+  buf[i++] = 0xf8;
   buf[i++] = 0xbe; /* mov $<n>,%esi */
   memcpy (&buf[i], &reg, sizeof (reg));
   i += 4;
@@ -3175,6 +3218,19 @@ x86_emit_ops (void)
     return &i386_emit_ops;
 }
 
+/* Compiling bytecode for GDBserver itself is only supported on
+   x86-64 hosts.  */
+
+static struct emit_ops *
+x86_host_emit_ops (void)
+{
+#ifdef __x86_64__
+  return &amd64_emit_ops;
+#else
+  return NULL;
+#endif
+}
+
 /* This is initialized assuming an amd64 target.
    x86_arch_setup will correct it for i386 or amd64 targets.  */
 
@@ -3214,4 +3270,5 @@ struct linux_target_ops the_low_target =
   x86_install_fast_tracepoint_jump_pad,
   x86_emit_ops,
   x86_get_min_fast_tracepoint_insn_len,
+  x86_host_emit_ops,
 };
@@ -93,6 +93,9 @@ struct point_cond_list
      conditional.  */
   struct agent_expr *cond;
 
+  /* COND compiled to native code, or NULL if it could not be.  */
+  host_agent_expr_fn compiled;
+
   /* Pointer to the next condition.  */
   struct point_cond_list *next;
 };
@@ -772,6 +775,7 @@ clear_gdb_breakpoint_conditions (CORE_ADDR addr)
       struct point_cond_list *cond_next;
 
       cond_next = cond->next;
+      release_host_agent_expr (cond->compiled);
       free (cond->cond->bytes);
       free (cond->cond);
       free (cond);
@@ -792,6 +796,7 @@ add_condition_to_breakpoint (struct breakpoint *bp,
   /* Create new condition.  */
   new_cond = xcalloc (1, sizeof (*new_cond));
   new_cond->cond = condition;
+  new_cond->compiled = compile_host_agent_expr (condition);
 
   /* Add condition to the list.  */
   new_cond->next = bp->cond_list;
@@ -862,8 +867,11 @@ gdb_condition_true_at_breakpoint (CORE_ADDR where)
   for (cl = bp->cond_list;
        cl && !value && !err; cl = cl->next)
     {
-      /* Evaluate the condition.  */
-      err = gdb_eval_agent_expr (&ctx, cl->cond, &value);
+      /* Evaluate the condition, natively if it was compiled.  */
+      if (cl->compiled != NULL)
+	err = cl->compiled (ctx.regcache, &value);
+      else
+	err = gdb_eval_agent_expr (&ctx, cl->cond, &value);
     }
 
   if (err)
@@ -1442,4 +1450,123 @@ free_all_breakpoints (struct process_info *proc)
      current_process from here on.  */
   while (proc->breakpoints)
     delete_breakpoint_1 (proc, proc->breakpoints);
+
+  free_all_sw_watchpoints (proc);
+}
+
+/* A memory region GDB asked us to watch for a software watchpoint.
+   Instead of GDB single-stepping the inferior and reading the region
+   after each step, we do it ourselves, and only report a stop to GDB
+   when the contents change.  */
+
+struct sw_watchpoint
+{
+  /* Pointer to the next software watchpoint of the process.  */
+  struct sw_watchpoint *next;
+
+  /* The region watched.  */
+  CORE_ADDR addr;
+  int len;
+
+  /* Whether the region could be read the last time we looked, and its
+     contents then.  */
+  int readable;
+  unsigned char *contents;
+};
+
+int
+set_sw_watchpoint (CORE_ADDR addr, int len)
+{
+  struct process_info *proc = current_process ();
+  struct sw_watchpoint *wp;
+
+  if (len <= 0)
+    return -1;
+
+  wp = xcalloc (1, sizeof (*wp));
+  wp->addr = addr;
+  wp->len = len;
+  wp->contents = xmalloc (len);
+  wp->readable = (read_inferior_memory (addr, wp->contents, len) == 0);
+
+  /* GDB may watch the same region for several watchpoints; each
+     Z5 packet gets its own entry.  */
+  wp->next = proc->sw_watchpoints;
+  proc->sw_watchpoints = wp;
+  return 0;
+}
+
+int
+delete_sw_watchpoint (CORE_ADDR addr, int len)
+{
+  struct process_info *proc = current_process ();
+  struct sw_watchpoint *wp, **wp_link;
+
+  for (wp_link = &proc->sw_watchpoints; *wp_link != NULL;
+       wp_link = &(*wp_link)->next)
+    {
+      wp = *wp_link;
+      if (wp->addr == addr && wp->len == len)
+	{
+	  *wp_link = wp->next;
+	  xfree (wp->contents);
+	  xfree (wp);
+	  return 0;
+	}
+    }
+
+  return -1;
+}
+
+int
+sw_watchpoints_p (void)
+{
+  return current_process ()->sw_watchpoints != NULL;
+}
+
+int
+sw_watchpoint_triggered (void)
+{
+  struct process_info *proc = current_process ();
+  struct sw_watchpoint *wp;
+  unsigned char *buf = NULL;
+  int buf_len = 0;
+  int triggered = 0;
+
+  for (wp = proc->sw_watchpoints; wp != NULL; wp = wp->next)
+    {
+      int readable;
+
+      if (wp->len > buf_len)
+	{
+	  buf = xrealloc (buf, wp->len);
+	  buf_len = wp->len;
+	}
+
+      readable = (read_inferior_memory (wp->addr, buf, wp->len) == 0);
+      if (readable != wp->readable
+	  || (readable && memcmp (buf, wp->contents, wp->len) != 0))
+	{
+	  /* Report each change only once.  */
+	  wp->readable = readable;
+	  memcpy (wp->contents, buf, wp->len);
+	  triggered = 1;
+	}
+    }
+
+  xfree (buf);
+  return triggered;
+}
+
+void
+free_all_sw_watchpoints (struct process_info *proc)
+{
+  while (proc->sw_watchpoints != NULL)
+    {
+      struct sw_watchpoint *wp = proc->sw_watchpoints;
+
+      proc->sw_watchpoints = wp->next;
+      xfree (wp->contents);
+      xfree (wp);
+    }
 }
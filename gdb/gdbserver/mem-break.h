@@ -24,6 +24,7 @@
 /* Breakpoints are opaque.  */
 struct breakpoint;
 struct fast_tracepoint_jump;
+struct sw_watchpoint;
 
 /* Locate a breakpoint placed at address WHERE and return a pointer
    to its structure.  */
@@ -184,4 +185,31 @@ void uninsert_fast_tracepoint_jumps_at (CORE_ADDR pc);
 
 void reinsert_fast_tracepoint_jumps_at (CORE_ADDR where);
 
+/* Start watching the LEN bytes at ADDR for a GDB software watchpoint
+   (Z5 packet): threads of the current process are single-stepped,
+   and a stop is only reported when the region's contents change.
+   Returns 0 on success.  */
+
+int set_sw_watchpoint (CORE_ADDR addr, int len);
+
+/* Stop watching the LEN bytes at ADDR.  Returns 0 on success, -1 if
+   there was no such software watchpoint.  */
+
+int delete_sw_watchpoint (CORE_ADDR addr, int len);
+
+/* Returns true if the current process has software watchpoints, and
+   so its threads must be single-stepped.  */
+
+int sw_watchpoints_p (void);
+
+/* Re-read the regions watched by the software watchpoints of the
+   current process.  Return true if any changed since they were last
+   read.  */
+
+int sw_watchpoint_triggered (void);
+
+/* Release all the software watchpoints of PROC.  */
+
+void free_all_sw_watchpoints (struct process_info *proc);
+
 #endif /* MEM_BREAK_H */
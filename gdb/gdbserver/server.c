@@ -1188,41 +1188,112 @@ handle_qxfer_statictrace (const char *annex,
   return nbytes;
 }
 
-/* Helper for handle_qxfer_threads.  */
+/* Helper for handle_qxfer_threads_proper.  Describe THREAD in
+   BUFFER.  */
 
 static void
-handle_qxfer_threads_proper (struct buffer *buffer)
+handle_qxfer_threads_worker (struct inferior_list_entry *thread,
+			     struct buffer *buffer)
 {
-  struct inferior_list_entry *thread;
+  ptid_t ptid = thread_to_gdb_id ((struct thread_info *)thread);
+  char ptid_s[100];
+  int core = ((struct thread_info *) thread)->core;
+  char core_s[21];
 
-  buffer_grow_str (buffer, "<threads>\n");
+  write_ptid (ptid_s, ptid);
 
-  for (thread = all_threads.head; thread; thread = thread->next)
+  if (core != -1)
     {
-      ptid_t ptid = thread_to_gdb_id ((struct thread_info *)thread);
-      char ptid_s[100];
-      int core = target_core_of_thread (ptid);
-      char core_s[21];
+      sprintf (core_s, "%d", core);
+      buffer_xml_printf (buffer, "<thread id=\"%s\" core=\"%s\"/>\n",
+			 ptid_s, core_s);
+    }
+  else
+    {
+      buffer_xml_printf (buffer, "<thread id=\"%s\"/>\n",
+			 ptid_s);
+    }
+}
 
-      write_ptid (ptid_s, ptid);
+/* Helper for handle_qxfer_threads_proper.  Describe the exited thread
+   PTID in the struct buffer pointed to by DATA.  */
 
-      if (core != -1)
-	{
-	  sprintf (core_s, "%d", core);
-	  buffer_xml_printf (buffer, "<thread id=\"%s\" core=\"%s\"/>\n",
-			     ptid_s, core_s);
-	}
-      else
+static void
+handle_qxfer_threads_exited (ptid_t ptid, void *data)
+{
+  struct buffer *buffer = data;
+  char ptid_s[100];
+
+  write_ptid (ptid_s, ptid);
+  buffer_xml_printf (buffer, "<exited id=\"%s\"/>\n", ptid_s);
+}
+
+/* Helper for handle_qxfer_threads_proper.  Record the core each
+   thread is running on, moving threads whose core changed to the
+   current thread list generation so that delta replies include
+   them.  */
+
+static void
+update_thread_cores (void)
+{
+  struct inferior_list_entry *entry;
+
+  for (entry = all_threads.head; entry; entry = entry->next)
+    {
+      struct thread_info *thread = (struct thread_info *) entry;
+      int core = target_core_of_thread (thread_to_gdb_id (thread));
+
+      if (core != thread->core)
 	{
-	  buffer_xml_printf (buffer, "<thread id=\"%s\"/>\n",
-			     ptid_s);
+	  thread->core = core;
+	  thread->generation = ++thread_list_generation;
 	}
     }
+}
+
+/* Helper for handle_qxfer_threads.  If DELTA is non-zero, only
+   describe the threads added or removed after thread list generation
+   SINCE, if that is possible; otherwise describe all threads.  */
+
+static void
+handle_qxfer_threads_proper (struct buffer *buffer, int delta,
+			     unsigned int since)
+{
+  struct inferior_list_entry *thread;
+
+  update_thread_cores ();
+
+  if (!delta)
+    buffer_grow_str (buffer, "<threads>\n");
+  else if (thread_list_delta_available (since))
+    buffer_xml_printf (buffer,
+		       "<threads generation=\"%u\" delta=\"yes\">\n",
+		       thread_list_generation);
+  else
+    {
+      buffer_xml_printf (buffer, "<threads generation=\"%u\">\n",
+			 thread_list_generation);
+      delta = 0;
+    }
+
+  for (thread = all_threads.head; thread; thread = thread->next)
+    {
+      if (delta && ((struct thread_info *) thread)->generation <= since)
+	continue;
+
+      handle_qxfer_threads_worker (thread, buffer);
+    }
+
+  if (delta)
+    for_each_exited_thread (since, handle_qxfer_threads_exited, buffer);
 
   buffer_grow_str0 (buffer, "</threads>\n");
 }
 
-/* Handle qXfer:threads:read.  */
+/* Handle qXfer:threads:read.  An empty ANNEX requests the whole thread
+   list.  Otherwise ANNEX is the hex thread list generation GDB last
+   synchronized with, and only the changes since then are sent, along
+   with the current generation.  */
 
 static int
 handle_qxfer_threads (const char *annex,
@@ -1235,12 +1306,24 @@ handle_qxfer_threads (const char *annex,
   if (writebuf != NULL)
     return -2;
 
-  if (!target_running () || annex[0] != '\0')
+  if (!target_running ())
     return -1;
 
   if (offset == 0)
     {
       struct buffer buffer;
+      int delta = 0;
+      ULONGEST since = 0;
+
+      if (annex[0] != '\0')
+	{
+	  const char *end = unpack_varlen_hex ((char *) annex, &since);
+
+	  if (*end != '\0')
+	    return -1;
+	  delta = 1;
+	}
+
       /* When asked for data at offset 0, generate everything and store into
 	 'result'.  Successive reads will be served off 'result'.  */
       if (result)
@@ -1248,7 +1331,7 @@ handle_qxfer_threads (const char *annex,
 
       buffer_init (&buffer);
 
-      handle_qxfer_threads_proper (&buffer);
+      handle_qxfer_threads_proper (&buffer, delta, since);
 
       result = buffer_finish (&buffer);
       result_length = strlen (result);
@@ -1785,6 +1868,7 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
 	strcat (own_buf, ";QDisableRandomization+");
 
       strcat (own_buf, ";qXfer:threads:read+");
+      strcat (own_buf, ";ThreadListDelta+");
 
       if (target_supports_tracepoints ())
 	{
@@ -1793,13 +1877,17 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
 	  strcat (own_buf, ";TracepointSource+");
 	  strcat (own_buf, ";DisconnectedTracing+");
 	  if (gdb_supports_qRelocInsn && target_supports_fast_tracepoints ())
-	    strcat (own_buf, ";FastTracepoints+");
+	    {
+	      strcat (own_buf, ";FastTracepoints+");
+	      strcat (own_buf, ";FastConditionalBreakpoints+");
+	    }
 	  strcat (own_buf, ";StaticTracepoints+");
 	  strcat (own_buf, ";InstallInTrace+");
 	  strcat (own_buf, ";qXfer:statictrace:read+");
 	  strcat (own_buf, ";qXfer:traceframe-info:read+");
 	  strcat (own_buf, ";EnableDisableTracepoints+");
 	  strcat (own_buf, ";QTBuffer:size+");
+	  strcat (own_buf, ";qTDrain+");
 	  strcat (own_buf, ";tracenz+");
 	}
 
@@ -2004,7 +2092,8 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
   if (handle_qxfer (own_buf, packet_len, new_packet_len_p))
     return;
 
-  if (target_supports_tracepoints () && handle_tracepoint_query (own_buf))
+  if (target_supports_tracepoints ()
+      && handle_tracepoint_query (own_buf, new_packet_len_p))
     return;
 
   /* Otherwise we didn't know what packet it was.  Say we didn't
@@ -3043,6 +3132,14 @@ process_point_options (CORE_ADDR point_addr, char **packet)
 	  dataptr += 2;
 	  add_breakpoint_commands (point_addr, &dataptr, persist);
 	}
+      else if (*dataptr == 'F')
+	{
+	  /* Length of the instruction a fast breakpoint would replace.
+	     Only meaningful when the breakpoint is handled by the
+	     in-process agent.  */
+	  while (*dataptr && *dataptr != ';')
+	    dataptr++;
+	}
       else
 	{
 	  fprintf (stderr, "Unknown token %c, ignoring.\n",
@@ -3383,9 +3480,24 @@ process_serial_event (void)
 	  case '2': /* write watchpoint */
 	  case '3': /* read watchpoint */
 	  case '4': /* access watchpoint */
+	  case '5': /* software watchpoint */
 	    require_running (own_buf);
-	    if (insert && the_target->insert_point != NULL)
+	    if (insert && type == '0'
+		&& set_fast_gdb_breakpoint_at (addr, dataptr) == 0)
 	      {
+		/* The breakpoint's condition will be evaluated by the
+		   in-process agent.  Take out any trap GDB had inserted
+		   here before.  */
+		if (the_target->remove_point != NULL
+		    && gdb_breakpoint_here (addr))
+		  (*the_target->remove_point) (type, addr, len);
+		res = 0;
+	      }
+	    else if (insert && the_target->insert_point != NULL)
+	      {
+		if (type == '0')
+		  delete_fast_gdb_breakpoint_at (addr);
+
 		/* Insert the breakpoint.  If it is already inserted, nothing
 		   will take place.  */
 		res = (*the_target->insert_point) (type, addr, len);
@@ -3401,6 +3513,9 @@ process_serial_event (void)
 		    process_point_options (addr, &dataptr);
 		  }
 	      }
+	    else if (!insert && type == '0'
+		     && delete_fast_gdb_breakpoint_at (addr) == 0)
+	      res = 0;
 	    else if (!insert && the_target->remove_point != NULL)
 	      res = (*the_target->remove_point) (type, addr, len);
 	    break;
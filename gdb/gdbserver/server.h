@@ -97,16 +97,33 @@ typedef long long LONGEST;
 typedef unsigned long long ULONGEST;
 
 /* Generic information for tracking a list of ``inferiors'' - threads,
-   processes, etc.  */
+   processes, etc.  Besides the list itself, entries are indexed by id
+   in a hash table, so that looking up or removing an entry doesn't
+   need to walk the list.  */
 struct inferior_list
 {
   struct inferior_list_entry *head;
   struct inferior_list_entry *tail;
+
+  /* The hash table buckets, NUM_BUCKETS of them, or NULL if nothing
+     was ever added to the list.  */
+  struct inferior_list_entry **buckets;
+  unsigned int num_buckets;
+
+  /* Number of entries in the list.  */
+  unsigned int count;
 };
 struct inferior_list_entry
 {
   ptid_t id;
   struct inferior_list_entry *next;
+
+  /* The previous entry in the list.  */
+  struct inferior_list_entry *prev;
+
+  /* The neighbouring entries in the same hash bucket.  */
+  struct inferior_list_entry *hash_next;
+  struct inferior_list_entry *hash_prev;
 };
 
 struct thread_info;
@@ -157,6 +174,10 @@ struct process_info
   /* The list of installed fast tracepoints.  */
   struct fast_tracepoint_jump *fast_tracepoint_jumps;
 
+  /* The list of memory regions GDB asked us to watch for software
+     watchpoints.  */
+  struct sw_watchpoint *sw_watchpoints;
+
   /* Private target data.  */
   struct process_info_private *private;
 };
@@ -187,6 +208,7 @@ void for_each_inferior (struct inferior_list *list,
 extern struct thread_info *current_inferior;
 void remove_inferior (struct inferior_list *list,
 		      struct inferior_list_entry *entry);
+void clear_inferior_list (struct inferior_list *list);
 
 struct process_info *add_process (int pid, int attached);
 void remove_process (struct process_info *process);
@@ -376,7 +398,7 @@ void tracepoint_look_up_symbols (void);
 void stop_tracing (void);
 
 int handle_tracepoint_general_set (char *own_buf);
-int handle_tracepoint_query (char *own_buf);
+int handle_tracepoint_query (char *own_buf, int *new_packet_len_p);
 
 int tracepoint_finished_step (struct thread_info *tinfo, CORE_ADDR stop_pc);
 int tracepoint_was_hit (struct thread_info *tinfo, CORE_ADDR stop_pc);
@@ -422,6 +444,10 @@ void force_unlock_trace_buffer (void);
 
 int handle_tracepoint_bkpts (struct thread_info *tinfo, CORE_ADDR stop_pc);
 
+int set_fast_gdb_breakpoint_at (CORE_ADDR where, char *options);
+int delete_fast_gdb_breakpoint_at (CORE_ADDR where);
+int fast_gdb_breakpoint_hit (CORE_ADDR stop_pc);
+
 #ifdef IN_PROCESS_AGENT
 void initialize_low_tracepoint (void);
 void supply_fast_tracepoint_registers (struct regcache *regcache,
@@ -524,6 +550,8 @@ CORE_ADDR get_set_tsv_func_addr (void);
 
 extern CORE_ADDR current_insn_ptr;
 extern int emit_error;
+extern int emit_host_code;
+extern CORE_ADDR host_code_end;
 
 /* Version information, from version.c.  */
 extern const char version[];
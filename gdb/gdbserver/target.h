@@ -414,6 +414,10 @@ struct target_ops
      to break a cyclic dependency.  */
   void (*read_btrace) (struct btrace_target_info *, struct buffer *, int type);
 
+  /* Return the bytecode operations vector for code that GDBserver
+     itself runs, rather than the inferior.  Returns NULL if compiling
+     bytecode for the host is not supported.  */
+  struct emit_ops *(*host_emit_ops) (void);
 };
 
 extern struct target_ops *the_target;
@@ -529,6 +533,9 @@ int kill_inferior (int);
 #define target_emit_ops() \
   (the_target->emit_ops ? (*the_target->emit_ops) () : NULL)
 
+#define target_host_emit_ops() \
+  (the_target->host_emit_ops ? (*the_target->host_emit_ops) () : NULL)
+
 #define target_supports_disable_randomization() \
   (the_target->supports_disable_randomization ? \
    (*the_target->supports_disable_randomization) () : 0)
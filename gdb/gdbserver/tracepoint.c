@@ -121,8 +121,10 @@ trace_vdebug (const char *fmt, ...)
 # define gdb_trampoline_buffer_error gdb_agent_gdb_trampoline_buffer_error
 # define collecting gdb_agent_collecting
 # define gdb_collect gdb_agent_gdb_collect
+# define gdb_fast_break gdb_agent_gdb_fast_break
 # define stop_tracing gdb_agent_stop_tracing
 # define flush_trace_buffer gdb_agent_flush_trace_buffer
+# define fast_break_hit gdb_agent_fast_break_hit
 # define about_to_request_buffer_space gdb_agent_about_to_request_buffer_space
 # define trace_buffer_is_full gdb_agent_trace_buffer_is_full
 # define stopping_tracepoint gdb_agent_stopping_tracepoint
@@ -162,8 +164,10 @@ struct ipa_sym_addresses
   CORE_ADDR addr_gdb_trampoline_buffer_error;
   CORE_ADDR addr_collecting;
   CORE_ADDR addr_gdb_collect;
+  CORE_ADDR addr_gdb_fast_break;
   CORE_ADDR addr_stop_tracing;
   CORE_ADDR addr_flush_trace_buffer;
+  CORE_ADDR addr_fast_break_hit;
   CORE_ADDR addr_about_to_request_buffer_space;
   CORE_ADDR addr_trace_buffer_is_full;
   CORE_ADDR addr_stopping_tracepoint;
@@ -199,8 +203,10 @@ static struct
   IPA_SYM(gdb_trampoline_buffer_error),
   IPA_SYM(collecting),
   IPA_SYM(gdb_collect),
+  IPA_SYM(gdb_fast_break),
   IPA_SYM(stop_tracing),
   IPA_SYM(flush_trace_buffer),
+  IPA_SYM(fast_break_hit),
   IPA_SYM(about_to_request_buffer_space),
   IPA_SYM(trace_buffer_is_full),
   IPA_SYM(stopping_tracepoint),
@@ -357,7 +363,11 @@ tracepoint_look_up_symbols (void)
    "flush_trace_buffer", which triggers an internal breakpoint.
    GDBserver reacts to this breakpoint by pulling the meanwhile
    collected data.  Old frames discarding is always handled on the
-   GDBserver side.  */
+   GDBserver side.
+
+   Likewise, the IPA calls "fast_break_hit" when the condition of a
+   fast conditional breakpoint is true.  GDBserver reacts to the
+   breakpoint there by reporting the breakpoint hit to GDB.  */
 
 #ifdef IN_PROCESS_AGENT
 int
@@ -392,6 +402,13 @@ flush_trace_buffer (void)
   UNKNOWN_SIDE_EFFECTS();
 }
 
+IP_AGENT_EXPORT void ATTR_USED ATTR_NOINLINE
+fast_break_hit (void)
+{
+  /* GDBserver places breakpoint here.  */
+  UNKNOWN_SIDE_EFFECTS();
+}
+
 #endif
 
 #ifndef IN_PROCESS_AGENT
@@ -708,8 +725,9 @@ enum tracepoint_type
 
 struct tracepoint_hit_ctx;
 
-typedef enum eval_result_type (*condfn) (struct tracepoint_hit_ctx *,
-					 ULONGEST *);
+/* A compiled condition.  The emitted code expects the raw register
+   block saved by the jump pad as first argument.  */
+typedef enum eval_result_type (*condfn) (unsigned char *, ULONGEST *);
 
 /* The definition of a tracepoint.  */
 
@@ -1430,6 +1448,28 @@ record_tracepoint_error (struct tracepoint *tpoint, const char *which,
 
 /* Trace buffer management.  */
 
+#ifndef IN_PROCESS_AGENT
+
+/* GDB may stream the trace buffer while tracing goes on (qTDrain),
+   downloading the traceframes at its start, which we then discard to
+   make room for new ones.  A traceframe too large for one packet is
+   sent over several.  This is how much of the first traceframe in
+   the buffer GDB already has.  */
+
+static ULONGEST drain_partial;
+
+/* If the circular trace buffer discarded the traceframe GDB had only
+   partially drained, a copy of that traceframe, and how much of it
+   GDB has.  It is sent before the traceframes in the buffer.  */
+
+static unsigned char *drain_rest;
+static ULONGEST drain_rest_size;
+static ULONGEST drain_rest_sent;
+
+static void save_partially_drained_traceframe (void);
+
+#endif
+
 static void
 clear_trace_buffer (void)
 {
@@ -1442,6 +1482,13 @@ clear_trace_buffer (void)
   ((struct traceframe *) trace_buffer_free)->data_size = 0;
   traceframe_read_count = traceframe_write_count = 0;
   traceframes_created = 0;
+
+#ifndef IN_PROCESS_AGENT
+  drain_partial = 0;
+  xfree (drain_rest);
+  drain_rest = NULL;
+  drain_rest_size = drain_rest_sent = 0;
+#endif
 }
 
 #ifndef IN_PROCESS_AGENT
@@ -1640,6 +1687,11 @@ trace_buffer_alloc (size_t amt)
 	  return NULL;
 	}
 
+      /* If GDB was draining this traceframe, keep the rest of it for
+	 GDB.  */
+      if (drain_partial != 0)
+	save_partially_drained_traceframe ();
+
       /* We don't run this code in the in-process agent currently.
 	 E.g., we could leave the in-process agent in autonomous
 	 circular mode if we only have fast tracepoints.  If we do
@@ -3175,6 +3227,260 @@ install_tracepoint (struct tracepoint *tpoint, char *own_buf)
 
 static void download_tracepoint_1 (struct tracepoint *tpoint);
 
+/* Fast conditional breakpoints.
+
+   A GDB breakpoint whose condition is evaluated on the target side
+   can be implemented with a fast tracepoint jump instead of a trap,
+   if GDB tells us how long the instruction at the breakpoint address
+   is.  The jump pad calls the in-process agent's gdb_fast_break with
+   a tracepoint object holding the (possibly compiled) condition, and
+   the thread only traps, at fast_break_hit, if the condition is
+   true.  We then let the thread run to the relocated original
+   instruction in the jump pad, where its registers are as they were
+   at the breakpoint address, and report the breakpoint hit from
+   there.  See linux_wait_1.
+
+   Jump pad space is never reclaimed, while GDB removes and reinserts
+   breakpoints whenever the inferior stops.  So removed breakpoints
+   are kept in this list, and their jump pad is reused if GDB inserts
+   a breakpoint with the same condition at the same address again.  */
+
+struct fast_gdb_breakpoint
+{
+  struct fast_gdb_breakpoint *next;
+
+  /* The object describing the breakpoint to the in-process agent.
+     Only the address, condition and fast tracepoint fields are used.
+     The handle is NULL while the breakpoint is not inserted.  */
+  struct tracepoint tpoint;
+
+  /* The jump to the jump pad, to wire the breakpoint back in.  */
+  unsigned char fjump[MAX_JUMP_SIZE];
+  ULONGEST fjump_size;
+};
+
+static struct fast_gdb_breakpoint *fast_gdb_breakpoints;
+
+/* The process FAST_GDB_BREAKPOINTS were set in.  */
+static int fast_gdb_breakpoints_pid;
+
+/* Breakpoint at "fast_break_hit" in the inferior lib.  */
+static struct breakpoint *fast_break_hit_bkpt;
+
+static int
+fast_break_hit_handler (CORE_ADDR addr)
+{
+  trace_debug ("lib hit fast_break_hit");
+  return 0;
+}
+
+/* Forget about the fast breakpoints of a previous process.  */
+
+static void
+validate_fast_gdb_breakpoints (void)
+{
+  int pid = ptid_get_pid (current_ptid);
+  struct fast_gdb_breakpoint *fb, *next;
+
+  if (pid == fast_gdb_breakpoints_pid)
+    return;
+
+  for (fb = fast_gdb_breakpoints; fb != NULL; fb = next)
+    {
+      next = fb->next;
+      free (fb->tpoint.cond->bytes);
+      free (fb->tpoint.cond);
+      free (fb);
+    }
+
+  fast_gdb_breakpoints = NULL;
+  fast_break_hit_bkpt = NULL;
+  fast_gdb_breakpoints_pid = pid;
+}
+
+/* Build the jump pad of fast breakpoint FB, whose tracepoint object
+   has already been downloaded.  Return 0 if successful, otherwise
+   return non-zero.  */
+
+static int
+install_fast_gdb_breakpoint_jump_pad (struct fast_gdb_breakpoint *fb,
+				      char *errbuf)
+{
+  struct tracepoint *tpoint = &fb->tpoint;
+  CORE_ADDR jentry, jump_entry;
+  CORE_ADDR trampoline = 0;
+  ULONGEST trampoline_size = 0;
+
+  jentry = jump_entry = get_jump_space_head ();
+
+  if (install_fast_tracepoint_jump_pad (tpoint->obj_addr_on_target,
+					tpoint->address,
+					ipa_sym_addrs.addr_gdb_fast_break,
+					ipa_sym_addrs.addr_collecting,
+					tpoint->orig_size,
+					&jentry,
+					&trampoline, &trampoline_size,
+					fb->fjump, &fb->fjump_size,
+					&tpoint->adjusted_insn_addr,
+					&tpoint->adjusted_insn_addr_end,
+					errbuf))
+    return 1;
+
+  tpoint->jump_pad = jump_entry;
+  tpoint->jump_pad_end = jentry;
+  tpoint->trampoline = trampoline;
+  tpoint->trampoline_end = trampoline + trampoline_size;
+
+  /* Pad to 8-byte alignment.  */
+  jentry = ((jentry + 7) & ~0x7);
+  claim_jump_space (jentry - jump_entry);
+
+  return 0;
+}
+
+/* Remove the jumps of the fast breakpoints at WHERE.  Return 0 if
+   there were any, -1 otherwise.  */
+
+int
+delete_fast_gdb_breakpoint_at (CORE_ADDR where)
+{
+  struct fast_gdb_breakpoint *fb;
+  int ret = -1;
+
+  validate_fast_gdb_breakpoints ();
+
+  for (fb = fast_gdb_breakpoints; fb != NULL; fb = fb->next)
+    if (fb->tpoint.address == where && fb->tpoint.handle != NULL)
+      {
+	pause_all (1);
+	delete_fast_tracepoint_jump (fb->tpoint.handle);
+	unpause_all (1);
+	fb->tpoint.handle = NULL;
+	ret = 0;
+      }
+
+  return ret;
+}
+
+/* Try to insert a fast conditional breakpoint at WHERE, as described
+   by OPTIONS, the options part of a Z0 packet.  This is only possible
+   if the in-process agent is loaded, and OPTIONS has the length of the
+   instruction at WHERE, a single condition and no commands.  Return 0
+   if successful, otherwise return non-zero; the caller should then
+   insert a trap breakpoint as usual.  */
+
+int
+set_fast_gdb_breakpoint_at (CORE_ADDR where, char *options)
+{
+  struct fast_gdb_breakpoint *fb;
+  struct agent_expr *cond = NULL;
+  ULONGEST orig_size = 0;
+  char *p = options;
+
+  if (!agent_loaded_p () || !target_supports_fast_tracepoints ()
+      || *p != ';')
+    return 1;
+
+  while (*p != '\0')
+    {
+      if (*p == ';')
+	++p;
+      else if (*p == 'F')
+	p = unpack_varlen_hex (p + 1, &orig_size);
+      else if (*p == 'X' && cond == NULL)
+	cond = gdb_parse_agent_expr (&p);
+      else
+	break;
+    }
+
+  /* GDB replaces the conditions of a breakpoint by inserting it
+     again.  Take out any jump with the old condition first.  */
+  delete_fast_gdb_breakpoint_at (where);
+
+  /* Leave the address alone if a fast tracepoint uses it.  */
+  if (*p != '\0' || cond == NULL || orig_size == 0
+      || orig_size < target_get_min_fast_tracepoint_insn_len ()
+      || fast_tracepoint_jump_here (where))
+    {
+      if (cond != NULL)
+	{
+	  free (cond->bytes);
+	  free (cond);
+	}
+      return 1;
+    }
+
+  for (fb = fast_gdb_breakpoints; fb != NULL; fb = fb->next)
+    if (fb->tpoint.address == where
+	&& fb->tpoint.orig_size == orig_size
+	&& fb->tpoint.cond->length == cond->length
+	&& memcmp (fb->tpoint.cond->bytes, cond->bytes, cond->length) == 0)
+      break;
+
+  if (fb != NULL)
+    {
+      free (cond->bytes);
+      free (cond);
+    }
+  else
+    {
+      char *errbuf = alloca (PBUFSIZ);
+
+      fb = xcalloc (1, sizeof (*fb));
+      fb->tpoint.type = fast_tracepoint;
+      fb->tpoint.enabled = 1;
+      fb->tpoint.address = where;
+      fb->tpoint.orig_size = orig_size;
+      fb->tpoint.cond = cond;
+
+      errbuf[0] = '\0';
+      download_tracepoint_1 (&fb->tpoint);
+      if (install_fast_gdb_breakpoint_jump_pad (fb, errbuf) != 0)
+	{
+	  trace_debug ("Failed to install fast breakpoint at 0x%s: %s",
+		       paddress (where), errbuf);
+	  free (cond->bytes);
+	  free (cond);
+	  free (fb);
+	  return 1;
+	}
+
+      fb->next = fast_gdb_breakpoints;
+      fast_gdb_breakpoints = fb;
+    }
+
+  if (fast_break_hit_bkpt == NULL)
+    {
+      fast_break_hit_bkpt
+	= set_breakpoint_at (ipa_sym_addrs.addr_fast_break_hit,
+			     fast_break_hit_handler);
+      if (fast_break_hit_bkpt == NULL)
+	return 1;
+    }
+
+  pause_all (1);
+  fb->tpoint.handle = set_fast_tracepoint_jump (where, fb->fjump,
+						fb->fjump_size);
+  unpause_all (1);
+  if (fb->tpoint.handle == NULL)
+    return 1;
+
+  trace_debug ("Fast breakpoint at 0x%s inserted, jump pad at 0x%s",
+	       paddress (where), paddress (fb->tpoint.jump_pad));
+  return 0;
+}
+
+/* Return true if STOP_PC is where the in-process agent traps when the
+   condition of a fast conditional breakpoint is true.  */
+
+int
+fast_gdb_breakpoint_hit (CORE_ADDR stop_pc)
+{
+  return (fast_break_hit_bkpt != NULL
+	  && agent_loaded_p ()
+	  && stop_pc == ipa_sym_addrs.addr_fast_break_hit);
+}
+
 static void
 cmd_qtstart (char *packet)
 {
@@ -3961,6 +4267,202 @@ cmd_qtminftpilen (char *packet)
   sprintf (packet, "%x", target_get_min_fast_tracepoint_insn_len ());
 }
 
+/* Copy LEN bytes of traceframe TF, starting OFFSET bytes from its
+   start, to BUF, accounting for wraparound.  */
+
+static void
+read_traceframe_bytes (struct traceframe *tf, ULONGEST offset,
+		       unsigned char *buf, ULONGEST len)
+{
+  unsigned char *p = (unsigned char *) tf + offset;
+
+  if (p >= trace_buffer_wrap)
+    p -= (trace_buffer_wrap - trace_buffer_lo);
+
+  while (len > 0)
+    {
+      ULONGEST n = len;
+
+      if (p < trace_buffer_wrap && n > trace_buffer_wrap - p)
+	n = trace_buffer_wrap - p;
+
+      memcpy (buf, p, n);
+      buf += n;
+      len -= n;
+      p = trace_buffer_lo;
+    }
+}
+
+/* Copy the part of the first traceframe in the buffer that GDB has
+   not drained yet, before the circular buffer discards it.  */
+
+static void
+save_partially_drained_traceframe (void)
+{
+  struct traceframe *tf = FIRST_TRACEFRAME ();
+  ULONGEST size = sizeof (struct traceframe) + tf->data_size;
+  unsigned char *copy;
+
+  /* Anything left from an earlier traceframe goes first.  */
+  copy = xmalloc (drain_rest_size - drain_rest_sent + size - drain_partial);
+  if (drain_rest != NULL)
+    memcpy (copy, drain_rest + drain_rest_sent,
+	    drain_rest_size - drain_rest_sent);
+  read_traceframe_bytes (tf, drain_partial,
+			 copy + drain_rest_size - drain_rest_sent,
+			 size - drain_partial);
+
+  xfree (drain_rest);
+  drain_rest = copy;
+  drain_rest_size = drain_rest_size - drain_rest_sent + size - drain_partial;
+  drain_rest_sent = 0;
+  drain_partial = 0;
+}
+
+/* Discard the first traceframe in the buffer, which GDB has
+   drained.  */
+
+static void
+discard_drained_traceframe (void)
+{
+  struct traceframe *first = FIRST_TRACEFRAME ();
+  unsigned char *new_start = (unsigned char *) NEXT_TRACEFRAME (first);
+
+  --traceframe_write_count;
+
+  /* If we freed the traceframe that wrapped around, go back to the
+     non-wrap case.  */
+  if (new_start < trace_buffer_start)
+    trace_buffer_wrap = trace_buffer_hi;
+  trace_buffer_start = new_start;
+
+  if (trace_buffer_start == trace_buffer_free)
+    {
+      /* The buffer is empty, start over from its beginning.  */
+      trace_buffer_start = trace_buffer_lo;
+      trace_buffer_free = trace_buffer_lo;
+      trace_buffer_end_free = trace_buffer_hi;
+      trace_buffer_wrap = trace_buffer_hi;
+      ((struct traceframe *) trace_buffer_free)->tpnum = 0;
+      ((struct traceframe *) trace_buffer_free)->data_size = 0;
+    }
+  else
+    {
+      /* The space before the new first traceframe is free now, as
+	 when the circular buffer discards the oldest traceframe.  */
+      trace_buffer_end_free = trace_buffer_start;
+    }
+}
+
+/* Respond to a qTDrain packet with as much of the trace data at the
+   start of the buffer as fits in the reply, in binary, at most the
+   number of bytes GDB asked for, and discard the traceframes GDB now
+   has completely.  Reply "l" if there is nothing to send.  */
+
+static void
+cmd_qtdrain (char *own_buf, int *new_packet_len_p)
+{
+  ULONGEST num, raw = 0;
+  unsigned char *tmp, *out;
+  int out_room, out_len = 0;
+  char *packet = own_buf;
+
+  packet += strlen ("qTDrain:");
+  unpack_varlen_hex (packet, &num);
+
+  /* Traceframes are numbered from the start of the buffer, so don't
+     renumber them under GDB's feet.  */
+  if (current_traceframe >= 0)
+    {
+      trace_debug ("Can't drain the trace buffer while looking at a "
+		   "traceframe");
+      write_enn (own_buf);
+      return;
+    }
+
+  if (agent_loaded_p ())
+    {
+      pause_all (1);
+
+      upload_fast_traceframes ();
+
+      unpause_all (1);
+    }
+
+  tmp = alloca (PBUFSIZ);
+  out = (unsigned char *) own_buf + 1;
+  out_room = PBUFSIZ - 2;
+
+  while (raw < num && out_room > 0)
+    {
+      struct traceframe *tf = NULL;
+      ULONGEST avail, n;
+      int consumed, written;
+
+      if (drain_rest != NULL)
+	avail = drain_rest_size - drain_rest_sent;
+      else
+	{
+	  tf = FIRST_TRACEFRAME ();
+	  if (tf->tpnum == 0)
+	    break;
+	  avail = sizeof (struct traceframe) + tf->data_size - drain_partial;
+	}
+
+      n = avail;
+      if (n > num - raw)
+	n = num - raw;
+      if (n > out_room)
+	n = out_room;
+
+      if (drain_rest != NULL)
+	memcpy (tmp, drain_rest + drain_rest_sent, n);
+      else
+	read_traceframe_bytes (tf, drain_partial, tmp, n);
+
+      written = remote_escape_output (tmp, n, out, &consumed, out_room);
+      out += written;
+      out_room -= written;
+      out_len += written;
+      raw += consumed;
+
+      if (drain_rest != NULL)
+	{
+	  drain_rest_sent += consumed;
+	  if (drain_rest_sent == drain_rest_size)
+	    {
+	      xfree (drain_rest);
+	      drain_rest = NULL;
+	      drain_rest_size = drain_rest_sent = 0;
+	    }
+	}
+      else
+	{
+	  drain_partial += consumed;
+	  if (drain_partial == sizeof (struct traceframe) + tf->data_size)
+	    {
+	      discard_drained_traceframe ();
+	      drain_partial = 0;
+	    }
+	}
+
+      /* Stop if the reply is full.  */
+      if (consumed < n)
+	break;
+    }
+
+  trace_debug ("Drained %s bytes of trace data", pulongest (raw));
+
+  if (raw == 0)
+    {
+      strcpy (own_buf, "l");
+      return;
+    }
+
+  own_buf[0] = 'm';
+  *new_packet_len_p = out_len + 1;
+}
+
 /* Respond to qTBuffer packet with a block of raw data from the trace
    buffer.  GDB may ask for a lot, but we are allowed to reply with
    only as much as will fit within packet limits or whatever.  */
@@ -4199,7 +4701,7 @@ handle_tracepoint_general_set (char *packet)
 }
 
 int
-handle_tracepoint_query (char *packet)
+handle_tracepoint_query (char *packet, int *new_packet_len_p)
 {
   if (strcmp ("qTStatus", packet) == 0)
     {
@@ -4241,6 +4743,11 @@ handle_tracepoint_query (char *packet)
       cmd_qtbuffer (packet);
       return 1;
     }
+  else if (strncmp ("qTDrain:", packet, strlen ("qTDrain:")) == 0)
+    {
+      cmd_qtdrain (packet, new_packet_len_p);
+      return 1;
+    }
   else if (strcmp ("qTfSTM", packet) == 0)
     {
       cmd_qtfstm (packet);
@@ -4864,7 +5371,12 @@ condition_true_at_tracepoint (struct tracepoint_hit_ctx *ctx,
      used.  */
 #ifdef IN_PROCESS_AGENT
   if (tpoint->compiled_cond)
-    err = ((condfn) (uintptr_t) (tpoint->compiled_cond)) (ctx, &value);
+    {
+      struct fast_tracepoint_ctx *fctx = (struct fast_tracepoint_ctx *) ctx;
+
+      err = ((condfn) (uintptr_t) (tpoint->compiled_cond)) (fctx->regs,
+							    &value);
+    }
   else
 #endif
     {
@@ -5431,12 +5943,17 @@ static struct tracepoint *
 fast_tracepoint_from_jump_pad_address (CORE_ADDR pc)
 {
   struct tracepoint *tpoint;
+  struct fast_gdb_breakpoint *fb;
 
   for (tpoint = tracepoints; tpoint; tpoint = tpoint->next)
     if (tpoint->type == fast_tracepoint)
       if (tpoint->jump_pad <= pc && pc < tpoint->jump_pad_end)
 	return tpoint;
 
+  for (fb = fast_gdb_breakpoints; fb != NULL; fb = fb->next)
+    if (fb->tpoint.jump_pad <= pc && pc < fb->tpoint.jump_pad_end)
+      return &fb->tpoint;
+
   return NULL;
 }
 
@@ -5446,6 +5963,7 @@ static struct tracepoint *
 fast_tracepoint_from_trampoline_address (CORE_ADDR pc)
 {
   struct tracepoint *tpoint;
+  struct fast_gdb_breakpoint *fb;
 
   for (tpoint = tracepoints; tpoint; tpoint = tpoint->next)
     {
@@ -5454,6 +5972,10 @@ fast_tracepoint_from_trampoline_address (CORE_ADDR pc)
 	return tpoint;
     }
 
+  for (fb = fast_gdb_breakpoints; fb != NULL; fb = fb->next)
+    if (fb->tpoint.trampoline <= pc && pc < fb->tpoint.trampoline_end)
+      return &fb->tpoint;
+
   return NULL;
 }
 
@@ -5465,12 +5987,17 @@ static struct tracepoint *
 fast_tracepoint_from_ipa_tpoint_address (CORE_ADDR ipa_tpoint_obj)
 {
   struct tracepoint *tpoint;
+  struct fast_gdb_breakpoint *fb;
 
   for (tpoint = tracepoints; tpoint; tpoint = tpoint->next)
     if (tpoint->type == fast_tracepoint)
       if (tpoint->obj_addr_on_target == ipa_tpoint_obj)
 	return tpoint;
 
+  for (fb = fast_gdb_breakpoints; fb != NULL; fb = fb->next)
+    if (fb->tpoint.obj_addr_on_target == ipa_tpoint_obj)
+      return &fb->tpoint;
+
   return NULL;
 }
 
@@ -5785,25 +6312,78 @@ gdb_collect (struct tracepoint *tpoint, unsigned char *regs)
     }
 }
 
+/* This routine is called from the jump pads of fast conditional
+   breakpoints, instead of gdb_collect.  It is on the critical path
+   too: the thread only traps into GDBserver, at fast_break_hit, if
+   the breakpoint's condition is true.  */
+
+IP_AGENT_EXPORT void ATTR_USED
+gdb_fast_break (struct tracepoint *tpoint, unsigned char *regs)
+{
+  struct fast_tracepoint_ctx ctx;
+  ULONGEST value = 0;
+  enum eval_result_type err;
+
+  ctx.base.type = fast_tracepoint;
+  ctx.regs = regs;
+  ctx.regcache_initted = 0;
+  ctx.tpoint = tpoint;
+  ctx.regspace = alloca (register_cache_size ());
+  if (ctx.regspace == NULL)
+    {
+      fast_break_hit ();
+      return;
+    }
+
+  if (tpoint->compiled_cond)
+    err = ((condfn) (uintptr_t) (tpoint->compiled_cond)) (regs, &value);
+  else
+    {
+      struct eval_agent_expr_context ax_ctx;
+
+      ax_ctx.regcache
+	= get_context_regcache ((struct tracepoint_hit_ctx *) &ctx);
+      ax_ctx.tframe = NULL;
+      ax_ctx.tpoint = tpoint;
+
+      err = gdb_eval_agent_expr (&ax_ctx, tpoint->cond, &value);
+    }
+
+  /* Like GDBserver does for trap breakpoints, report the breakpoint
+     hit if the condition fails to evaluate, so that GDB evaluates it
+     again.  */
+  if (err != expr_eval_no_error || value != 0)
+    fast_break_hit ();
+}
+
 #endif
 
 #ifndef IN_PROCESS_AGENT
 
+/* When compiling code for GDBserver itself, the helpers called by the
+   compiled code are GDBserver's own rather than the IPA's.  */
+
 CORE_ADDR
 get_raw_reg_func_addr (void)
 {
+  if (emit_host_code)
+    return (CORE_ADDR) (uintptr_t) gdb_host_get_raw_reg;
   return ipa_sym_addrs.addr_get_raw_reg;
 }
 
 CORE_ADDR
 get_get_tsv_func_addr (void)
 {
+  if (emit_host_code)
+    return (CORE_ADDR) (uintptr_t) get_trace_state_variable_value;
   return ipa_sym_addrs.addr_get_trace_state_variable_value;
 }
 
 CORE_ADDR
 get_set_tsv_func_addr (void)
 {
+  if (emit_host_code)
+    return (CORE_ADDR) (uintptr_t) set_trace_state_variable_value;
   return ipa_sym_addrs.addr_set_trace_state_variable_value;
 }
 
@@ -36,7 +36,9 @@
 #include "cp-abi.h"
 #include "gdb_assert.h"
 #include "hashtab.h"
+#include "minsyms.h"
 #include "exceptions.h"
+#include "observer.h"
 
 /* Initialize BADNESS constants.  */
 
@@ -1338,6 +1340,170 @@ lookup_template_type (char *name, struct type *type,
   return (SYMBOL_TYPE (sym));
 }
 
+/* Structures and unions with fewer fields than this are searched
+   linearly, without building a struct field_name_index.  */
+#define FIELD_NAME_INDEX_MIN_FIELDS 16
+
+/* An index of the fields of a structure or union type by name.
+   Generated code can have structures with thousands of fields, and
+   member lookups would otherwise compare NAME with each of them.  */
+
+struct field_name_index
+{
+  /* The fields the index was built for.  The index is rebuilt if the
+     fields of the type are replaced.  */
+  struct field *fields;
+  int nfields;
+
+  /* The number of buckets minus one; the number of buckets is a power
+     of two.  */
+  unsigned int mask;
+
+  /* For each bucket, the last field whose name hashes to it, or -1.
+     Names are hashed with msymbol_hash_iw, so that names that
+     strcmp_iw considers equal hash to the same bucket.  */
+  int *buckets;
+
+  /* For each field, the previous field in the same bucket, or -1.  */
+  int *chain;
+
+  /* The fields a member lookup may have to look into: those with no
+     name, an empty name, or named "else".  Last field first.  */
+  int n_anonymous;
+  int *anonymous;
+};
+
+/* Return non-zero if the field named NAME may be an anonymous struct
+   or union that member lookups look into.  */
+
+static int
+field_name_maybe_anonymous (const char *name)
+{
+  return name == NULL || *name == '\0' || strcasecmp (name, "else") == 0;
+}
+
+/* Return the field name index of TYPE, a structure or union type,
+   building it if needed.  Return NULL if TYPE has too few fields to
+   be worth indexing.  */
+
+static struct field_name_index *
+get_field_name_index (struct type *type)
+{
+  struct field_name_index *index = TYPE_MAIN_TYPE (type)->field_index;
+  int nfields = TYPE_NFIELDS (type);
+  unsigned int nbuckets;
+  int i;
+
+  if (nfields < FIELD_NAME_INDEX_MIN_FIELDS)
+    return NULL;
+
+  if (index != NULL
+      && index->fields == TYPE_FIELDS (type)
+      && index->nfields == nfields)
+    return index;
+
+  nbuckets = 1;
+  while (nbuckets < 2 * nfields)
+    nbuckets <<= 1;
+
+  index = TYPE_ALLOC (type, sizeof (struct field_name_index));
+  index->fields = TYPE_FIELDS (type);
+  index->nfields = nfields;
+  index->mask = nbuckets - 1;
+  index->buckets = TYPE_ALLOC (type, nbuckets * sizeof (int));
+  index->chain = TYPE_ALLOC (type, nfields * sizeof (int));
+  index->n_anonymous = 0;
+
+  for (i = 0; i < nbuckets; i++)
+    index->buckets[i] = -1;
+
+  for (i = TYPE_N_BASECLASSES (type); i < nfields; i++)
+    {
+      const char *name = TYPE_FIELD_NAME (type, i);
+
+      if (field_name_maybe_anonymous (name))
+	index->n_anonymous++;
+      if (name != NULL)
+	{
+	  unsigned int bucket = msymbol_hash_iw (name) & index->mask;
+
+	  index->chain[i] = index->buckets[bucket];
+	  index->buckets[bucket] = i;
+	}
+    }
+
+  index->anonymous = TYPE_ALLOC (type, (index->n_anonymous + 1)
+				 * sizeof (int));
+  index->n_anonymous = 0;
+  for (i = nfields - 1; i >= TYPE_N_BASECLASSES (type); i--)
+    if (field_name_maybe_anonymous (TYPE_FIELD_NAME (type, i)))
+      index->anonymous[index->n_anonymous++] = i;
+
+  TYPE_MAIN_TYPE (type)->field_index = index;
+  return index;
+}
+
+/* Return the number of the last field of TYPE, a structure or union
+   type, whose name matches NAME as per strcmp_iw, or -1 if there is
+   none.  Base classes are not considered, nor are the members of
+   anonymous structures and unions.  */
+
+int
+struct_field_by_name (struct type *type, const char *name)
+{
+  struct field_name_index *index = get_field_name_index (type);
+  int i;
+
+  if (index == NULL)
+    {
+      for (i = TYPE_NFIELDS (type) - 1; i >= TYPE_N_BASECLASSES (type); i--)
+	{
+	  const char *t_field_name = TYPE_FIELD_NAME (type, i);
+
+	  if (t_field_name && strcmp_iw (t_field_name, name) == 0)
+	    return i;
+	}
+      return -1;
+    }
+
+  for (i = index->buckets[msymbol_hash_iw (name) & index->mask];
+       i >= 0;
+       i = index->chain[i])
+    if (strcmp_iw (TYPE_FIELD_NAME (type, i), name) == 0)
+      return i;
+
+  return -1;
+}
+
+/* Return the number of the last field of TYPE, a structure or union
+   type, before field BEFORE, that may be an anonymous structure or
+   union whose members are looked up as members of TYPE: a field with
+   no name, an empty name, or named "else".  Return -1 if there is
+   none.  Base classes are not considered.  Start with BEFORE equal to
+   TYPE_NFIELDS (TYPE) to get the last one.  Callers still need to
+   check the field.  */
+
+int
+struct_prev_anonymous_field (struct type *type, int before)
+{
+  struct field_name_index *index = get_field_name_index (type);
+  int i;
+
+  if (index == NULL)
+    {
+      for (i = before - 1; i >= TYPE_N_BASECLASSES (type); i--)
+	if (field_name_maybe_anonymous (TYPE_FIELD_NAME (type, i)))
+	  return i;
+      return -1;
+    }
+
+  for (i = 0; i < index->n_anonymous; i++)
+    if (index->anonymous[i] < before)
+      return index->anonymous[i];
+
+  return -1;
+}
+
 /* Given a type TYPE, lookup the type of the component of type named
    NAME.
 
@@ -1353,7 +1519,7 @@ lookup_template_type (char *name, struct type *type,
 struct type *
 lookup_struct_elt_type (struct type *type, char *name, int noerr)
 {
-  int i;
+  int i, found;
   char *typename;
 
   for (;;)
@@ -1387,15 +1553,23 @@ lookup_struct_elt_type (struct type *type, char *name, int noerr)
   }
 #endif
 
-  for (i = TYPE_NFIELDS (type) - 1; i >= TYPE_N_BASECLASSES (type); i--)
+  /* Search the fields from the last one, looking into the anonymous
+     structures and unions that come after the last field named NAME
+     before settling for it.  */
+  found = struct_field_by_name (type, name);
+  for (i = struct_prev_anonymous_field (type, TYPE_NFIELDS (type));
+       ;
+       i = struct_prev_anonymous_field (type, i))
     {
-      const char *t_field_name = TYPE_FIELD_NAME (type, i);
+      const char *t_field_name;
 
-      if (t_field_name && (strcmp_iw (t_field_name, name) == 0))
-	{
-	  return TYPE_FIELD_TYPE (type, i);
-	}
-     else if (!t_field_name || *t_field_name == '\0')
+      if (found >= 0 && found >= i)
+	return TYPE_FIELD_TYPE (type, found);
+      if (i < 0)
+	break;
+
+      t_field_name = TYPE_FIELD_NAME (type, i);
+      if (!t_field_name || *t_field_name == '\0')
 	{
 	  struct type *subtype 
 	    = lookup_struct_elt_type (TYPE_FIELD_TYPE (type, i), name, 1);
@@ -1483,6 +1657,132 @@ get_vptr_fieldno (struct type *type, struct type **basetypep)
     }
 }
 
+/* The complete types check_typedef found for opaque and stub types,
+   including those it could not replace in place because they are in
+   another objfile, and those it found none for.  Without this, each
+   call to check_typedef on such a type would search the symbols of
+   all objfiles again.  Maps main types of opaque or stub types to
+   struct resolved_type.  The cache is emptied when an objfile is
+   loaded, since it may define more types, and when an objfile the
+   cache refers to is freed.  */
+
+static htab_t resolved_types;
+
+struct resolved_type
+{
+  /* The main type of the opaque or stub type.  */
+  struct main_type *stub;
+
+  /* The complete type found for it, or NULL if none was.  */
+  struct type *complete;
+};
+
+/* Objfile data marking the objfiles whose types are in
+   RESOLVED_TYPES.  */
+
+static const struct objfile_data *resolved_types_objfile_data;
+
+static hashval_t
+hash_resolved_type (const void *p)
+{
+  const struct resolved_type *entry = p;
+
+  return htab_hash_pointer (entry->stub);
+}
+
+static int
+eq_resolved_type (const void *a, const void *b)
+{
+  const struct resolved_type *ea = a;
+  const struct resolved_type *eb = b;
+
+  return ea->stub == eb->stub;
+}
+
+/* Forget all the complete types found for opaque and stub types.  */
+
+static void
+clear_resolved_types (void)
+{
+  if (resolved_types != NULL)
+    htab_empty (resolved_types);
+}
+
+/* The new_objfile observer, for RESOLVED_TYPES.  */
+
+static void
+resolved_types_new_objfile (struct objfile *objfile)
+{
+  clear_resolved_types ();
+}
+
+/* The cleanup of RESOLVED_TYPES_OBJFILE_DATA, called when an objfile
+   with types in RESOLVED_TYPES is freed.  */
+
+static void
+resolved_types_free_objfile (struct objfile *objfile, void *data)
+{
+  clear_resolved_types ();
+}
+
+/* If the complete type of the opaque or stub type TYPE is cached,
+   store it in *COMPLETE, NULL if there is none, and return 1.
+   Otherwise return 0.  */
+
+static int
+lookup_resolved_type (struct type *type, struct type **complete)
+{
+  struct resolved_type entry, *found;
+
+  if (resolved_types == NULL)
+    return 0;
+
+  entry.stub = TYPE_MAIN_TYPE (type);
+  found = htab_find (resolved_types, &entry);
+  if (found == NULL)
+    return 0;
+
+  *complete = found->complete;
+  return 1;
+}
+
+/* Mark OBJFILE, if not NULL, as having types in RESOLVED_TYPES.  */
+
+static void
+mark_resolved_types_objfile (struct objfile *objfile)
+{
+  if (objfile != NULL
+      && objfile_data (objfile, resolved_types_objfile_data) == NULL)
+    set_objfile_data (objfile, resolved_types_objfile_data,
+		      &resolved_types);
+}
+
+/* Record COMPLETE, which may be NULL, as the complete type of the
+   opaque or stub type TYPE.  */
+
+static void
+cache_resolved_type (struct type *type, struct type *complete)
+{
+  struct resolved_type entry, **slot;
+
+  if (resolved_types == NULL)
+    resolved_types = htab_create_alloc (127, hash_resolved_type,
+					eq_resolved_type, xfree,
+					xcalloc, xfree);
+
+  entry.stub = TYPE_MAIN_TYPE (type);
+  slot = (struct resolved_type **) htab_find_slot (resolved_types, &entry,
+						   INSERT);
+  if (*slot == NULL)
+    *slot = XNEW (struct resolved_type);
+  (*slot)->stub = entry.stub;
+  (*slot)->complete = complete;
+
+  mark_resolved_types_objfile (TYPE_OBJFILE (type));
+  if (complete != NULL)
+    mark_resolved_types_objfile (TYPE_OBJFILE (complete));
+}
+
 static void
 stub_noname_complaint (void)
 {
@@ -1602,7 +1902,11 @@ check_typedef (struct type *type)
 	  stub_noname_complaint ();
 	  return make_qualified_type (type, instance_flags, NULL);
 	}
-      newtype = lookup_transparent_type (name);
+      if (!lookup_resolved_type (type, &newtype))
+	{
+	  newtype = lookup_transparent_type (name);
+	  cache_resolved_type (type, newtype);
+	}
 
       if (newtype)
 	{
@@ -1633,25 +1937,31 @@ check_typedef (struct type *type)
          TYPE_TAG_NAME, and look in STRUCT_DOMAIN and/or VAR_DOMAIN
          as appropriate?  (this code was written before TYPE_NAME and
          TYPE_TAG_NAME were separate).  */
-      struct symbol *sym;
+      struct type *newtype;
 
       if (name == NULL)
 	{
 	  stub_noname_complaint ();
 	  return make_qualified_type (type, instance_flags, NULL);
 	}
-      sym = lookup_symbol (name, 0, STRUCT_DOMAIN, 0);
-      if (sym)
+      if (!lookup_resolved_type (type, &newtype))
+	{
+	  struct symbol *sym = lookup_symbol (name, 0, STRUCT_DOMAIN, 0);
+
+	  newtype = sym != NULL ? SYMBOL_TYPE (sym) : NULL;
+	  cache_resolved_type (type, newtype);
+	}
+      if (newtype)
         {
           /* Same as above for opaque types, we can replace the stub
              with the complete type only if they are in the same
              objfile.  */
-	  if (TYPE_OBJFILE (SYMBOL_TYPE(sym)) == TYPE_OBJFILE (type))
-            type = make_qualified_type (SYMBOL_TYPE (sym),
+	  if (TYPE_OBJFILE (newtype) == TYPE_OBJFILE (type))
+            type = make_qualified_type (newtype,
 					TYPE_INSTANCE_FLAGS (type),
 					type);
 	  else
-	    type = SYMBOL_TYPE (sym);
+	    type = newtype;
         }
     }
 
@@ -3437,6 +3747,8 @@ copy_type_recursive (struct objfile *objfile,
   *TYPE_MAIN_TYPE (new_type) = *TYPE_MAIN_TYPE (type);
   TYPE_OBJFILE_OWNED (new_type) = 0;
   TYPE_OWNER (new_type).gdbarch = get_type_arch (type);
+  /* The index of the fields is on OBJFILE's obstack.  */
+  TYPE_MAIN_TYPE (new_type)->field_index = NULL;
 
   if (TYPE_NAME (type))
     TYPE_NAME (new_type) = xstrdup (TYPE_NAME (type));
@@ -4091,6 +4403,9 @@ _initialize_gdbtypes (void)
 {
   gdbtypes_data = gdbarch_data_register_post_init (gdbtypes_post_init);
   objfile_type_data = register_objfile_data ();
+  resolved_types_objfile_data
+    = register_objfile_data_with_cleanup (NULL, resolved_types_free_objfile);
+  observer_attach_new_objfile (resolved_types_new_objfile);
 
   add_setshow_zuinteger_cmd ("overload", no_class, &overload_debug,
 			     _("Set debugging of C++ overloading."),
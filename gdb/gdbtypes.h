@@ -644,6 +644,12 @@ struct main_type
     /* For TYPE_CODE_FUNC types,  */
     struct func_type *func_stuff;
   } type_specific;
+
+  /* For structure and union types with many fields, an index of the
+     fields by name, built by struct_field_by_name when first needed.
+     NULL otherwise.  */
+
+  struct field_name_index *field_index;
 };
 
 /* A ``struct type'' describes a particular instance of a type, with
@@ -1510,6 +1516,10 @@ extern const char *type_name_no_tag_or_error (struct type *type);
 
 extern struct type *lookup_struct_elt_type (struct type *, char *, int);
 
+extern int struct_field_by_name (struct type *type, const char *name);
+
+extern int struct_prev_anonymous_field (struct type *type, int before);
+
 extern struct type *make_pointer_type (struct type *, struct type **);
 
 extern struct type *lookup_pointer_type (struct type *);
@@ -1082,15 +1082,17 @@ static ptid_t deferred_step_ptid;
 
    In non-stop mode, we can have independent and simultaneous step
    requests, so more than one thread may need to simultaneously step
-   over a breakpoint.  The current implementation assumes there is
-   only one scratch space per process.  In this case, we have to
-   serialize access to the scratch space.  If thread A wants to step
-   over a breakpoint, but we are currently waiting for some other
-   thread to complete a displaced step, we leave thread A stopped and
-   place it in the displaced_step_request_queue.  Whenever a displaced
-   step finishes, we pick the next thread in the queue and start a new
-   displaced step operation on it.  See displaced_step_prepare and
-   displaced_step_fixup for details.  */
+   over a breakpoint.  Each process has a pool of scratch buffers,
+   laid out one after the other from the address given by
+   gdbarch_displaced_step_location; see displaced_step_buffers for how
+   many are used.  Each thread doing a displaced step owns one buffer
+   until its step finishes.  If thread A wants to step over a
+   breakpoint, but all the buffers are in use by other threads, we
+   leave thread A stopped and place it in the
+   displaced_step_request_queue.  Whenever a displaced step finishes,
+   we pick the next thread in the queue and start a new displaced step
+   operation on it, in the buffer just released.  See
+   displaced_step_prepare and displaced_step_fixup for details.  */
 
 struct displaced_step_request
 {
@@ -1098,21 +1100,12 @@ struct displaced_step_request
   struct displaced_step_request *next;
 };
 
-/* Per-inferior displaced stepping state.  */
-struct displaced_step_inferior_state
+/* A scratch buffer for displaced stepping, and the state of the step
+   using it, if any.  */
+struct displaced_step_buffer
 {
-  /* Pointer to next in linked list.  */
-  struct displaced_step_inferior_state *next;
-
-  /* The process this displaced step state refers to.  */
-  int pid;
-
-  /* A queue of pending displaced stepping requests.  One entry per
-     thread that needs to do a displaced step.  */
-  struct displaced_step_request *step_request_queue;
-
   /* If this is not null_ptid, this is the thread carrying out a
-     displaced single-step in process PID.  This thread's state will
+     displaced single-step in this buffer.  This thread's state will
      require fixing up once it has completed its step.  */
   ptid_t step_ptid;
 
@@ -1131,6 +1124,26 @@ struct displaced_step_inferior_state
   gdb_byte *step_saved_copy;
 };
 
+/* Per-inferior displaced stepping state.  */
+struct displaced_step_inferior_state
+{
+  /* Pointer to next in linked list.  */
+  struct displaced_step_inferior_state *next;
+
+  /* The process this displaced step state refers to.  */
+  int pid;
+
+  /* A queue of pending displaced stepping requests.  One entry per
+     thread that needs to do a displaced step.  */
+  struct displaced_step_request *step_request_queue;
+
+  /* The scratch buffers of this process, indexed by their position
+     after gdbarch_displaced_step_location, and how many have been
+     allocated.  */
+  struct displaced_step_buffer *buffers;
+  int num_buffers;
+};
+
 /* The list of states of processes involved in displaced stepping
    presently.  */
 static struct displaced_step_inferior_state *displaced_step_inferior_states;
@@ -1174,6 +1187,37 @@ add_displaced_stepping_state (int pid)
   return state;
 }
 
+/* Return the buffer in which thread PTID of DISPLACED is doing a
+   displaced step, or NULL if it is not doing one.  */
+
+static struct displaced_step_buffer *
+get_displaced_step_buffer (struct displaced_step_inferior_state *displaced,
+			   ptid_t ptid)
+{
+  int i;
+
+  for (i = 0; i < displaced->num_buffers; i++)
+    if (ptid_equal (displaced->buffers[i].step_ptid, ptid))
+      return &displaced->buffers[i];
+
+  return NULL;
+}
+
+/* Return non-zero if any thread of DISPLACED is doing a displaced
+   step.  */
+
+static int
+displaced_step_in_progress (struct displaced_step_inferior_state *displaced)
+{
+  int i;
+
+  for (i = 0; i < displaced->num_buffers; i++)
+    if (!ptid_equal (displaced->buffers[i].step_ptid, null_ptid))
+      return 1;
+
+  return 0;
+}
+
 /* If inferior is in displaced stepping, and ADDR equals to starting address
    of copy area, return corresponding displaced_step_closure.  Otherwise,
    return NULL.  */
@@ -1184,10 +1228,20 @@ get_displaced_step_closure_by_addr (CORE_ADDR addr)
   struct displaced_step_inferior_state *displaced
     = get_displaced_stepping_state (ptid_get_pid (inferior_ptid));
 
+  int i;
+
+  if (displaced == NULL)
+    return NULL;
+
   /* If checking the mode of displaced instruction in copy area.  */
-  if (displaced && !ptid_equal (displaced->step_ptid, null_ptid)
-     && (displaced->step_copy == addr))
-    return displaced->step_closure;
+  for (i = 0; i < displaced->num_buffers; i++)
+    {
+      struct displaced_step_buffer *buffer = &displaced->buffers[i];
+
+      if (!ptid_equal (buffer->step_ptid, null_ptid)
+	  && buffer->step_copy == addr)
+	return buffer->step_closure;
+    }
 
   return NULL;
 }
@@ -1207,7 +1261,19 @@ remove_displaced_stepping_state (int pid)
     {
       if (it->pid == pid)
 	{
+	  int i;
+
 	  *prev_next_p = it->next;
+	  for (i = 0; i < it->num_buffers; i++)
+	    {
+	      struct displaced_step_buffer *buffer = &it->buffers[i];
+
+	      if (buffer->step_closure != NULL)
+		gdbarch_displaced_step_free_closure (buffer->step_gdbarch,
+						     buffer->step_closure);
+	      xfree (buffer->step_saved_copy);
+	    }
+	  xfree (it->buffers);
 	  xfree (it);
 	  return;
 	}
@@ -1261,27 +1327,88 @@ use_displaced_stepping (struct gdbarch *gdbarch)
 	  && !RECORD_IS_USED);
 }
 
+/* The maximum number of scratch buffers GDB uses for displaced
+   stepping in each process, so that as many threads can step over
+   breakpoints at the same time.  UINT_MAX means as many as fit in the
+   function holding gdbarch_displaced_step_location.  */
+
+static unsigned int displaced_step_buffers = 4;
+
+static void
+show_displaced_step_buffers (struct ui_file *file, int from_tty,
+			     struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file,
+		    _("The maximum number of displaced stepping buffers "
+		      "per process is %s.\n"), value);
+}
+
+/* Return how many scratch buffers GDBARCH can use for displaced
+   stepping, starting at BASE, and store in *STRIDE the distance
+   between the start of two consecutive buffers.  The first buffer is
+   the one the architecture reserves at BASE.  The others are only
+   placed within the function holding BASE, normally the program's
+   entry point, which does not run again once the program started; if
+   the extent of that function is not known, a single buffer is
+   used.  */
+
+static int
+displaced_step_buffer_count (struct gdbarch *gdbarch, CORE_ADDR base,
+			     ULONGEST *stride)
+{
+  struct minimal_symbol *msymbol;
+  CORE_ADDR addr = base;
+  CORE_ADDR end;
+  ULONGEST count;
+  int bp_len;
+
+  /* Leave room for the breakpoint some architectures place after the
+     copied instructions, and keep the buffers aligned like BASE.  */
+  gdbarch_breakpoint_from_pc (gdbarch, &addr, &bp_len);
+  *stride = align_up (gdbarch_max_insn_length (gdbarch) + bp_len, 8);
+
+  if (displaced_step_buffers <= 1)
+    return 1;
+
+  msymbol = lookup_minimal_symbol_by_pc (base);
+  if (msymbol == NULL || !MSYMBOL_HAS_SIZE (msymbol))
+    return 1;
+
+  end = SYMBOL_VALUE_ADDRESS (msymbol) + MSYMBOL_SIZE (msymbol);
+  if (end <= base)
+    return 1;
+
+  count = (end - base) / *stride;
+  if (count > displaced_step_buffers)
+    count = displaced_step_buffers;
+  /* Keep the buffer array reasonably sized whatever the function.  */
+  if (count > 1024)
+    count = 1024;
+
+  return count > 0 ? count : 1;
+}
+
 /* Clean out any stray displaced stepping state.  */
 static void
-displaced_step_clear (struct displaced_step_inferior_state *displaced)
+displaced_step_clear (struct displaced_step_buffer *buffer)
 {
   /* Indicate that there is no cleanup pending.  */
-  displaced->step_ptid = null_ptid;
+  buffer->step_ptid = null_ptid;
 
-  if (displaced->step_closure)
+  if (buffer->step_closure)
     {
-      gdbarch_displaced_step_free_closure (displaced->step_gdbarch,
-                                           displaced->step_closure);
-      displaced->step_closure = NULL;
+      gdbarch_displaced_step_free_closure (buffer->step_gdbarch,
+                                           buffer->step_closure);
+      buffer->step_closure = NULL;
     }
 }
 
 static void
 displaced_step_clear_cleanup (void *arg)
 {
-  struct displaced_step_inferior_state *state = arg;
+  struct displaced_step_buffer *buffer = arg;
 
-  displaced_step_clear (state);
+  displaced_step_clear (buffer);
 }
 
 /* Dump LEN bytes at BUF in hex to FILE, followed by a newline.  */
@@ -1317,27 +1444,57 @@ displaced_step_prepare (ptid_t ptid)
   struct cleanup *old_cleanups, *ignore_cleanups;
   struct regcache *regcache = get_thread_regcache (ptid);
   struct gdbarch *gdbarch = get_regcache_arch (regcache);
-  CORE_ADDR original, copy;
-  ULONGEST len;
+  CORE_ADDR original, base, copy;
+  ULONGEST len, stride;
   struct displaced_step_closure *closure;
   struct displaced_step_inferior_state *displaced;
-  int status;
+  struct displaced_step_buffer *buffer;
+  int count, i, status;
 
   /* We should never reach this function if the architecture does not
      support displaced stepping.  */
   gdb_assert (gdbarch_displaced_step_copy_insn_p (gdbarch));
 
-  /* We have to displaced step one thread at a time, as we only have
-     access to a single scratch space per inferior.  */
-
   displaced = add_displaced_stepping_state (ptid_get_pid (ptid));
 
-  if (!ptid_equal (displaced->step_ptid, null_ptid))
+  old_cleanups = save_inferior_ptid ();
+  inferior_ptid = ptid;
+
+  base = gdbarch_displaced_step_location (gdbarch);
+  len = gdbarch_max_insn_length (gdbarch);
+  count = displaced_step_buffer_count (gdbarch, base, &stride);
+
+  /* Each thread steps in its own scratch buffer; look for a free
+     one.  */
+  if (count > displaced->num_buffers)
+    {
+      displaced->buffers = xrealloc (displaced->buffers,
+				     count * sizeof (*displaced->buffers));
+      memset (&displaced->buffers[displaced->num_buffers], 0,
+	      ((count - displaced->num_buffers)
+	       * sizeof (*displaced->buffers)));
+      for (i = displaced->num_buffers; i < count; i++)
+	displaced->buffers[i].step_ptid = null_ptid;
+      displaced->num_buffers = count;
+    }
+
+  buffer = NULL;
+  for (i = 0; i < count; i++)
+    if (ptid_equal (displaced->buffers[i].step_ptid, null_ptid))
+      {
+	buffer = &displaced->buffers[i];
+	break;
+      }
+
+  if (buffer == NULL)
     {
-      /* Already waiting for a displaced step to finish.  Defer this
-	 request and place in queue.  */
+      /* All the buffers are in use by other threads waiting for their
+	 displaced step to finish.  Defer this request and place in
+	 queue.  */
       struct displaced_step_request *req, *new_req;
 
+      do_cleanups (old_cleanups);
+
       if (debug_displaced)
 	fprintf_unfiltered (gdb_stdlog,
 			    "displaced: defering step of %s\n",
@@ -1364,25 +1521,19 @@ displaced_step_prepare (ptid_t ptid)
     {
       if (debug_displaced)
 	fprintf_unfiltered (gdb_stdlog,
-			    "displaced: stepping %s now\n",
-			    target_pid_to_str (ptid));
+			    "displaced: stepping %s now in buffer %d\n",
+			    target_pid_to_str (ptid), i);
     }
 
-  displaced_step_clear (displaced);
-
-  old_cleanups = save_inferior_ptid ();
-  inferior_ptid = ptid;
+  displaced_step_clear (buffer);
 
   original = regcache_read_pc (regcache);
 
-  copy = gdbarch_displaced_step_location (gdbarch);
-  len = gdbarch_max_insn_length (gdbarch);
+  copy = base + i * stride;
 
   /* Save the original contents of the copy area.  */
-  displaced->step_saved_copy = xmalloc (len);
-  ignore_cleanups = make_cleanup (free_current_contents,
-				  &displaced->step_saved_copy);
-  status = target_read_memory (copy, displaced->step_saved_copy, len);
+  buffer->step_saved_copy = xrealloc (buffer->step_saved_copy, len);
+  status = target_read_memory (copy, buffer->step_saved_copy, len);
   if (status != 0)
     throw_error (MEMORY_ERROR,
 		 _("Error accessing memory address %s (%s) for "
@@ -1393,7 +1544,7 @@ displaced_step_prepare (ptid_t ptid)
       fprintf_unfiltered (gdb_stdlog, "displaced: saved %s: ",
 			  paddress (gdbarch, copy));
       displaced_step_dump_bytes (gdb_stdlog,
-				 displaced->step_saved_copy,
+				 buffer->step_saved_copy,
 				 len);
     };
 
@@ -1405,13 +1556,13 @@ displaced_step_prepare (ptid_t ptid)
 
   /* Save the information we need to fix things up if the step
      succeeds.  */
-  displaced->step_ptid = ptid;
-  displaced->step_gdbarch = gdbarch;
-  displaced->step_closure = closure;
-  displaced->step_original = original;
-  displaced->step_copy = copy;
+  buffer->step_ptid = ptid;
+  buffer->step_gdbarch = gdbarch;
+  buffer->step_closure = closure;
+  buffer->step_original = original;
+  buffer->step_copy = copy;
 
-  make_cleanup (displaced_step_clear_cleanup, displaced);
+  ignore_cleanups = make_cleanup (displaced_step_clear_cleanup, buffer);
 
   /* Resume execution at the copy.  */
   regcache_write_pc (regcache, copy);
@@ -1438,21 +1589,20 @@ write_memory_ptid (ptid_t ptid, CORE_ADDR memaddr,
   do_cleanups (ptid_cleanup);
 }
 
-/* Restore the contents of the copy area for thread PTID.  */
+/* Restore the contents of BUFFER's copy area for thread PTID.  */
 
 static void
-displaced_step_restore (struct displaced_step_inferior_state *displaced,
-			ptid_t ptid)
+displaced_step_restore (struct displaced_step_buffer *buffer, ptid_t ptid)
 {
-  ULONGEST len = gdbarch_max_insn_length (displaced->step_gdbarch);
+  ULONGEST len = gdbarch_max_insn_length (buffer->step_gdbarch);
 
-  write_memory_ptid (ptid, displaced->step_copy,
-		     displaced->step_saved_copy, len);
+  write_memory_ptid (ptid, buffer->step_copy,
+		     buffer->step_saved_copy, len);
   if (debug_displaced)
     fprintf_unfiltered (gdb_stdlog, "displaced: restored %s %s\n",
 			target_pid_to_str (ptid),
-			paddress (displaced->step_gdbarch,
-				  displaced->step_copy));
+			paddress (buffer->step_gdbarch,
+				  buffer->step_copy));
 }
 
 static void
@@ -1461,29 +1611,32 @@ displaced_step_fixup (ptid_t event_ptid, enum gdb_signal signal)
   struct cleanup *old_cleanups;
   struct displaced_step_inferior_state *displaced
     = get_displaced_stepping_state (ptid_get_pid (event_ptid));
+  struct displaced_step_buffer *buffer;
 
   /* Was any thread of this process doing a displaced step?  */
   if (displaced == NULL)
     return;
 
-  /* Was this event for the pid we displaced?  */
-  if (ptid_equal (displaced->step_ptid, null_ptid)
-      || ! ptid_equal (displaced->step_ptid, event_ptid))
+  /* Was this event for a thread we displaced?  */
+  if (ptid_equal (event_ptid, null_ptid))
+    return;
+  buffer = get_displaced_step_buffer (displaced, event_ptid);
+  if (buffer == NULL)
     return;
 
-  old_cleanups = make_cleanup (displaced_step_clear_cleanup, displaced);
+  old_cleanups = make_cleanup (displaced_step_clear_cleanup, buffer);
 
-  displaced_step_restore (displaced, displaced->step_ptid);
+  displaced_step_restore (buffer, buffer->step_ptid);
 
   /* Did the instruction complete successfully?  */
   if (signal == GDB_SIGNAL_TRAP)
     {
       /* Fix up the resulting state.  */
-      gdbarch_displaced_step_fixup (displaced->step_gdbarch,
-                                    displaced->step_closure,
-                                    displaced->step_original,
-                                    displaced->step_copy,
-                                    get_thread_regcache (displaced->step_ptid));
+      gdbarch_displaced_step_fixup (buffer->step_gdbarch,
+                                    buffer->step_closure,
+                                    buffer->step_original,
+                                    buffer->step_copy,
+                                    get_thread_regcache (buffer->step_ptid));
     }
   else
     {
@@ -1492,17 +1645,17 @@ displaced_step_fixup (ptid_t event_ptid, enum gdb_signal signal)
       struct regcache *regcache = get_thread_regcache (event_ptid);
       CORE_ADDR pc = regcache_read_pc (regcache);
 
-      pc = displaced->step_original + (pc - displaced->step_copy);
+      pc = buffer->step_original + (pc - buffer->step_copy);
       regcache_write_pc (regcache, pc);
     }
 
   do_cleanups (old_cleanups);
 
-  displaced->step_ptid = null_ptid;
+  buffer->step_ptid = null_ptid;
 
   /* Are there any pending displaced stepping requests?  If so, run
-     one now.  Leave the state object around, since we're likely to
-     need it again soon.  */
+     one now, in the buffer we just released.  Leave the state object
+     around, since we're likely to need it again soon.  */
   while (displaced->step_request_queue)
     {
       struct displaced_step_request *head;
@@ -1530,7 +1683,11 @@ displaced_step_fixup (ptid_t event_ptid, enum gdb_signal signal)
 				"displaced: stepping queued %s now\n",
 				target_pid_to_str (ptid));
 
-	  displaced_step_prepare (ptid);
+	  /* If fewer buffers may be used now than when the step that
+	     just finished started, the thread may have been queued
+	     again.  */
+	  if (!displaced_step_prepare (ptid))
+	    break;
 
 	  gdbarch = get_regcache_arch (regcache);
 
@@ -1545,8 +1702,9 @@ displaced_step_fixup (ptid_t event_ptid, enum gdb_signal signal)
 	      displaced_step_dump_bytes (gdb_stdlog, buf, sizeof (buf));
 	    }
 
+	  buffer = get_displaced_step_buffer (displaced, ptid);
 	  if (gdbarch_displaced_step_hw_singlestep (gdbarch,
-						    displaced->step_closure))
+						    buffer->step_closure))
 	    target_resume (ptid, 1, GDB_SIGNAL_0);
 	  else
 	    target_resume (ptid, 0, GDB_SIGNAL_0);
@@ -1601,8 +1759,11 @@ infrun_thread_ptid_changed (ptid_t old_ptid, ptid_t new_ptid)
        displaced;
        displaced = displaced->next)
     {
-      if (ptid_equal (displaced->step_ptid, old_ptid))
-	displaced->step_ptid = new_ptid;
+      int i;
+
+      for (i = 0; i < displaced->num_buffers; i++)
+	if (ptid_equal (displaced->buffers[i].step_ptid, old_ptid))
+	  displaced->buffers[i].step_ptid = new_ptid;
 
       for (it = displaced->step_request_queue; it; it = it->next)
 	if (ptid_equal (it->ptid, old_ptid))
@@ -1800,6 +1961,7 @@ a command like `return' or `jump' to continue execution."));
       && !current_inferior ()->waiting_for_vfork_done)
     {
       struct displaced_step_inferior_state *displaced;
+      struct displaced_step_buffer *buffer;
 
       if (!displaced_step_prepare (inferior_ptid))
 	{
@@ -1819,8 +1981,9 @@ a command like `return' or `jump' to continue execution."));
       pc = regcache_read_pc (get_thread_regcache (inferior_ptid));
 
       displaced = get_displaced_stepping_state (ptid_get_pid (inferior_ptid));
+      buffer = get_displaced_step_buffer (displaced, inferior_ptid);
       step = gdbarch_displaced_step_hw_singlestep (gdbarch,
-						   displaced->step_closure);
+						   buffer->step_closure);
     }
 
   /* Do we need to do it the hard way, w/temp breakpoints?  */
@@ -2643,7 +2806,7 @@ prepare_for_detach (void)
 
   /* Is any thread of this process displaced stepping?  If not,
      there's nothing else to do.  */
-  if (displaced == NULL || ptid_equal (displaced->step_ptid, null_ptid))
+  if (displaced == NULL || !displaced_step_in_progress (displaced))
     return;
 
   if (debug_infrun)
@@ -2653,7 +2816,7 @@ prepare_for_detach (void)
   old_chain_1 = make_cleanup_restore_integer (&inf->detaching);
   inf->detaching = 1;
 
-  while (!ptid_equal (displaced->step_ptid, null_ptid))
+  while (displaced_step_in_progress (displaced))
     {
       struct cleanup *old_chain_2;
       struct execution_control_state ecss;
@@ -3461,13 +3624,23 @@ handle_inferior_event (struct execution_control_state *ecs)
 
 	/* If checking displaced stepping is supported, and thread
 	   ecs->ptid is displaced stepping.  */
-	if (displaced && ptid_equal (displaced->step_ptid, ecs->ptid))
+	if (displaced && get_displaced_step_buffer (displaced, ecs->ptid))
 	  {
 	    struct inferior *parent_inf
 	      = find_inferior_pid (ptid_get_pid (ecs->ptid));
 	    struct regcache *child_regcache;
 	    CORE_ADDR parent_pc;
 
+	    if (ecs->ws.kind == TARGET_WAITKIND_FORKED)
+	      {
+		/* Restore scratch pad for child process.  Do this
+		   first, as the fixup below may hand the buffer over
+		   to a queued thread.  */
+		displaced_step_restore (get_displaced_step_buffer (displaced,
+								   ecs->ptid),
+					ecs->ws.value.related_pid);
+	      }
+
 	    /* GDB has got TARGET_WAITKIND_FORKED or TARGET_WAITKIND_VFORKED,
 	       indicating that the displaced stepping of syscall instruction
 	       has been done.  Perform cleanup for parent process here.  Note
@@ -3475,12 +3648,6 @@ handle_inferior_event (struct execution_control_state *ecs)
 	       because their pages are shared.  */
 	    displaced_step_fixup (ecs->ptid, GDB_SIGNAL_TRAP);
 
-	    if (ecs->ws.kind == TARGET_WAITKIND_FORKED)
-	      {
-		/* Restore scratch pad for child process.  */
-		displaced_step_restore (displaced, ecs->ws.value.related_pid);
-	      }
-
 	    /* Since the vfork/fork syscall instruction was executed in the scratchpad,
 	       the child's PC is also within the scratchpad.  Set the child's PC
 	       to the parent's PC value, which has already been fixed up.
@@ -7398,6 +7565,19 @@ use it in all-stop mode (see help set non-stop)."),
 				show_can_use_displaced_stepping,
 				&setlist, &showlist);
 
+  add_setshow_uinteger_cmd ("displaced-stepping-buffers", class_run,
+			    &displaced_step_buffers, _("\
+Set the maximum number of displaced stepping buffers per process."), _("\
+Show the maximum number of displaced stepping buffers per process."), _("\
+This many threads of a process can step over breakpoints with displaced\n\
+stepping at the same time; other threads wait for their turn.  Fewer\n\
+buffers are used if they do not fit in the function holding the address\n\
+the architecture reserves for displaced stepping, normally the program's\n\
+entry point.  Zero means to use as many buffers as fit there."),
+			    NULL,
+			    show_displaced_step_buffers,
+			    &setlist, &showlist);
+
   add_setshow_enum_cmd ("exec-direction", class_run, exec_direction_names,
 			&exec_direction, _("Set direction of execution.\n\
 Options are 'forward' or 'reverse'."),
@@ -206,6 +206,10 @@ struct linespec_state
   /* This is a set of address_entry objects which is used to prevent
      duplicate symbols from being entered into the result.  */
   htab_t addr_set;
+
+  /* If not NULL, only this objfile and its separate debug objfiles
+     are searched.  See linespec_result.  */
+  struct objfile *search_objfile;
 };
 
 /* This is a helper object that is used when collecting symbols into a
@@ -332,7 +336,8 @@ static struct symtabs_and_lines decode_objc (struct linespec_state *self,
 					     linespec_p ls,
 					     char **argptr);
 
-static VEC (symtab_p) *symtabs_from_filename (const char *);
+static VEC (symtab_p) *symtabs_from_filename (struct linespec_state *,
+					     const char *);
 
 static VEC (symbolp) *find_label_symbols (struct linespec_state *self,
 					  VEC (symbolp) *function_symbols,
@@ -360,7 +365,8 @@ static void add_all_symbol_names_from_pspace (struct collect_info *info,
 					      struct program_space *pspace,
 					      VEC (const_char_ptr) *names);
 
-static VEC (symtab_p) *collect_symtabs_from_filename (const char *file);
+static VEC (symtab_p) *collect_symtabs_from_filename (struct linespec_state *,
+						       const char *);
 
 static void decode_digits_ordinary (struct linespec_state *self,
 				    linespec_p ls,
@@ -998,6 +1004,21 @@ iterate_name_matcher (const char *name, void *d)
   return 0; /* Skip this symbol.  */
 }
 
+/* Return non-zero if the linespec decoded with STATE may look for
+   symbols in OBJFILE.  */
+
+static int
+linespec_searches_objfile_p (struct linespec_state *state,
+			     struct objfile *objfile)
+{
+  if (state->search_objfile == NULL)
+    return 1;
+
+  if (objfile->separate_debug_objfile_backlink != NULL)
+    objfile = objfile->separate_debug_objfile_backlink;
+  return objfile == state->search_objfile;
+}
+
 /* A helper that walks over all matching symtabs in all objfiles and
    calls CALLBACK for each symbol matching NAME.  If SEARCH_PSPACE is
    not NULL, then the search is restricted to just that program
@@ -1036,6 +1057,9 @@ iterate_over_all_matching_symtabs (struct linespec_state *state,
     {
       struct symtab *symtab;
 
+      if (!linespec_searches_objfile_p (state, objfile))
+	continue;
+
       if (objfile->sf)
 	objfile->sf->qf->expand_symtabs_matching (objfile, NULL,
 						  iterate_name_matcher,
@@ -1854,7 +1878,7 @@ create_sals_line_offset (struct linespec_state *self,
       fullname = symtab_to_fullname (self->default_symtab);
       VEC_pop (symtab_p, ls->file_symtabs);
       VEC_free (symtab_p, ls->file_symtabs);
-      ls->file_symtabs = collect_symtabs_from_filename (fullname);
+      ls->file_symtabs = collect_symtabs_from_filename (self, fullname);
       use_default = 1;
     }
 
@@ -2251,7 +2275,7 @@ parse_linespec (linespec_parser *parser, char **argptr)
       TRY_CATCH (file_exception, RETURN_MASK_ERROR)
 	{
 	  PARSER_RESULT (parser)->file_symtabs
-	    = symtabs_from_filename (user_filename);
+	    = symtabs_from_filename (PARSER_STATE (parser), user_filename);
 	}
 
       if (file_exception.reason >= 0)
@@ -2340,6 +2364,8 @@ linespec_state_constructor (struct linespec_state *self,
   self->default_line = default_line;
   self->canonical = canonical;
   self->program_space = current_program_space;
+  if (canonical != NULL)
+    self->search_objfile = canonical->search_objfile;
   self->addr_set = htab_create_alloc (10, hash_address_entry, eq_address_entry,
 				      xfree, xcalloc, xfree);
 }
@@ -2972,7 +2998,8 @@ add_symtabs_to_list (struct symtab *symtab, void *d)
 /* Given a file name, return a VEC of all matching symtabs.  */
 
 static VEC (symtab_p) *
-collect_symtabs_from_filename (const char *file)
+collect_symtabs_from_filename (struct linespec_state *state,
+			       const char *file)
 {
   struct symtab_collector collector;
   struct cleanup *cleanups;
@@ -2990,7 +3017,11 @@ collect_symtabs_from_filename (const char *file)
       continue;
 
     set_current_program_space (pspace);
-    iterate_over_symtabs (file, add_symtabs_to_list, &collector);
+    if (state->search_objfile != NULL)
+      iterate_over_objfile_symtabs (state->search_objfile, file,
+				    add_symtabs_to_list, &collector);
+    else
+      iterate_over_symtabs (file, add_symtabs_to_list, &collector);
   }
 
   do_cleanups (cleanups);
@@ -3000,11 +3031,11 @@ collect_symtabs_from_filename (const char *file)
 /* Return all the symtabs associated to the FILENAME.  */
 
 static VEC (symtab_p) *
-symtabs_from_filename (const char *filename)
+symtabs_from_filename (struct linespec_state *state, const char *filename)
 {
   VEC (symtab_p) *result;
   
-  result = collect_symtabs_from_filename (filename);
+  result = collect_symtabs_from_filename (state, filename);
 
   if (VEC_empty (symtab_p, result))
     {
@@ -3538,6 +3569,9 @@ search_minsyms_for_name (struct collect_info *info, const char *name,
 
     ALL_OBJFILES (objfile)
     {
+      if (!linespec_searches_objfile_p (info->state, objfile))
+	continue;
+
       local.objfile = objfile;
       iterate_over_minimal_symbols (objfile, name, add_minsym, &local);
     }
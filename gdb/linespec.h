@@ -78,6 +78,12 @@ struct linespec_result
   /* The sals.  The vector will be freed by
      destroy_linespec_result.  */
   VEC (linespec_sals) *sals;
+
+  /* If not NULL, set by the caller of decode_line_full to only look
+     for symbols and source files in this objfile and its separate
+     debug objfiles.  Breakpoints use this to look for new locations
+     in a newly loaded shared library.  */
+  struct objfile *search_objfile;
 };
 
 /* Initialize a linespec_result.  */
@@ -219,13 +219,16 @@ create_mem_region (CORE_ADDR lo, CORE_ADDR hi,
   VEC_safe_insert (mem_region_s, mem_region_list, ix, &new);
 }
 
+/* The region lookup_mem_region returns for addresses that are not in
+   any region of the memory map.  */
+static struct mem_region default_region;
+
 /*
  * Look up the memory region cooresponding to ADDR.
  */
 struct mem_region *
 lookup_mem_region (CORE_ADDR addr)
 {
-  static struct mem_region region;
   struct mem_region *m;
   CORE_ADDR lo;
   CORE_ADDR hi;
@@ -275,18 +278,28 @@ lookup_mem_region (CORE_ADDR addr)
 
   /* Because no region was found, we must cons up one based on what
      was learned above.  */
-  region.lo = lo;
-  region.hi = hi;
+  default_region.lo = lo;
+  default_region.hi = hi;
 
   /* When no memory map is defined at all, we always return 
      'default_mem_attrib', so that we do not make all memory 
      inaccessible for targets that don't provide a memory map.  */
   if (inaccessible_by_default && !VEC_empty (mem_region_s, mem_region_list))
-    region.attrib = unknown_mem_attrib;
+    default_region.attrib = unknown_mem_attrib;
   else
-    region.attrib = default_mem_attrib;
+    default_region.attrib = default_mem_attrib;
+
+  return &default_region;
+}
 
-  return &region;
+/* Return non-zero if REGION, as returned by lookup_mem_region, is not
+   part of the memory map, i.e. the user or the target did not define
+   it explicitly.  */
+
+int
+default_mem_region_p (const struct mem_region *region)
+{
+  return region == &default_region;
 }
 
 /* Invalidate any memory regions fetched from the target.  */
@@ -100,6 +100,8 @@ DEF_VEC_O(mem_region_s);
 
 extern struct mem_region *lookup_mem_region(CORE_ADDR);
 
+extern int default_mem_region_p (const struct mem_region *);
+
 void invalidate_target_mem_regions (void);
 
 void mem_region_init (struct mem_region *);
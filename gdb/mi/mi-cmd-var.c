@@ -455,6 +455,11 @@ mi_cmd_var_list_children (char *command, char **argv, int argc)
 	{
 	  struct cleanup *cleanup_child;
 
+	  /* A child of a dynamic varobj may be missing if the
+	     pretty-printer returned fewer children than before.  */
+	  if (child == NULL)
+	    continue;
+
 	  cleanup_child = make_cleanup_ui_out_tuple_begin_end (uiout, "child");
 	  print_varobj (child, print_values, 1 /* print expression */);
 	  do_cleanups (cleanup_child);
@@ -721,6 +726,7 @@ mi_cmd_var_update (char *command, char **argv, int argc)
 	 VAROBJ.  Therefore update each VAROBJ only once by iterating
 	 only the root VAROBJs.  */
 
+      varobj_prefetch_root_snapshots (data.only_floating);
       all_root_varobjs (mi_cmd_var_update_iter, &data);
     }
   else
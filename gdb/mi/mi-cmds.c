@@ -76,6 +76,7 @@ static struct mi_cmd mi_cmds[] =
 		 mi_cmd_data_list_changed_registers),
   DEF_MI_CMD_MI ("data-list-register-names", mi_cmd_data_list_register_names),
   DEF_MI_CMD_MI ("data-list-register-values", mi_cmd_data_list_register_values),
+  DEF_MI_CMD_MI ("data-read-batch", mi_cmd_data_read_batch),
   DEF_MI_CMD_MI ("data-read-memory", mi_cmd_data_read_memory),
   DEF_MI_CMD_MI ("data-read-memory-bytes", mi_cmd_data_read_memory_bytes),
   DEF_MI_CMD_MI_1 ("data-write-memory", mi_cmd_data_write_memory,
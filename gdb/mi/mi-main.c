@@ -51,6 +51,8 @@
 #include "tracepoint.h"
 #include "ada-lang.h"
 #include "linespec.h"
+#include "memrange.h"
+#include "cli/cli-utils.h"
 
 #include <ctype.h>
 #include <sys/time.h>
@@ -100,6 +102,11 @@ static void mi_execute_async_cli_command (char *cli_command,
 static int register_changed_p (int regnum, struct regcache *,
 			       struct regcache *);
 static void get_register (struct frame_info *, int regnum, int format);
+static void output_register_values (struct frame_info *frame, int format,
+				    char **regs, int nregs);
+static void output_memory_block (struct gdbarch *gdbarch, CORE_ADDR base,
+				 CORE_ADDR begin, CORE_ADDR end,
+				 const gdb_byte *data);
 
 /* Command implementations.  FIXME: Is this libgdb?  No.  This is the MI
    layer that calls libgdb.  Any operation used in the below should be
@@ -1060,10 +1067,31 @@ register_changed_p (int regnum, struct regcache *prev_regs,
 void
 mi_cmd_data_list_register_values (char *command, char **argv, int argc)
 {
-  struct ui_out *uiout = current_uiout;
   struct frame_info *frame;
+  int format;
+
+  if (argc == 0)
+    error (_("-data-list-register-values: Usage: "
+	     "-data-list-register-values <format> [<regnum1>...<regnumN>]"));
+
+  format = (int) argv[0][0];
+
+  frame = get_selected_frame (NULL);
+  output_register_values (frame, format, argv + 1, argc - 1);
+}
+
+/* Output a list named "register-values" holding the number and the
+   contents of each register of FRAME listed in REGS, formatted
+   according to FORMAT.  If NREGS is zero, output all the registers of
+   FRAME.  */
+
+static void
+output_register_values (struct frame_info *frame, int format,
+			char **regs, int nregs)
+{
+  struct ui_out *uiout = current_uiout;
   struct gdbarch *gdbarch;
-  int regnum, numregs, format;
+  int regnum, numregs;
   int i;
   struct cleanup *list_cleanup, *tuple_cleanup;
 
@@ -1074,21 +1102,14 @@ mi_cmd_data_list_register_values (char *command, char **argv, int argc)
      will change depending upon the particular processor being
      debugged.  */
 
-  if (argc == 0)
-    error (_("-data-list-register-values: Usage: "
-	     "-data-list-register-values <format> [<regnum1>...<regnumN>]"));
-
-  format = (int) argv[0][0];
-
-  frame = get_selected_frame (NULL);
   gdbarch = get_frame_arch (frame);
   numregs = gdbarch_num_regs (gdbarch) + gdbarch_num_pseudo_regs (gdbarch);
 
   list_cleanup = make_cleanup_ui_out_list_begin_end (uiout, "register-values");
 
-  if (argc == 1)
+  if (nregs == 0)
     {
-      /* No args, beside the format: do all the regs.  */
+      /* No register numbers: do all the regs.  */
       for (regnum = 0;
 	   regnum < numregs;
 	   regnum++)
@@ -1104,9 +1125,9 @@ mi_cmd_data_list_register_values (char *command, char **argv, int argc)
     }
 
   /* Else, list of register #s, just do listed regs.  */
-  for (i = 1; i < argc; i++)
+  for (i = 0; i < nregs; i++)
     {
-      regnum = atoi (argv[i]);
+      regnum = atoi (regs[i]);
 
       if (regnum >= 0
 	  && regnum < numregs
@@ -1538,27 +1559,227 @@ mi_cmd_data_read_memory_bytes (char *command, char **argv, int argc)
        VEC_iterate (memory_read_result_s, result, ix, read_result);
        ++ix)
     {
-      struct cleanup *t = make_cleanup_ui_out_tuple_begin_end (uiout, NULL);
-      char *data, *p;
-      int i;
+      output_memory_block (gdbarch, addr, read_result->begin,
+			   read_result->end, read_result->data);
+    }
+  do_cleanups (cleanups);
+}
+
+/* Output a tuple describing the LEN bytes at DATA, read from memory
+   at address BEGIN.  BASE is the address that was requested, from
+   which the "offset" field is computed.  */
+
+static void
+output_memory_block (struct gdbarch *gdbarch, CORE_ADDR base,
+		     CORE_ADDR begin, CORE_ADDR end, const gdb_byte *data)
+{
+  struct ui_out *uiout = current_uiout;
+  struct cleanup *t = make_cleanup_ui_out_tuple_begin_end (uiout, NULL);
+  char *contents, *p;
+  int i;
+
+  ui_out_field_core_addr (uiout, "begin", gdbarch, begin);
+  ui_out_field_core_addr (uiout, "offset", gdbarch, begin - base);
+  ui_out_field_core_addr (uiout, "end", gdbarch, end);
+
+  contents = xmalloc ((end - begin) * 2 + 1);
+
+  for (i = 0, p = contents; i < (end - begin); ++i, p += 2)
+    sprintf (p, "%02x", data[i]);
+  ui_out_field_string (uiout, "contents", contents);
+  xfree (contents);
+  do_cleanups (t);
+}
+
+/* Memory ranges requested by -data-read-batch that are separated by
+   at most this many bytes are read with a single transfer.  Reading
+   a few unneeded bytes is much cheaper than another round trip to a
+   remote target.  */
+
+#define DATA_READ_BATCH_GAP 64
+
+/* Read the memory ranges in RANGES, which must be sorted and must not
+   overlap, merging the ranges that are close to each other so that
+   each group is read with a single transfer.  Return the readable
+   blocks, sorted by address.  */
+
+static VEC(memory_read_result_s) *
+read_memory_ranges (VEC(mem_range_s) *ranges)
+{
+  VEC(memory_read_result_s) *result = NULL;
+  struct mem_range *r;
+  int ix = 0;
+
+  while (VEC_iterate (mem_range_s, ranges, ix, r))
+    {
+      VEC(memory_read_result_s) *span;
+      CORE_ADDR start = r->start;
+      CORE_ADDR end = r->start + r->length;
+      memory_read_result_s *block;
+      int j;
+
+      for (ix++; VEC_iterate (mem_range_s, ranges, ix, r); ix++)
+	{
+	  if (r->start - end > DATA_READ_BATCH_GAP)
+	    break;
+	  end = r->start + r->length;
+	}
+
+      span = read_memory_robust (current_target.beneath, start, end - start);
+      for (j = 0; VEC_iterate (memory_read_result_s, span, j, block); j++)
+	VEC_safe_push (memory_read_result_s, result, block);
+      VEC_free (memory_read_result_s, span);
+    }
 
-      ui_out_field_core_addr (uiout, "begin", gdbarch, read_result->begin);
-      ui_out_field_core_addr (uiout, "offset", gdbarch, read_result->begin
-			      - addr);
-      ui_out_field_core_addr (uiout, "end", gdbarch, read_result->end);
+  return result;
+}
+
+/* Implementation of the -data-read-batch command.
+
+   -data-read-batch [ --format FORMAT ]
+		    [ --memory ADDR LENGTH ]...
+		    [ --registers THREAD REGNUMS ]...
 
-      data = xmalloc ((read_result->end - read_result->begin) * 2 + 1);
+   Read several memory ranges, and the registers of several threads,
+   and report them all in a single result record.  REGNUMS is a
+   space-separated list of register numbers; if it is empty, all the
+   registers of THREAD are listed.  FORMAT is the format of the
+   register values, as for -data-list-register-values; it defaults to
+   'x'.
 
-      for (i = 0, p = data;
-	   i < (read_result->end - read_result->begin);
-	   ++i, p += 2)
+   All the memory ranges are read before any output is produced.
+   Nearby ranges are merged, so that several small ranges cost a single
+   transfer.  */
+
+void
+mi_cmd_data_read_batch (char *command, char **argv, int argc)
+{
+  struct gdbarch *gdbarch = get_current_arch ();
+  struct ui_out *uiout = current_uiout;
+  struct cleanup *cleanups, *list_cleanup;
+  VEC(mem_range_s) *requests = NULL;
+  VEC(mem_range_s) *ranges;
+  VEC(memory_read_result_s) *blocks;
+  struct mem_range *r;
+  int format = 'x';
+  int i, ix;
+
+  cleanups = make_cleanup (VEC_cleanup (mem_range_s), &requests);
+
+  /* Parse and validate all the arguments before reading anything.  */
+  for (i = 0; i < argc; i++)
+    {
+      if (strcmp (argv[i], "--format") == 0 && i + 1 < argc)
+	format = argv[++i][0];
+      else if (strcmp (argv[i], "--memory") == 0 && i + 2 < argc)
 	{
-	  sprintf (p, "%02x", read_result->data[i]);
+	  struct mem_range range;
+	  LONGEST length;
+
+	  range.start = parse_and_eval_address (argv[i + 1]);
+	  length = atol (argv[i + 2]);
+	  if (length <= 0 || length > INT_MAX)
+	    error (_("-data-read-batch: Invalid length: %s"), argv[i + 2]);
+	  range.length = length;
+	  VEC_safe_push (mem_range_s, requests, &range);
+	  i += 2;
 	}
-      ui_out_field_string (uiout, "contents", data);
-      xfree (data);
-      do_cleanups (t);
+      else if (strcmp (argv[i], "--registers") == 0 && i + 2 < argc)
+	i += 2;
+      else
+	error (_("-data-read-batch: Usage: [--format FORMAT] "
+		 "[--memory ADDR LENGTH]... [--registers THREAD REGNUMS]..."));
+    }
+
+  /* Read all the requested memory, merging the ranges that overlap or
+     are close to each other.  */
+  ranges = VEC_copy (mem_range_s, requests);
+  make_cleanup (VEC_cleanup (mem_range_s), &ranges);
+  normalize_mem_ranges (ranges);
+  blocks = read_memory_ranges (ranges);
+  make_cleanup (free_memory_read_result_vector, blocks);
+
+  /* Report the readable parts of each range, in the requested
+     order.  */
+  list_cleanup = make_cleanup_ui_out_list_begin_end (uiout, "memory");
+  for (ix = 0; VEC_iterate (mem_range_s, requests, ix, r); ix++)
+    {
+      struct cleanup *tuple_cleanup;
+      memory_read_result_s *block;
+      CORE_ADDR end = r->start + r->length;
+      int j;
+
+      tuple_cleanup = make_cleanup_ui_out_tuple_begin_end (uiout, NULL);
+      ui_out_field_core_addr (uiout, "addr", gdbarch, r->start);
+      ui_out_field_int (uiout, "length", r->length);
+      make_cleanup_ui_out_list_begin_end (uiout, "blocks");
+      for (j = 0;
+	   VEC_iterate (memory_read_result_s, blocks, j, block);
+	   j++)
+	{
+	  CORE_ADDR begin = max (block->begin, r->start);
+	  CORE_ADDR block_end = min (block->end, end);
+
+	  if (begin < block_end)
+	    output_memory_block (gdbarch, r->start, begin, block_end,
+				 block->data + (begin - block->begin));
+	}
+      do_cleanups (tuple_cleanup);
+    }
+  do_cleanups (list_cleanup);
+
+  /* Report the registers of each thread, switching threads as
+     needed.  A thread that is already selected keeps its selected
+     frame.  */
+  list_cleanup = make_cleanup_ui_out_list_begin_end (uiout, "registers");
+  make_cleanup_restore_current_thread ();
+  for (i = 0; i < argc; i++)
+    {
+      struct cleanup *tuple_cleanup;
+      struct thread_info *tp;
+      char **regs;
+      int num, nregs;
+
+      if (strcmp (argv[i], "--registers") != 0)
+	{
+	  if (strcmp (argv[i], "--format") == 0)
+	    i++;
+	  else if (strcmp (argv[i], "--memory") == 0)
+	    i += 2;
+	  continue;
+	}
+
+      num = atoi (argv[i + 1]);
+      tp = find_thread_id (num);
+      if (tp == NULL)
+	error (_("Invalid thread id: %d"), num);
+      if (is_exited (tp->ptid))
+	error (_("Thread id: %d has terminated"), num);
+      if (is_running (tp->ptid))
+	error (_("Thread id: %d is running"), num);
+      switch_to_thread (tp->ptid);
+
+      if (*skip_spaces (argv[i + 2]) != '\0')
+	{
+	  regs = gdb_buildargv (argv[i + 2]);
+	  make_cleanup_freeargv (regs);
+	  nregs = countargv (regs);
+	}
+      else
+	{
+	  regs = NULL;
+	  nregs = 0;
+	}
+
+      tuple_cleanup = make_cleanup_ui_out_tuple_begin_end (uiout, NULL);
+      ui_out_field_int (uiout, "thread-id", num);
+      output_register_values (get_selected_frame (NULL), format,
+			      regs, nregs);
+      do_cleanups (tuple_cleanup);
+      i += 2;
     }
+  do_cleanups (list_cleanup);
+
   do_cleanups (cleanups);
 }
 
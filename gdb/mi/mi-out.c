@@ -224,11 +224,14 @@ mi_field_string (struct ui_out *uiout, int fldno, int width,
 
   field_separator (uiout);
   if (fldname)
-    fprintf_unfiltered (data->buffer, "%s=", fldname);
-  fprintf_unfiltered (data->buffer, "\"");
+    {
+      fputs_unfiltered (fldname, data->buffer);
+      fputc_unfiltered ('=', data->buffer);
+    }
+  fputc_unfiltered ('"', data->buffer);
   if (string)
     fputstr_unfiltered (string, '"', data->buffer);
-  fprintf_unfiltered (data->buffer, "\"");
+  fputc_unfiltered ('"', data->buffer);
 }
 
 /* This is the only field function that does not align.  */
@@ -324,7 +327,10 @@ mi_open (struct ui_out *uiout, const char *name, enum ui_out_type type)
   field_separator (uiout);
   data->suppress_field_separator = 1;
   if (name)
-    fprintf_unfiltered (data->buffer, "%s=", name);
+    {
+      fputs_unfiltered (name, data->buffer);
+      fputc_unfiltered ('=', data->buffer);
+    }
   switch (type)
     {
     case ui_out_type_tuple:
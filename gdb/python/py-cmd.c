@@ -143,6 +143,10 @@ cmdpy_function (struct cmd_list_element *command, char *args, int from_tty)
       error (_("Could not convert arguments to Python string."));
     }
 
+  /* The command may change what the pretty-printers do, as "enable
+     pretty-printer" does.  */
+  gdbpy_invalidate_pretty_printer_cache ();
+
   ttyobj = from_tty ? Py_True : Py_False;
   Py_INCREF (ttyobj);
   result = PyObject_CallMethodObjArgs ((PyObject *) obj, invoke_cst, argobj,
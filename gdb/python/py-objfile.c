@@ -196,6 +196,8 @@ py_free_objfile (struct objfile *objfile, void *datum)
   objfile_object *object = datum;
 
   cleanup = ensure_python_env (get_objfile_arch (objfile), current_language);
+  /* The cache of pretty-printers refers to the objfile's types.  */
+  gdbpy_invalidate_pretty_printer_cache ();
   object->objfile = NULL;
   Py_DECREF ((PyObject *) object);
   do_cleanups (cleanup);
@@ -23,6 +23,8 @@
 #include "symtab.h"
 #include "language.h"
 #include "valprint.h"
+#include "gdbcmd.h"
+#include "hashtab.h"
 
 #include "python.h"
 
@@ -41,24 +43,119 @@ enum string_repr_result
     string_repr_ok
   };
 
-/* Helper function for find_pretty_printer which iterates over a list,
-   calls each function and inspects output.  This will return a
-   printer object if one recognizes VALUE.  If no printer is found, it
-   will return None.  On error, it will set the Python error and
-   return NULL.  */
+/* Looking up the pretty-printer for a value means calling every
+   enabled lookup function of every objfile, of the program space, and
+   of the gdb module, until one returns a printer.  Printing a large
+   array or container calls them for each element, so we remember, for
+   each type, which lookup function returned a printer for a value of
+   that type, or that none did.
 
-static PyObject *
-search_pp_list (PyObject *list, PyObject *value)
+   This relies on the lookup functions only looking at the type of the
+   value, as they are expected to.  The cache is emptied whenever the
+   sequence of enabled lookup functions changes, and when Python code
+   that may have changed what they do was run, such as the "python"
+   command or the "enable pretty-printer" command.  */
+
+struct pp_cache_entry
+{
+  /* The type of the values looked up.  */
+  struct type *type;
+
+  /* The lookup function that returned a printer for them, or NULL if
+     none did.  A borrowed reference, owned by pp_cache_functions.  */
+  PyObject *function;
+};
+
+/* Map from types to struct pp_cache_entry.  */
+static htab_t pp_cache;
+
+/* The enabled lookup functions, in the order they are called, when
+   the cache was filled.  New references.  */
+static PyObject **pp_cache_functions;
+static int pp_cache_functions_count;
+
+/* Non-zero if the cache must be emptied before it is used again.  */
+static int pp_cache_stale;
+
+/* Incremented each time the cache is emptied.  */
+static unsigned int pp_cache_generation;
+
+/* Statistics for "maint info pretty-printer-cache".  */
+static unsigned int pp_cache_hits;
+static unsigned int pp_cache_misses;
+
+static hashval_t
+hash_pp_cache_entry (const void *p)
+{
+  const struct pp_cache_entry *entry = p;
+
+  return htab_hash_pointer (entry->type);
+}
+
+static int
+eq_pp_cache_entry (const void *a, const void *b)
+{
+  const struct pp_cache_entry *ea = a;
+  const struct pp_cache_entry *eb = b;
+
+  return ea->type == eb->type;
+}
+
+/* See python-internal.h.  */
+
+void
+gdbpy_invalidate_pretty_printer_cache (void)
+{
+  pp_cache_stale = 1;
+}
+
+/* Empty the cache, for the COUNT enabled lookup functions in
+   FUNCTIONS.  */
+
+static void
+reset_pp_cache (PyObject **functions, int count)
+{
+  int i;
+
+  if (pp_cache != NULL)
+    htab_empty (pp_cache);
+  else
+    pp_cache = htab_create_alloc (127, hash_pp_cache_entry,
+				  eq_pp_cache_entry, xfree,
+				  xcalloc, xfree);
+
+  for (i = 0; i < pp_cache_functions_count; i++)
+    Py_DECREF (pp_cache_functions[i]);
+  pp_cache_functions = xrealloc (pp_cache_functions,
+				 count * sizeof (PyObject *));
+  for (i = 0; i < count; i++)
+    {
+      Py_INCREF (functions[i]);
+      pp_cache_functions[i] = functions[i];
+    }
+  pp_cache_functions_count = count;
+
+  pp_cache_stale = 0;
+  pp_cache_generation++;
+}
+
+/* Append the enabled lookup functions of LIST to the array *FUNCTIONS
+   of *COUNT elements, with room for *SIZE, as new references.  Return
+   0 on success.  On error, set the Python error and return -1.  */
+
+static int
+collect_pp_functions (PyObject *list, PyObject ***functions,
+		      int *count, int *size)
 {
   Py_ssize_t pp_list_size, list_index;
-  PyObject *function, *printer = NULL;
+  PyObject *function;
 
   pp_list_size = PyList_Size (list);
   for (list_index = 0; list_index < pp_list_size; list_index++)
     {
       function = PyList_GetItem (list, list_index);
       if (! function)
-	return NULL;
+	return -1;
 
       /* Skip if disabled.  */
       if (PyObject_HasAttr (function, gdbpy_enabled_cst))
@@ -67,43 +164,49 @@ search_pp_list (PyObject *list, PyObject *value)
 	  int cmp;
 
 	  if (!attr)
-	    return NULL;
+	    return -1;
 	  cmp = PyObject_IsTrue (attr);
+	  Py_DECREF (attr);
 	  if (cmp == -1)
-	    return NULL;
+	    return -1;
 
 	  if (!cmp)
 	    continue;
 	}
 
-      printer = PyObject_CallFunctionObjArgs (function, value, NULL);
-      if (! printer)
-	return NULL;
-      else if (printer != Py_None)
-	return printer;
-
-      Py_DECREF (printer);
+      if (*count == *size)
+	{
+	  *size = *size ? 2 * *size : 16;
+	  *functions = xrealloc (*functions, *size * sizeof (PyObject *));
+	}
+      Py_INCREF (function);
+      (*functions)[(*count)++] = function;
     }
 
-  Py_RETURN_NONE;
+  return 0;
 }
 
-/* Subroutine of find_pretty_printer to simplify it.
-   Look for a pretty-printer to print VALUE in all objfiles.
-   The result is NULL if there's an error and the search should be terminated.
-   The result is Py_None, suitably inc-ref'd, if no pretty-printer was found.
-   Otherwise the result is the pretty-printer function, suitably inc-ref'd.  */
+/* Subroutine of find_pretty_printer to simplify it.  Store in
+   *FUNCTIONS a new array with new references to the enabled lookup
+   functions, in the order they are to be called: those of each
+   objfile in the current program space, those of the program space,
+   and those of the gdb module.  Return their number, or -1 and set
+   the Python error if there's an error and the search should be
+   terminated.  */
 
-static PyObject *
-find_pretty_printer_from_objfiles (PyObject *value)
+static int
+find_pretty_printer_functions (PyObject ***functions)
 {
   PyObject *pp_list;
-  PyObject *function;
-  struct objfile *obj;
+  PyObject *obj;
+  struct objfile *objfile;
+  int count = 0, size = 0, i;
 
-  ALL_OBJFILES (obj)
+  *functions = NULL;
+
+  ALL_OBJFILES (objfile)
   {
-    PyObject *objf = objfile_to_objfile_object (obj);
+    PyObject *objf = objfile_to_objfile_object (objfile);
     if (!objf)
       {
 	/* Ignore the error and continue.  */
@@ -112,69 +215,97 @@ find_pretty_printer_from_objfiles (PyObject *value)
       }
 
     pp_list = objfpy_get_printers (objf, NULL);
-    function = search_pp_list (pp_list, value);
-    Py_XDECREF (pp_list);
+    if (pp_list == NULL
+	|| collect_pp_functions (pp_list, functions, &count, &size) < 0)
+      {
+	Py_XDECREF (pp_list);
+	goto fail;
+      }
+    Py_DECREF (pp_list);
+  }
 
-    /* If there is an error in any objfile list, abort the search and exit.  */
-    if (! function)
-      return NULL;
+  obj = pspace_to_pspace_object (current_program_space);
+  if (!obj)
+    goto fail;
+  pp_list = pspy_get_printers (obj, NULL);
+  if (pp_list == NULL
+      || collect_pp_functions (pp_list, functions, &count, &size) < 0)
+    {
+      Py_XDECREF (pp_list);
+      goto fail;
+    }
+  Py_DECREF (pp_list);
 
-    if (function != Py_None)
-      return function;
-    
-    Py_DECREF (function);
-  }
+  /* Fetch the global pretty printer list.  */
+  if (gdb_python_module == NULL
+      || ! PyObject_HasAttrString (gdb_python_module, "pretty_printers"))
+    return count;
+  pp_list = PyObject_GetAttrString (gdb_python_module, "pretty_printers");
+  if (pp_list == NULL || ! PyList_Check (pp_list))
+    {
+      Py_XDECREF (pp_list);
+      PyErr_Clear ();
+      return count;
+    }
+  if (collect_pp_functions (pp_list, functions, &count, &size) < 0)
+    {
+      Py_DECREF (pp_list);
+      goto fail;
+    }
+  Py_DECREF (pp_list);
 
-  Py_RETURN_NONE;
+  return count;
+
+ fail:
+  for (i = 0; i < count; i++)
+    Py_DECREF ((*functions)[i]);
+  xfree (*functions);
+  *functions = NULL;
+  return -1;
 }
 
-/* Subroutine of find_pretty_printer to simplify it.
-   Look for a pretty-printer to print VALUE in the current program space.
-   The result is NULL if there's an error and the search should be terminated.
-   The result is Py_None, suitably inc-ref'd, if no pretty-printer was found.
-   Otherwise the result is the pretty-printer function, suitably inc-ref'd.  */
+/* Release the COUNT references in FUNCTIONS, and the array.  */
 
-static PyObject *
-find_pretty_printer_from_progspace (PyObject *value)
+static void
+free_pp_functions (PyObject **functions, int count)
 {
-  PyObject *pp_list;
-  PyObject *function;
-  PyObject *obj = pspace_to_pspace_object (current_program_space);
+  int i;
 
-  if (!obj)
-    return NULL;
-  pp_list = pspy_get_printers (obj, NULL);
-  function = search_pp_list (pp_list, value);
-  Py_XDECREF (pp_list);
-  return function;
+  for (i = 0; i < count; i++)
+    Py_DECREF (functions[i]);
+  xfree (functions);
 }
 
-/* Subroutine of find_pretty_printer to simplify it.
-   Look for a pretty-printer to print VALUE in the gdb module.
-   The result is NULL if there's an error and the search should be terminated.
-   The result is Py_None, suitably inc-ref'd, if no pretty-printer was found.
-   Otherwise the result is the pretty-printer function, suitably inc-ref'd.  */
+/* Call the COUNT lookup functions in FUNCTIONS on VALUE, until one
+   returns a printer.  Return it as a new reference, and set *FUNCTION
+   to the function that returned it.  If none did, return None,
+   suitably inc-ref'd, and set *FUNCTION to NULL.  On error, set the
+   Python error and return NULL.  */
 
 static PyObject *
-find_pretty_printer_from_gdb (PyObject *value)
+search_pp_functions (PyObject **functions, int count, PyObject *value,
+		     PyObject **function)
 {
-  PyObject *pp_list;
-  PyObject *function;
+  int i;
 
-  /* Fetch the global pretty printer list.  */
-  if (gdb_python_module == NULL
-      || ! PyObject_HasAttrString (gdb_python_module, "pretty_printers"))
-    Py_RETURN_NONE;
-  pp_list = PyObject_GetAttrString (gdb_python_module, "pretty_printers");
-  if (pp_list == NULL || ! PyList_Check (pp_list))
+  for (i = 0; i < count; i++)
     {
-      Py_XDECREF (pp_list);
-      Py_RETURN_NONE;
+      PyObject *printer;
+
+      printer = PyObject_CallFunctionObjArgs (functions[i], value, NULL);
+      if (! printer)
+	return NULL;
+      else if (printer != Py_None)
+	{
+	  *function = functions[i];
+	  return printer;
+	}
+
+      Py_DECREF (printer);
     }
 
-  function = search_pp_list (pp_list, value);
-  Py_XDECREF (pp_list);
-  return function;
+  *function = NULL;
+  Py_RETURN_NONE;
 }
 
 /* Find the pretty-printing constructor function for VALUE.  If no
@@ -184,24 +315,66 @@ find_pretty_printer_from_gdb (PyObject *value)
 static PyObject *
 find_pretty_printer (PyObject *value)
 {
-  PyObject *function;
+  PyObject **functions;
+  PyObject *function, *printer;
+  struct pp_cache_entry entry, *found, **slot;
+  unsigned int generation;
+  int count;
+
+  count = find_pretty_printer_functions (&functions);
+  if (count < 0)
+    return NULL;
+
+  /* Start over if the lookup functions changed since the cache was
+     filled.  */
+  if (pp_cache == NULL || pp_cache_stale
+      || count != pp_cache_functions_count
+      || (count > 0 && memcmp (functions, pp_cache_functions,
+			       count * sizeof (PyObject *)) != 0))
+    reset_pp_cache (functions, count);
+
+  /* The lookup functions may look up printers themselves, changing
+     the cache; FUNCTIONS holds its own references.  */
+  generation = pp_cache_generation;
+
+  entry.type = value_type (value_object_to_value (value));
+  found = htab_find (pp_cache, &entry);
+  if (found != NULL)
+    {
+      pp_cache_hits++;
+      if (found->function == NULL)
+	{
+	  free_pp_functions (functions, count);
+	  Py_RETURN_NONE;
+	}
+
+      printer = PyObject_CallFunctionObjArgs (found->function, value, NULL);
+      if (printer == NULL || printer != Py_None)
+	{
+	  free_pp_functions (functions, count);
+	  return printer;
+	}
+
+      /* The function doesn't want this value after all; look again.  */
+      Py_DECREF (printer);
+    }
+  else
+    pp_cache_misses++;
+
+  printer = search_pp_functions (functions, count, value, &function);
+  if (printer != NULL && generation == pp_cache_generation
+      && !pp_cache_stale)
+    {
+      slot = (struct pp_cache_entry **) htab_find_slot (pp_cache, &entry,
+							INSERT);
+      if (*slot == NULL)
+	*slot = XNEW (struct pp_cache_entry);
+      (*slot)->type = entry.type;
+      (*slot)->function = function;
+    }
 
-  /* Look at the pretty-printer list for each objfile
-     in the current program-space.  */
-  function = find_pretty_printer_from_objfiles (value);
-  if (function == NULL || function != Py_None)
-    return function;
-  Py_DECREF (function);
-
-  /* Look at the pretty-printer list for the current program-space.  */
-  function = find_pretty_printer_from_progspace (value);
-  if (function == NULL || function != Py_None)
-    return function;
-  Py_DECREF (function);
-
-  /* Look at the pretty-printer list in the gdb module.  */
-  function = find_pretty_printer_from_gdb (value);
-  return function;
+  free_pp_functions (functions, count);
+  return printer;
 }
 
 /* Pretty-print a single value, via the printer object PRINTER.
@@ -466,6 +639,139 @@ push_dummy_python_frame (void)
 }
 #endif
 
+/* The most children print_children fetches from the iterator ahead
+   of printing them.  */
+#define MAX_CHILDREN_AHEAD 1024
+
+/* Children fetched from a children iterator ahead of printing them,
+   so that the values among them that follow each other in memory,
+   such as the elements of a container, are read from the inferior
+   together.  */
+
+struct children_ahead
+{
+  /* The iterator.  */
+  PyObject *iter;
+
+  /* A list of the children fetched, or NULL.  */
+  PyObject *items;
+
+  /* The index in ITEMS of the next child to return.  */
+  Py_ssize_t next;
+
+  /* Non-zero once the iterator is exhausted or failed.  */
+  int done;
+
+  /* If the iterator failed, the Python error, to report once the
+     children fetched before it are printed.  */
+  PyObject *error_type, *error_value, *error_traceback;
+};
+
+/* A cleanup function for struct children_ahead.  */
+
+static void
+free_children_ahead (void *arg)
+{
+  struct children_ahead *ahead = arg;
+
+  Py_XDECREF (ahead->items);
+  Py_XDECREF (ahead->error_type);
+  Py_XDECREF (ahead->error_value);
+  Py_XDECREF (ahead->error_traceback);
+}
+
+/* Fetch up to COUNT children from the iterator of AHEAD, and the
+   contents of the values among them.  Return 0 on success.  On error,
+   set the Python error and return -1.  */
+
+static int
+fill_children_ahead (struct children_ahead *ahead, unsigned int count)
+{
+  struct value **values;
+  struct cleanup *cleanup;
+  int n_values = 0;
+
+  Py_XDECREF (ahead->items);
+  ahead->next = 0;
+  ahead->items = PyList_New (0);
+  if (ahead->items == NULL)
+    return -1;
+
+  values = XNEWVEC (struct value *, count);
+  cleanup = make_cleanup (xfree, values);
+
+  while (PyList_GET_SIZE (ahead->items) < count)
+    {
+      PyObject *item = PyIter_Next (ahead->iter);
+
+      if (item == NULL)
+	{
+	  ahead->done = 1;
+	  if (PyErr_Occurred ())
+	    PyErr_Fetch (&ahead->error_type, &ahead->error_value,
+			 &ahead->error_traceback);
+	  break;
+	}
+
+      if (PyList_Append (ahead->items, item) < 0)
+	{
+	  Py_DECREF (item);
+	  do_cleanups (cleanup);
+	  return -1;
+	}
+
+      if (PyTuple_Check (item) && PyTuple_Size (item) == 2)
+	{
+	  PyObject *py_v = PyTuple_GET_ITEM (item, 1);
+
+	  if (PyObject_TypeCheck (py_v, &value_object_type))
+	    values[n_values++] = value_object_to_value (py_v);
+	}
+      Py_DECREF (item);
+    }
+
+  value_prefetch_lazy (values, n_values);
+
+  do_cleanups (cleanup);
+  return 0;
+}
+
+/* Return the next child of AHEAD as a new reference, fetching up to
+   COUNT more children from the iterator if needed.  Return NULL when
+   there are no more children, with the Python error set if the
+   iterator failed.  */
+
+static PyObject *
+next_child (struct children_ahead *ahead, unsigned int count)
+{
+  PyObject *item;
+
+  while (ahead->items == NULL
+	 || ahead->next == PyList_GET_SIZE (ahead->items))
+    {
+      if (ahead->done)
+	{
+	  if (ahead->error_type != NULL)
+	    {
+	      PyErr_Restore (ahead->error_type, ahead->error_value,
+			     ahead->error_traceback);
+	      ahead->error_type = NULL;
+	      ahead->error_value = NULL;
+	      ahead->error_traceback = NULL;
+	    }
+	  return NULL;
+	}
+
+      if (fill_children_ahead (ahead, count) < 0)
+	return NULL;
+    }
+
+  item = PyList_GET_ITEM (ahead->items, ahead->next);
+  ahead->next++;
+  Py_INCREF (item);
+  return item;
+}
+
 /* Helper for apply_val_pretty_printer that formats children of the
    printer, if any exist.  If is_py_none is true, then nothing has
    been printed by to_string, and format output accordingly. */
@@ -479,6 +785,7 @@ print_children (PyObject *printer, const char *hint,
   int is_map, is_array, done_flag, pretty;
   unsigned int i;
   PyObject *children, *iter;
+  struct children_ahead ahead;
 #ifndef IS_PY3K
   PyObject *frame;
 #endif
@@ -510,6 +817,10 @@ print_children (PyObject *printer, const char *hint,
     }
   make_cleanup_py_decref (iter);
 
+  memset (&ahead, 0, sizeof (ahead));
+  ahead.iter = iter;
+  make_cleanup (free_children_ahead, &ahead);
+
   /* Use the prettyprint_arrays option if we are printing an array,
      and the pretty option otherwise.  */
   if (is_array)
@@ -538,9 +849,18 @@ print_children (PyObject *printer, const char *hint,
   done_flag = 0;
   for (i = 0; i < options->print_max; ++i)
     {
-      PyObject *py_v, *item = PyIter_Next (iter);
+      PyObject *py_v, *item;
       const char *name;
       struct cleanup *inner_cleanup;
+      unsigned int count;
+
+      /* Fetch the children that are to be printed at once, except in
+	 summary mode, which only prints whether there is one.  */
+      if (options->summary)
+	count = 1;
+      else
+	count = min (options->print_max - i, MAX_CHILDREN_AHEAD);
+      item = next_child (&ahead, count);
 
       if (! item)
 	{
@@ -833,6 +1153,27 @@ gdbpy_default_visualizer (PyObject *self, PyObject *args)
   return cons;
 }
 
+/* Implement "maint info pretty-printer-cache".  */
+
+static void
+maintenance_info_pretty_printer_cache (char *args, int from_tty)
+{
+  printf_filtered (_("Pretty-printer lookups: %u found in the cache, "
+		     "%u not.\n"), pp_cache_hits, pp_cache_misses);
+  printf_filtered (_("Types in the cache: %lu.\n"),
+		   pp_cache != NULL
+		   ? (unsigned long) htab_elements (pp_cache) : 0);
+}
+
+void
+gdbpy_initialize_pretty_printers (void)
+{
+  add_cmd ("pretty-printer-cache", class_maintenance,
+	   maintenance_info_pretty_printer_cache, _("\
+Print statistics about the cache of pretty-printer lookups."),
+	   &maintenanceinfolist);
+}
+
 #else /* HAVE_PYTHON */
 
 int
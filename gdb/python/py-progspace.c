@@ -191,6 +191,7 @@ py_free_pspace (struct program_space *pspace, void *datum)
   struct gdbarch *arch = get_current_arch ();
 
   cleanup = ensure_python_env (arch, current_language);
+  gdbpy_invalidate_pretty_printer_cache ();
   object->pspace = NULL;
   Py_DECREF ((PyObject *) object);
   do_cleanups (cleanup);
@@ -302,6 +302,7 @@ void gdbpy_initialize_exited_event (void);
 void gdbpy_initialize_thread_event (void);
 void gdbpy_initialize_new_objfile_event (void);
 void gdbpy_initialize_arch (void);
+void gdbpy_initialize_pretty_printers (void);
 
 struct cleanup *make_cleanup_py_decref (PyObject *py);
 
@@ -360,6 +361,10 @@ PyObject *gdbpy_get_varobj_pretty_printer (struct value *value);
 char *gdbpy_get_display_hint (PyObject *printer);
 PyObject *gdbpy_default_visualizer (PyObject *self, PyObject *args);
 
+/* Forget the pretty-printer found for each type, because Python code
+   that may have changed the lookup functions ran.  */
+void gdbpy_invalidate_pretty_printer_cache (void);
+
 void bpfinishpy_pre_stop_hook (struct breakpoint_object *bp_obj);
 void bpfinishpy_post_stop_hook (struct breakpoint_object *bp_obj);
 
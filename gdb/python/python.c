@@ -226,6 +226,7 @@ python_interactive_command (char *arg, int from_tty)
   arg = skip_spaces (arg);
 
   ensure_python_env (get_current_arch (), current_language);
+  gdbpy_invalidate_pretty_printer_cache ();
 
   if (arg && *arg)
     {
@@ -272,6 +273,8 @@ python_interactive_command (char *arg, int from_tty)
 static void
 python_run_simple_file (FILE *file, const char *filename)
 {
+  gdbpy_invalidate_pretty_printer_cache ();
+
 #ifndef _WIN32
 
   PyRun_SimpleFile (file, filename);
@@ -345,6 +348,7 @@ eval_python_from_control_command (struct command_line *cmd)
     error (_("Invalid \"python\" block structure."));
 
   cleanup = ensure_python_env (get_current_arch (), current_language);
+  gdbpy_invalidate_pretty_printer_cache ();
 
   script = compute_python_string (cmd->body_list[0]);
   ret = PyRun_SimpleString (script);
@@ -363,6 +367,7 @@ python_command (char *arg, int from_tty)
   struct cleanup *cleanup;
 
   cleanup = ensure_python_env (get_current_arch (), current_language);
+  gdbpy_invalidate_pretty_printer_cache ();
 
   make_cleanup_restore_integer (&interpreter_async);
   interpreter_async = 0;
@@ -1631,6 +1636,7 @@ message == an error message without a stack will be printed."),
   gdbpy_initialize_thread_event ();
   gdbpy_initialize_new_objfile_event () ;
   gdbpy_initialize_arch ();
+  gdbpy_initialize_pretty_printers ();
 
   observer_attach_before_prompt (before_prompt_hook);
 
@@ -44,6 +44,7 @@
 #include "cli/cli-setshow.h"
 #include "target-descriptions.h"
 #include "gdb_bfd.h"
+#include "elf-bfd.h"
 
 #include <ctype.h>
 #include <sys/time.h>
@@ -241,6 +242,8 @@ static int remote_supports_cond_breakpoints (void);
 
 static int remote_can_run_breakpoint_commands (void);
 
+static void readahead_cache_invalidate_fd (int fd);
+
 /* For "remote".  */
 
 static struct cmd_list_element *remote_cmdlist;
@@ -345,8 +348,59 @@ struct remote_state
   /* Nonzero if the user has pressed Ctrl-C, but the target hasn't
      responded to that.  */
   int ctrlc_pending_p;
+
+  /* The remote thread list generation GDB's thread list was last
+     synchronized with, if the stub supports incremental thread list
+     updates.  Zero means we need the whole list.  */
+  ULONGEST threads_generation;
+};
+
+/* A block of a remote file read ahead of time by vFile:pread
+   requests sent back-to-back, to save round trips when reading a file
+   sequentially.  */
+
+struct readahead_cache
+{
+  /* The remote file descriptor the cached data belongs to, or -1 if
+     the cache is empty.  */
+  int fd;
+
+  /* The file offset of the first byte of BUF.  */
+  ULONGEST offset;
+
+  /* The data read, and how many bytes of it are valid.  */
+  gdb_byte *buf;
+  size_t bufsize;
+
+  /* The file descriptor and end offset of the last read served, used
+     to detect sequential access.  */
+  int last_fd;
+  ULONGEST last_end;
 };
 
+static struct readahead_cache readahead_cache = { -1, 0, NULL, 0, -1, 0 };
+
+/* Maximum number of vFile:pread requests in flight at once when
+   reading ahead.  Zero or one disables reading ahead.  */
+
+static unsigned int remote_file_read_ahead = 8;
+
+/* The value the user set with "set remote file-read-ahead", checked
+   against REMOTE_FILE_READ_AHEAD_MAX before it is used.  */
+
+static unsigned int remote_file_read_ahead_1 = 8;
+
+/* Upper limit for "set remote file-read-ahead".  This bounds both the
+   size of the read-ahead buffer and the burst of requests sent to the
+   stub at once.  */
+
+#define REMOTE_FILE_READ_AHEAD_MAX 64
+
+/* Directory where copies of remote files are kept, keyed by build ID,
+   or NULL if remote files should not be cached locally.  */
+
+static char *remote_file_cache_directory;
+
 /* Private data that we'll store in (struct thread_info)->private.  */
 struct private_thread_info
 {
@@ -437,6 +491,61 @@ trace_error (char *buf)
     }
 }
 
+/* Handle a qRelocInsn request from the stub, which is in *BUF_P, and
+   send back the reply.  */
+
+static void
+remote_relocate_insn_request (char **buf_p, long *sizeof_buf)
+{
+  char *buf = *buf_p;
+  ULONGEST ul;
+  CORE_ADDR from, to, org_to;
+  char *p, *pp;
+  int adjusted_size = 0;
+  volatile struct gdb_exception ex;
+
+  p = buf + strlen ("qRelocInsn:");
+  pp = unpack_varlen_hex (p, &ul);
+  if (*pp != ';')
+    error (_("invalid qRelocInsn packet: %s"), buf);
+  from = ul;
+
+  p = pp + 1;
+  unpack_varlen_hex (p, &ul);
+  to = ul;
+
+  org_to = to;
+
+  TRY_CATCH (ex, RETURN_MASK_ALL)
+    {
+      gdbarch_relocate_instruction (target_gdbarch (), &to, from);
+    }
+  if (ex.reason >= 0)
+    {
+      adjusted_size = to - org_to;
+
+      xsnprintf (buf, *sizeof_buf, "qRelocInsn:%x", adjusted_size);
+      putpkt (buf);
+    }
+  else if (ex.reason < 0 && ex.error == MEMORY_ERROR)
+    {
+      /* Propagate memory errors silently back to the target.
+	 The stub may have limited the range of addresses we
+	 can write to, for example.  */
+      putpkt ("E01");
+    }
+  else
+    {
+      /* Something unexpectedly bad happened.  Be verbose so
+	 we can tell what, and propagate the error back to the
+	 stub, so it doesn't get stuck waiting for a
+	 response.  */
+      exception_fprintf (gdb_stderr, ex,
+			 _("warning: relocating instruction: "));
+      putpkt ("E01");
+    }
+}
+
 /* Utility: wait for reply from stub, while accepting "O" packets.  */
 static char *
 remote_get_noisy_reply (char **buf_p,
@@ -452,54 +561,7 @@ remote_get_noisy_reply (char **buf_p,
       if (buf[0] == 'E')
 	trace_error (buf);
       else if (strncmp (buf, "qRelocInsn:", strlen ("qRelocInsn:")) == 0)
-	{
-	  ULONGEST ul;
-	  CORE_ADDR from, to, org_to;
-	  char *p, *pp;
-	  int adjusted_size = 0;
-	  volatile struct gdb_exception ex;
-
-	  p = buf + strlen ("qRelocInsn:");
-	  pp = unpack_varlen_hex (p, &ul);
-	  if (*pp != ';')
-	    error (_("invalid qRelocInsn packet: %s"), buf);
-	  from = ul;
-
-	  p = pp + 1;
-	  unpack_varlen_hex (p, &ul);
-	  to = ul;
-
-	  org_to = to;
-
-	  TRY_CATCH (ex, RETURN_MASK_ALL)
-	    {
-	      gdbarch_relocate_instruction (target_gdbarch (), &to, from);
-	    }
-	  if (ex.reason >= 0)
-	    {
-	      adjusted_size = to - org_to;
-
-	      xsnprintf (buf, *sizeof_buf, "qRelocInsn:%x", adjusted_size);
-	      putpkt (buf);
-	    }
-	  else if (ex.reason < 0 && ex.error == MEMORY_ERROR)
-	    {
-	      /* Propagate memory errors silently back to the target.
-		 The stub may have limited the range of addresses we
-		 can write to, for example.  */
-	      putpkt ("E01");
-	    }
-	  else
-	    {
-	      /* Something unexpectedly bad happened.  Be verbose so
-		 we can tell what, and propagate the error back to the
-		 stub, so it doesn't get stuck waiting for a
-		 response.  */
-	      exception_fprintf (gdb_stderr, ex,
-				 _("warning: relocating instruction: "));
-	      putpkt ("E01");
-	    }
-	}
+	remote_relocate_insn_request (buf_p, sizeof_buf);
       else if (buf[0] == 'O' && buf[1] != 'K')
 	remote_console_output (buf + 1);	/* 'O' message from stub */
       else
@@ -1237,6 +1299,7 @@ enum {
   PACKET_Z2,
   PACKET_Z3,
   PACKET_Z4,
+  PACKET_Z5,
   PACKET_vFile_open,
   PACKET_vFile_pread,
   PACKET_vFile_pwrite,
@@ -1285,6 +1348,9 @@ enum {
   PACKET_Qbtrace_off,
   PACKET_Qbtrace_bts,
   PACKET_qXfer_btrace,
+  PACKET_ThreadListDelta,
+  PACKET_FastConditionalBreakpoints,
+  PACKET_qTDrain,
   PACKET_MAX
 };
 
@@ -1340,6 +1406,7 @@ enum Z_packet_type
   Z_PACKET_WRITE_WP,
   Z_PACKET_READ_WP,
   Z_PACKET_ACCESS_WP,
+  Z_PACKET_SOFTWARE_WP,
   NR_Z_PACKET_TYPES
 };
 
@@ -2602,14 +2669,42 @@ typedef struct thread_item
   ptid_t ptid;
   char *extra;
   int core;
+
+  /* Non-zero if this item reports that the thread exited.  */
+  int exited;
 } thread_item_t;
 DEF_VEC_O(thread_item_t);
 
 struct threads_parsing_context
 {
   VEC (thread_item_t) *items;
+
+  /* The thread list generation reported by the stub, or zero if it
+     did not report one.  */
+  ULONGEST generation;
+
+  /* Non-zero if ITEMS only describes the changes since the generation
+     we asked for.  */
+  int delta;
 };
 
+static void
+start_threads (struct gdb_xml_parser *parser,
+	       const struct gdb_xml_element *element,
+	       void *user_data, VEC(gdb_xml_value_s) *attributes)
+{
+  struct threads_parsing_context *data = user_data;
+  struct gdb_xml_value *attr;
+
+  attr = xml_find_attribute (attributes, "generation");
+  if (attr != NULL)
+    data->generation = *(ULONGEST *) attr->value;
+
+  attr = xml_find_attribute (attributes, "delta");
+  if (attr != NULL)
+    data->delta = *(ULONGEST *) attr->value;
+}
+
 static void
 start_thread (struct gdb_xml_parser *parser,
 	      const struct gdb_xml_element *element,
@@ -2631,6 +2726,25 @@ start_thread (struct gdb_xml_parser *parser,
     item.core = -1;
 
   item.extra = 0;
+  item.exited = 0;
+
+  VEC_safe_push (thread_item_t, data->items, &item);
+}
+
+static void
+start_exited (struct gdb_xml_parser *parser,
+	      const struct gdb_xml_element *element,
+	      void *user_data, VEC(gdb_xml_value_s) *attributes)
+{
+  struct threads_parsing_context *data = user_data;
+  struct thread_item item;
+  char *id;
+
+  id = xml_find_attribute (attributes, "id")->value;
+  item.ptid = read_ptid (id, NULL);
+  item.core = -1;
+  item.extra = NULL;
+  item.exited = 1;
 
   VEC_safe_push (thread_item_t, data->items, &item);
 }
@@ -2656,16 +2770,37 @@ const struct gdb_xml_element thread_children[] = {
   { NULL, NULL, NULL, GDB_XML_EF_NONE, NULL, NULL }
 };
 
+const struct gdb_xml_attribute exited_attributes[] = {
+  { "id", GDB_XML_AF_NONE, NULL, NULL },
+  { NULL, GDB_XML_AF_NONE, NULL, NULL }
+};
+
 const struct gdb_xml_element threads_children[] = {
   { "thread", thread_attributes, thread_children,
     GDB_XML_EF_REPEATABLE | GDB_XML_EF_OPTIONAL,
     start_thread, end_thread },
+  { "exited", exited_attributes, NULL,
+    GDB_XML_EF_REPEATABLE | GDB_XML_EF_OPTIONAL,
+    start_exited, NULL },
   { NULL, NULL, NULL, GDB_XML_EF_NONE, NULL, NULL }
 };
 
+static const struct gdb_xml_enum threads_delta_enum[] = {
+  { "yes", 1 },
+  { "no", 0 },
+  { NULL, 0 }
+};
+
+const struct gdb_xml_attribute threads_attributes[] = {
+  { "generation", GDB_XML_AF_OPTIONAL, gdb_xml_parse_attr_ulongest, NULL },
+  { "delta", GDB_XML_AF_OPTIONAL, gdb_xml_parse_attr_enum,
+    threads_delta_enum },
+  { NULL, GDB_XML_AF_NONE, NULL, NULL }
+};
+
 const struct gdb_xml_element threads_elements[] = {
-  { "threads", NULL, threads_children,
-    GDB_XML_EF_NONE, NULL, NULL },
+  { "threads", threads_attributes, threads_children,
+    GDB_XML_EF_NONE, start_threads, NULL },
   { NULL, NULL, NULL, GDB_XML_EF_NONE, NULL, NULL }
 };
 
@@ -2706,16 +2841,33 @@ remote_threads_info (struct target_ops *ops)
 #if defined(HAVE_LIBEXPAT)
   if (remote_protocol_packets[PACKET_qXfer_threads].support == PACKET_ENABLE)
     {
-      char *xml = target_read_stralloc (&current_target,
-					 TARGET_OBJECT_THREADS, NULL);
+      char annex[20];
+      char *xml;
+      struct cleanup *back_to;
+
+      /* If the stub supports it, only ask for the threads that were
+	 created or exited since we last looked.  */
+      if (remote_protocol_packets[PACKET_ThreadListDelta].support
+	  == PACKET_ENABLE)
+	{
+	  xsnprintf (annex, sizeof (annex), "%s",
+		     phex_nz (rs->threads_generation, 0));
+	  xml = target_read_stralloc (&current_target,
+				      TARGET_OBJECT_THREADS, annex);
+	}
+      else
+	xml = target_read_stralloc (&current_target,
+				    TARGET_OBJECT_THREADS, NULL);
 
-      struct cleanup *back_to = make_cleanup (xfree, xml);
+      back_to = make_cleanup (xfree, xml);
 
       if (xml && *xml)
 	{
 	  struct threads_parsing_context context;
 
 	  context.items = NULL;
+	  context.generation = 0;
+	  context.delta = 0;
 	  make_cleanup (clear_threads_parsing_context, &context);
 
 	  if (gdb_xml_parse_quick (_("threads"), "threads.dtd",
@@ -2728,7 +2880,13 @@ remote_threads_info (struct target_ops *ops)
 		   VEC_iterate (thread_item_t, context.items, i, item);
 		   ++i)
 		{
-		  if (!ptid_equal (item->ptid, null_ptid))
+		  if (item->exited)
+		    {
+		      /* Only delta replies report exited threads.  */
+		      if (context.delta && in_thread_list (item->ptid))
+			delete_thread (item->ptid);
+		    }
+		  else if (!ptid_equal (item->ptid, null_ptid))
 		    {
 		      struct private_thread_info *info;
 		      /* In non-stop mode, we assume new found threads
@@ -2741,10 +2899,13 @@ remote_threads_info (struct target_ops *ops)
 
 		      info = demand_private_info (item->ptid);
 		      info->core = item->core;
+		      xfree (info->extra);
 		      info->extra = item->extra;
 		      item->extra = NULL;
 		    }
 		}
+
+	      rs->threads_generation = context.generation;
 	    }
 	}
 
@@ -3013,6 +3174,10 @@ remote_close (int quitting)
   serial_close (remote_desc);
   remote_desc = NULL;
 
+  /* Remote file descriptors don't outlive the connection.  */
+  readahead_cache.fd = -1;
+  readahead_cache.last_fd = -1;
+
   /* We don't have a connection to the remote stub anymore.  Get rid
      of all the inferiors and their threads we were controlling.
      Reset inferior_ptid to null_ptid first, as otherwise has_stack_frame
@@ -3949,6 +4114,8 @@ static struct protocol_feature remote_protocol_features[] = {
     PACKET_qXfer_osdata },
   { "qXfer:threads:read", PACKET_DISABLE, remote_supported_packet,
     PACKET_qXfer_threads },
+  { "ThreadListDelta", PACKET_DISABLE, remote_supported_packet,
+    PACKET_ThreadListDelta },
   { "qXfer:traceframe-info:read", PACKET_DISABLE, remote_supported_packet,
     PACKET_qXfer_traceframe_info },
   { "QPassSignals", PACKET_DISABLE, remote_supported_packet,
@@ -3971,6 +4138,8 @@ static struct protocol_feature remote_protocol_features[] = {
     PACKET_BreakpointCommands },
   { "FastTracepoints", PACKET_DISABLE, remote_fast_tracepoint_feature,
     PACKET_FastTracepoints },
+  { "FastConditionalBreakpoints", PACKET_DISABLE, remote_supported_packet,
+    PACKET_FastConditionalBreakpoints },
   { "StaticTracepoints", PACKET_DISABLE, remote_static_tracepoint_feature,
     PACKET_StaticTracepoints },
   {"InstallInTrace", PACKET_DISABLE, remote_install_in_trace_feature,
@@ -3996,6 +4165,8 @@ static struct protocol_feature remote_protocol_features[] = {
   { "QAgent", PACKET_DISABLE, remote_supported_packet, PACKET_QAgent},
   { "QTBuffer:size", PACKET_DISABLE,
     remote_supported_packet, PACKET_QTBuffer_size},
+  { "qTDrain", PACKET_DISABLE,
+    remote_supported_packet, PACKET_qTDrain},
   { "tracenz", PACKET_DISABLE,
     remote_string_tracing_feature, -1 },
   { "Qbtrace:off", PACKET_DISABLE, remote_supported_packet, PACKET_Qbtrace_off },
@@ -4287,6 +4458,7 @@ remote_open_1 (char *name, int from_tty,
   rs->non_stop_aware = 0;
   rs->waiting_for_stop_reply = 0;
   rs->ctrlc_pending_p = 0;
+  rs->threads_generation = 0;
 
   general_thread = not_sent_ptid;
   continue_thread = not_sent_ptid;
@@ -7817,6 +7989,10 @@ extended_remote_mourn_1 (struct target_ops *target)
   /* Call common code to mark the inferior as not running.	*/
   generic_mourn_inferior ();
 
+  /* GDB just discarded threads the stub may not consider exited yet;
+     fetch the whole thread list next time.  */
+  rs->threads_generation = 0;
+
   if (!have_inferiors ())
     {
       if (!remote_multi_process_p (rs))
@@ -8081,9 +8257,22 @@ remote_insert_breakpoint (struct gdbarch *gdbarch,
       char *p, *endbuf;
       int bpsize;
       struct condition_list *cond = NULL;
+      int isize = 0;
 
       gdbarch_remote_breakpoint_from_pc (gdbarch, &addr, &bpsize);
 
+      /* If the stub can evaluate the condition in the inferior through
+	 a jump pad, tell it how long the instruction at ADDR is.  This
+	 must be done before building the packet, since checking the
+	 instruction may itself talk to the stub.  */
+      if (remote_protocol_packets[PACKET_FastConditionalBreakpoints].support
+	  == PACKET_ENABLE
+	  && remote_supports_cond_breakpoints ()
+	  && !VEC_empty (agent_expr_p, bp_tgt->conditions)
+	  && VEC_empty (agent_expr_p, bp_tgt->tcommands)
+	  && !gdbarch_fast_tracepoint_valid_at (gdbarch, addr, &isize, NULL))
+	isize = 0;
+
       rs = get_remote_state ();
       p = rs->buf;
       endbuf = rs->buf + get_remote_packet_size ();
@@ -8095,6 +8284,12 @@ remote_insert_breakpoint (struct gdbarch *gdbarch,
       p += hexnumstr (p, addr);
       xsnprintf (p, endbuf - p, ",%d", bpsize);
 
+      if (isize > 0)
+	{
+	  p += strlen (p);
+	  xsnprintf (p, endbuf - p, ";F%x", isize);
+	}
+
       if (remote_supports_cond_breakpoints ())
 	remote_add_target_side_condition (gdbarch, bp_tgt, p, endbuf);
 
@@ -8104,6 +8299,15 @@ remote_insert_breakpoint (struct gdbarch *gdbarch,
       putpkt (rs->buf);
       getpkt (&rs->buf, &rs->buf_size, 0);
 
+      /* Building a jump pad may need GDB to relocate the instruction
+	 at ADDR.  */
+      while (isize > 0
+	     && strncmp (rs->buf, "qRelocInsn:", strlen ("qRelocInsn:")) == 0)
+	{
+	  remote_relocate_insn_request (&rs->buf, &rs->buf_size);
+	  getpkt (&rs->buf, &rs->buf_size, 0);
+	}
+
       switch (packet_ok (rs->buf, &remote_protocol_packets[PACKET_Z0]))
 	{
 	case PACKET_ERROR:
@@ -8245,6 +8449,53 @@ remote_remove_watchpoint (CORE_ADDR addr, int len, int type,
 		  _("remote_remove_watchpoint: reached end of function"));
 }
 
+/* Send a Z5/z5 packet, asking the remote target to INSERT or remove a
+   software watchpoint on the LEN bytes at ADDR.  */
+
+static int
+remote_sw_watchpoint_packet (int insert, CORE_ADDR addr, int len)
+{
+  struct remote_state *rs = get_remote_state ();
+  char *endbuf = rs->buf + get_remote_packet_size ();
+  char *p;
+
+  if (remote_protocol_packets[PACKET_Z5].support == PACKET_DISABLE)
+    return insert ? 1 : -1;
+
+  xsnprintf (rs->buf, endbuf - rs->buf, "%c%x,", insert ? 'Z' : 'z',
+	     Z_PACKET_SOFTWARE_WP);
+  p = strchr (rs->buf, '\0');
+  addr = remote_address_masked (addr);
+  p += hexnumstr (p, (ULONGEST) addr);
+  xsnprintf (p, endbuf - p, ",%x", len);
+  putpkt (rs->buf);
+  getpkt (&rs->buf, &rs->buf_size, 0);
+
+  switch (packet_ok (rs->buf, &remote_protocol_packets[PACKET_Z5]))
+    {
+    case PACKET_ERROR:
+      return -1;
+    case PACKET_UNKNOWN:
+      return insert ? 1 : -1;
+    case PACKET_OK:
+      return 0;
+    }
+  internal_error (__FILE__, __LINE__,
+		  _("remote_sw_watchpoint_packet: reached end of function"));
+}
+
+static int
+remote_insert_sw_watchpoint (CORE_ADDR addr, int len)
+{
+  return remote_sw_watchpoint_packet (1, addr, len);
+}
+
+static int
+remote_remove_sw_watchpoint (CORE_ADDR addr, int len)
+{
+  return remote_sw_watchpoint_packet (0, addr, len);
+}
+
 
 int remote_hw_watchpoint_limit = -1;
 int remote_hw_watchpoint_length_limit = -1;
@@ -8798,7 +9049,9 @@ remote_xfer_partial (struct target_ops *ops, enum target_object object,
         &remote_protocol_packets[PACKET_qXfer_osdata]);
 
     case TARGET_OBJECT_THREADS:
-      gdb_assert (annex == NULL);
+      gdb_assert (annex == NULL
+		  || (remote_protocol_packets[PACKET_ThreadListDelta].support
+		      == PACKET_ENABLE));
       return remote_read_qxfer (ops, "threads", annex, readbuf, offset, len,
 				&remote_protocol_packets[PACKET_qXfer_threads]);
 
@@ -9567,39 +9820,17 @@ remote_hostio_parse_result (char *buffer, int *retcode,
     return -1;
 }
 
-/* Send a prepared I/O packet to the target and read its response.
-   The prepared packet is in the global RS->BUF before this function
-   is called, and the answer is there when we return.
-
-   COMMAND_BYTES is the length of the request to send, which may include
-   binary data.  WHICH_PACKET is the packet configuration to check
-   before attempting a packet.  If an error occurs, *REMOTE_ERRNO
-   is set to the error number and -1 is returned.  Otherwise the value
-   returned by the function is returned.
-
-   ATTACHMENT and ATTACHMENT_LEN should be non-NULL if and only if an
-   attachment is expected; an error will be reported if there's a
-   mismatch.  If one is found, *ATTACHMENT will be set to point into
-   the packet buffer and *ATTACHMENT_LEN will be set to the
-   attachment's length.  */
+/* Read the reply to a previously sent Host I/O packet of kind
+   WHICH_PACKET, and parse it as remote_hostio_send_command does.  */
 
 static int
-remote_hostio_send_command (int command_bytes, int which_packet,
-			    int *remote_errno, char **attachment,
-			    int *attachment_len)
+remote_hostio_read_reply (int which_packet, int *remote_errno,
+			  char **attachment, int *attachment_len)
 {
   struct remote_state *rs = get_remote_state ();
   int ret, bytes_read;
   char *attachment_tmp;
 
-  if (!remote_desc
-      || remote_protocol_packets[which_packet].support == PACKET_DISABLE)
-    {
-      *remote_errno = FILEIO_ENOSYS;
-      return -1;
-    }
-
-  putpkt_binary (rs->buf, command_bytes);
   bytes_read = getpkt_sane (&rs->buf, &rs->buf_size, 0);
 
   /* If it timed out, something is wrong.  Don't try to parse the
@@ -9648,6 +9879,41 @@ remote_hostio_send_command (int command_bytes, int which_packet,
   return ret;
 }
 
+/* Send a prepared I/O packet to the target and read its response.
+   The prepared packet is in the global RS->BUF before this function
+   is called, and the answer is there when we return.
+
+   COMMAND_BYTES is the length of the request to send, which may include
+   binary data.  WHICH_PACKET is the packet configuration to check
+   before attempting a packet.  If an error occurs, *REMOTE_ERRNO
+   is set to the error number and -1 is returned.  Otherwise the value
+   returned by the function is returned.
+
+   ATTACHMENT and ATTACHMENT_LEN should be non-NULL if and only if an
+   attachment is expected; an error will be reported if there's a
+   mismatch.  If one is found, *ATTACHMENT will be set to point into
+   the packet buffer and *ATTACHMENT_LEN will be set to the
+   attachment's length.  */
+
+static int
+remote_hostio_send_command (int command_bytes, int which_packet,
+			    int *remote_errno, char **attachment,
+			    int *attachment_len)
+{
+  struct remote_state *rs = get_remote_state ();
+
+  if (!remote_desc
+      || remote_protocol_packets[which_packet].support == PACKET_DISABLE)
+    {
+      *remote_errno = FILEIO_ENOSYS;
+      return -1;
+    }
+
+  putpkt_binary (rs->buf, command_bytes);
+  return remote_hostio_read_reply (which_packet, remote_errno,
+				   attachment, attachment_len);
+}
+
 /* Open FILENAME on the remote target, using FLAGS and MODE.  Return a
    remote file descriptor, or -1 if an error occurs (and set
    *REMOTE_ERRNO).  */
@@ -9688,6 +9954,8 @@ remote_hostio_pwrite (int fd, const gdb_byte *write_buf, int len,
   int left = get_remote_packet_size ();
   int out_len;
 
+  readahead_cache_invalidate_fd (fd);
+
   remote_buffer_add_string (&p, &left, "vFile:pwrite:");
 
   remote_buffer_add_int (&p, &left, fd);
@@ -9703,13 +9971,13 @@ remote_hostio_pwrite (int fd, const gdb_byte *write_buf, int len,
 				     remote_errno, NULL, NULL);
 }
 
-/* Read up to LEN bytes FD on the remote target into READ_BUF
-   Return the number of bytes read, or -1 if an error occurs (and
-   set *REMOTE_ERRNO).  */
+/* Read up to LEN bytes FD on the remote target into READ_BUF, with a
+   single vFile:pread request.  Return the number of bytes read, or -1
+   if an error occurs (and set *REMOTE_ERRNO).  */
 
 static int
-remote_hostio_pread (int fd, gdb_byte *read_buf, int len,
-		     ULONGEST offset, int *remote_errno)
+remote_hostio_pread_vFile (int fd, gdb_byte *read_buf, int len,
+			   ULONGEST offset, int *remote_errno)
 {
   struct remote_state *rs = get_remote_state ();
   char *p = rs->buf;
@@ -9743,6 +10011,182 @@ remote_hostio_pread (int fd, gdb_byte *read_buf, int len,
   return ret;
 }
 
+/* Copy as much as possible of a read of LEN bytes at OFFSET of FD
+   from the read-ahead cache into READ_BUF.  Return the number of bytes
+   copied, which is zero if the cache does not hold OFFSET.  */
+
+static int
+readahead_cache_read (int fd, gdb_byte *read_buf, int len, ULONGEST offset)
+{
+  struct readahead_cache *cache = &readahead_cache;
+
+  if (cache->fd != fd
+      || offset < cache->offset
+      || offset >= cache->offset + cache->bufsize)
+    return 0;
+
+  if (len > cache->offset + cache->bufsize - offset)
+    len = cache->offset + cache->bufsize - offset;
+
+  memcpy (read_buf, cache->buf + (offset - cache->offset), len);
+  return len;
+}
+
+/* Forget any data read ahead from FD, e.g. because it is being
+   written to or closed.  */
+
+static void
+readahead_cache_invalidate_fd (int fd)
+{
+  if (readahead_cache.fd == fd)
+    readahead_cache.fd = -1;
+  if (readahead_cache.last_fd == fd)
+    readahead_cache.last_fd = -1;
+}
+
+/* Refill the read-ahead cache with up to WINDOW consecutive blocks of
+   FD starting at OFFSET.  All the vFile:pread requests are sent before
+   any reply is read, so the whole window costs a single round trip.
+   Return the number of bytes now cached, which is zero at end-of-file,
+   or -1 if the first request failed (and set *REMOTE_ERRNO).  */
+
+static int
+readahead_cache_fill (int fd, ULONGEST offset, int window, int *remote_errno)
+{
+  struct remote_state *rs = get_remote_state ();
+  struct readahead_cache *cache = &readahead_cache;
+  /* Ask for no more than fits in a reply even if every byte needs
+     escaping, so that replies only come back short at end-of-file
+     and never leave a hole in the cached block.  */
+  int chunk = get_remote_packet_size () / 2;
+  int first_errno = 0;
+  int contiguous = 1;
+  int i;
+
+  if (!remote_desc
+      || remote_protocol_packets[PACKET_vFile_pread].support == PACKET_DISABLE)
+    {
+      *remote_errno = FILEIO_ENOSYS;
+      return -1;
+    }
+
+  gdb_assert (window > 0 && window <= REMOTE_FILE_READ_AHEAD_MAX);
+
+  cache->fd = -1;
+  cache->offset = offset;
+  cache->bufsize = 0;
+  cache->buf = xrealloc (cache->buf, (size_t) window * chunk);
+
+  for (i = 0; i < window; i++)
+    {
+      char *p = rs->buf;
+      int left = get_remote_packet_size ();
+
+      remote_buffer_add_string (&p, &left, "vFile:pread:");
+      remote_buffer_add_int (&p, &left, fd);
+      remote_buffer_add_string (&p, &left, ",");
+      remote_buffer_add_int (&p, &left, chunk);
+      remote_buffer_add_string (&p, &left, ",");
+      remote_buffer_add_int (&p, &left, offset + (ULONGEST) i * chunk);
+
+      putpkt_binary (rs->buf, p - rs->buf);
+    }
+
+  /* Every request gets a reply, even past an error or end-of-file.
+     Consume them all to keep the packet stream in sync.  */
+  for (i = 0; i < window; i++)
+    {
+      char *attachment;
+      int attachment_len, errnum, ret, read_len;
+
+      ret = remote_hostio_read_reply (PACKET_vFile_pread, &errnum,
+				      &attachment, &attachment_len);
+      if (ret < 0)
+	{
+	  if (i == 0)
+	    first_errno = errnum;
+	  contiguous = 0;
+	  continue;
+	}
+
+      if (!contiguous)
+	continue;
+
+      read_len = remote_unescape_input (attachment, attachment_len,
+					cache->buf + cache->bufsize, chunk);
+      if (read_len != ret)
+	{
+	  /* Malformed reply; don't trust anything after it.  */
+	  contiguous = 0;
+	  continue;
+	}
+
+      cache->bufsize += read_len;
+      if (read_len < chunk)
+	contiguous = 0;
+    }
+
+  if (first_errno != 0)
+    {
+      *remote_errno = first_errno;
+      return -1;
+    }
+
+  cache->fd = fd;
+  return cache->bufsize;
+}
+
+/* Read up to LEN bytes FD on the remote target into READ_BUF
+   Return the number of bytes read, or -1 if an error occurs (and
+   set *REMOTE_ERRNO).  */
+
+static int
+remote_hostio_pread (int fd, gdb_byte *read_buf, int len,
+		     ULONGEST offset, int *remote_errno)
+{
+  struct remote_state *rs = get_remote_state ();
+  struct readahead_cache *cache = &readahead_cache;
+  int window, ret;
+
+  ret = readahead_cache_read (fd, read_buf, len, offset);
+  if (ret == 0)
+    {
+      int chunk = get_remote_packet_size () / 2;
+
+      /* Use the whole window when the file is being read
+	 sequentially.  Otherwise, fetch only as many blocks as this
+	 request needs, so that scattered small reads (e.g. of headers)
+	 stay cheap.  */
+      if (cache->last_fd == fd && offset == cache->last_end)
+	window = remote_file_read_ahead;
+      else
+	{
+	  window = (len + chunk - 1) / chunk;
+	  if (window > remote_file_read_ahead)
+	    window = remote_file_read_ahead;
+	}
+
+      /* Sending requests back-to-back only works if the stub does not
+	 acknowledge each packet.  */
+      if (!rs->noack_mode || window <= 1)
+	ret = remote_hostio_pread_vFile (fd, read_buf, len, offset,
+					 remote_errno);
+      else
+	{
+	  ret = readahead_cache_fill (fd, offset, window, remote_errno);
+	  if (ret > 0)
+	    ret = readahead_cache_read (fd, read_buf, len, offset);
+	}
+
+      if (ret <= 0)
+	return ret;
+    }
+
+  cache->last_fd = fd;
+  cache->last_end = offset + ret;
+  return ret;
+}
+
 /* Close FD on the remote target.  Return 0, or -1 if an error occurs
    (and set *REMOTE_ERRNO).  */
 
@@ -9753,6 +10197,8 @@ remote_hostio_close (int fd, int *remote_errno)
   char *p = rs->buf;
   int left = get_remote_packet_size () - 1;
 
+  readahead_cache_invalidate_fd (fd);
+
   remote_buffer_add_string (&p, &left, "vFile:close:");
 
   remote_buffer_add_int (&p, &left, fd);
@@ -9971,6 +10417,209 @@ remote_filename_p (const char *filename)
   return strncmp (filename, "remote:", 7) == 0;
 }
 
+/* Return the build ID of ABFD, or NULL if it has none.  */
+
+static const struct elf_build_id *
+remote_bfd_build_id (bfd *abfd)
+{
+  if (!bfd_check_format (abfd, bfd_object)
+      || bfd_get_flavour (abfd) != bfd_target_elf_flavour
+      || elf_tdata (abfd)->build_id == NULL)
+    return NULL;
+
+  return elf_tdata (abfd)->build_id;
+}
+
+/* The iovec functions used to read a cached copy of a remote file.
+   The BFD keeps the name of the remote file, so that it is reported
+   and matched like the remote file itself, and is read through these
+   functions from the local copy whose name is OPEN_CLOSURE.  */
+
+static void *
+remote_cache_iovec_open (struct bfd *abfd, void *open_closure)
+{
+  const char *cache_name = open_closure;
+  int fd, *stream;
+
+  fd = open (cache_name, O_RDONLY | O_BINARY);
+  if (fd == -1)
+    {
+      bfd_set_error (bfd_error_system_call);
+      return NULL;
+    }
+
+  stream = xmalloc (sizeof (int));
+  *stream = fd;
+  return stream;
+}
+
+static file_ptr
+remote_cache_iovec_pread (struct bfd *abfd, void *stream, void *buf,
+			  file_ptr nbytes, file_ptr offset)
+{
+  int fd = *(int *) stream;
+  file_ptr pos, bytes;
+
+  if (lseek (fd, offset, SEEK_SET) != offset)
+    {
+      bfd_set_error (bfd_error_system_call);
+      return -1;
+    }
+
+  pos = 0;
+  while (nbytes > pos)
+    {
+      bytes = read (fd, (char *) buf + pos, nbytes - pos);
+      if (bytes == 0)
+	break;
+      if (bytes == -1)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  bfd_set_error (bfd_error_system_call);
+	  return -1;
+	}
+
+      pos += bytes;
+    }
+
+  return pos;
+}
+
+static int
+remote_cache_iovec_close (struct bfd *abfd, void *stream)
+{
+  int fd = *(int *) stream;
+
+  xfree (stream);
+  close (fd);
+
+  /* Zero means success.  */
+  return 0;
+}
+
+static int
+remote_cache_iovec_stat (struct bfd *abfd, void *stream, struct stat *sb)
+{
+  return fstat (*(int *) stream, sb);
+}
+
+/* Return the name under which a file with build ID BUILD_ID is cached
+   in remote_file_cache_directory.  The result is xmalloc'd.  */
+
+static char *
+remote_file_cache_name (const struct elf_build_id *build_id)
+{
+  char *name, *p;
+  size_t i;
+
+  name = xmalloc (strlen (remote_file_cache_directory)
+		  + 1 + build_id->size * 2 + 1);
+  p = name + sprintf (name, "%s/", remote_file_cache_directory);
+  for (i = 0; i < build_id->size; i++)
+    p += sprintf (p, "%02x", (unsigned) build_id->data[i]);
+  *p = '\0';
+
+  return name;
+}
+
+/* Download REMOTE_FILE (without the "remote:" prefix) to CACHE_NAME.
+   Return non-zero on success.  On failure, warn and leave no file
+   behind.  */
+
+static int
+remote_file_cache_store (const char *remote_file, const char *cache_name)
+{
+  volatile struct gdb_exception ex;
+  char *tmp_name;
+  struct cleanup *back_to;
+
+  /* Write to a temporary file first, so that an interrupted download
+     never leaves a truncated file under the final name.  */
+  tmp_name = xstrprintf ("%s.tmp", cache_name);
+  back_to = make_cleanup (xfree, tmp_name);
+
+  TRY_CATCH (ex, RETURN_MASK_ERROR)
+    {
+      remote_file_get (remote_file, tmp_name, 0);
+    }
+  if (ex.reason < 0 || rename (tmp_name, cache_name) != 0)
+    {
+      if (ex.reason < 0)
+	warning (_("Could not cache remote file \"%s\": %s"),
+		 remote_file, ex.message);
+      else
+	warning (_("Could not cache remote file \"%s\": %s"),
+		 remote_file, safe_strerror (errno));
+      unlink (tmp_name);
+      do_cleanups (back_to);
+      return 0;
+    }
+
+  do_cleanups (back_to);
+  return 1;
+}
+
+/* ABFD was just opened from REMOTE_FILE on the target.  If it has a
+   build ID, try to replace it with a copy kept in the local file
+   cache, downloading the file into the cache first if it isn't there
+   yet.  Return the BFD to use, which is ABFD itself if no cached copy
+   can be used.  */
+
+static bfd *
+remote_bfd_open_cached (bfd *abfd, const char *remote_file,
+			const char *target)
+{
+  const struct elf_build_id *build_id;
+  char *cache_name;
+  struct cleanup *back_to;
+  bfd *local_bfd;
+
+  build_id = remote_bfd_build_id (abfd);
+  if (build_id == NULL)
+    return abfd;
+
+  cache_name = remote_file_cache_name (build_id);
+  back_to = make_cleanup (xfree, cache_name);
+
+  if (access (cache_name, R_OK) != 0
+      && !remote_file_cache_store (remote_file + 7, cache_name))
+    {
+      do_cleanups (back_to);
+      return abfd;
+    }
+
+  local_bfd = gdb_bfd_openr_iovec (remote_file, target,
+				   remote_cache_iovec_open, cache_name,
+				   remote_cache_iovec_pread,
+				   remote_cache_iovec_close,
+				   remote_cache_iovec_stat);
+  if (local_bfd != NULL)
+    {
+      const struct elf_build_id *found = remote_bfd_build_id (local_bfd);
+
+      if (found != NULL
+	  && found->size == build_id->size
+	  && memcmp (found->data, build_id->data, found->size) == 0)
+	{
+	  if (remote_debug)
+	    fprintf_unfiltered (gdb_stdlog,
+				"Using cached copy \"%s\" of \"%s\"\n",
+				cache_name, remote_file);
+	  gdb_bfd_unref (abfd);
+	  do_cleanups (back_to);
+	  return local_bfd;
+	}
+
+      gdb_bfd_unref (local_bfd);
+    }
+
+  warning (_("Ignoring stale cached copy \"%s\" of remote file \"%s\""),
+	   cache_name, remote_file);
+  do_cleanups (back_to);
+  return abfd;
+}
+
 bfd *
 remote_bfd_open (const char *remote_file, const char *target)
 {
@@ -9980,6 +10629,11 @@ remote_bfd_open (const char *remote_file, const char *target)
 				   remote_bfd_iovec_close,
 				   remote_bfd_iovec_stat);
 
+  if (abfd != NULL
+      && remote_file_cache_directory != NULL
+      && *remote_file_cache_directory != '\0')
+    abfd = remote_bfd_open_cached (abfd, remote_file, target);
+
   return abfd;
 }
 
@@ -10971,6 +11625,54 @@ remote_get_raw_trace_data (gdb_byte *buf, ULONGEST offset, LONGEST len)
   return -1;
 }
 
+/* Like remote_get_raw_trace_data, but the target sends the data at
+   the start of its trace buffer, in binary, and discards what it has
+   sent, so that we can stream the trace while it is running.  */
+
+static LONGEST
+remote_drain_trace_data (gdb_byte *buf, LONGEST len)
+{
+  struct remote_state *rs = get_remote_state ();
+  int packet_len;
+  char *p;
+
+  if (remote_protocol_packets[PACKET_qTDrain].support == PACKET_DISABLE)
+    return -1;
+
+  p = rs->buf;
+  strcpy (p, "qTDrain:");
+  p += strlen (p);
+  p += hexnumstr (p, len);
+  *p++ = '\0';
+
+  putpkt (rs->buf);
+  packet_len = getpkt_sane (&rs->buf, &rs->buf_size, 0);
+  if (packet_len < 0)
+    error (_("Error draining the trace buffer"));
+
+  switch (packet_ok (rs->buf, &remote_protocol_packets[PACKET_qTDrain]))
+    {
+    case PACKET_ERROR:
+      error (_("Target can't drain the trace buffer now"));
+    case PACKET_UNKNOWN:
+      return -1;
+    case PACKET_OK:
+      break;
+    }
+
+  /* 'l' by itself means there is nothing to get yet.  */
+  if (rs->buf[0] == 'l')
+    return 0;
+
+  if (rs->buf[0] != 'm')
+    error (_("Unknown qTDrain reply: %s"), rs->buf);
+
+  /* Don't overflow BUF if the target is more generous than we
+     asked.  */
+  return remote_unescape_input ((gdb_byte *) rs->buf + 1, packet_len - 1,
+				buf, len);
+}
+
 static void
 remote_set_disconnected_tracing (int val)
 {
@@ -11353,6 +12055,8 @@ Specify the serial device it is connected to\n\
      = remote_region_ok_for_hw_watchpoint;
   remote_ops.to_insert_watchpoint = remote_insert_watchpoint;
   remote_ops.to_remove_watchpoint = remote_remove_watchpoint;
+  remote_ops.to_insert_sw_watchpoint = remote_insert_sw_watchpoint;
+  remote_ops.to_remove_sw_watchpoint = remote_remove_sw_watchpoint;
   remote_ops.to_kill = remote_kill;
   remote_ops.to_load = generic_load;
   remote_ops.to_mourn_inferior = remote_mourn;
@@ -11421,6 +12125,7 @@ Specify the serial device it is connected to\n\
   remote_ops.to_upload_trace_state_variables
     = remote_upload_trace_state_variables;
   remote_ops.to_get_raw_trace_data = remote_get_raw_trace_data;
+  remote_ops.to_drain_trace_data = remote_drain_trace_data;
   remote_ops.to_get_min_fast_tracepoint_insn_len = remote_get_min_fast_tracepoint_insn_len;
   remote_ops.to_set_disconnected_tracing = remote_set_disconnected_tracing;
   remote_ops.to_set_circular_trace_buffer = remote_set_circular_trace_buffer;
@@ -11625,6 +12330,22 @@ remote_upload_trace_state_variables (struct uploaded_tsv **utsvp)
   return 0;
 }
 
+/* Validate and apply "set remote file-read-ahead".  */
+
+static void
+set_remote_file_read_ahead (char *args, int from_tty,
+			    struct cmd_list_element *c)
+{
+  if (remote_file_read_ahead_1 > REMOTE_FILE_READ_AHEAD_MAX)
+    {
+      remote_file_read_ahead_1 = remote_file_read_ahead;
+      error (_("file-read-ahead must be at most %d."),
+	     REMOTE_FILE_READ_AHEAD_MAX);
+    }
+
+  remote_file_read_ahead = remote_file_read_ahead_1;
+}
+
 void
 _initialize_remote (void)
 {
@@ -11762,6 +12483,30 @@ further restriction and ``limit'' to enable that restriction."),
 	   _("Show the maximum number of bytes per memory-read packet."),
 	   &remote_show_cmdlist);
 
+  add_setshow_zuinteger_cmd ("file-read-ahead", class_files,
+			     &remote_file_read_ahead_1, _("\
+Set the number of remote file read requests kept in flight."), _("\
+Show the number of remote file read requests kept in flight."), _("\
+When reading a file from the remote target sequentially, GDB sends up\n\
+to this many vFile:pread requests before waiting for the replies, and\n\
+keeps the data read ahead for subsequent reads.  This only applies\n\
+when the connection is in no-acknowledgment mode.  Zero or one disables\n\
+reading ahead.  The maximum is 64."),
+			     set_remote_file_read_ahead, NULL,
+			     &remote_set_cmdlist, &remote_show_cmdlist);
+
+  add_setshow_optional_filename_cmd ("file-cache-directory", class_files,
+				     &remote_file_cache_directory, _("\
+Set the directory where copies of remote files are cached."), _("\
+Show the directory where copies of remote files are cached."), _("\
+When set, executables and shared libraries read from the remote target\n\
+through a \"remote:\" sysroot are saved in this existing directory,\n\
+named after their build ID, and later loads of a file with the same\n\
+build ID use the local copy instead of downloading it again.  An empty\n\
+value disables the cache."),
+				     NULL, NULL,
+				     &remote_set_cmdlist, &remote_show_cmdlist);
+
   add_setshow_zinteger_cmd ("hardware-watchpoint-limit", no_class,
 			    &remote_hw_watchpoint_limit, _("\
 Set the maximum number of target hardware watchpoints."), _("\
@@ -11834,6 +12579,9 @@ Show the maximum size of the address (in bits) in a memory packet."), NULL,
   add_packet_config_cmd (&remote_protocol_packets[PACKET_Z4],
 			 "Z4", "access-watchpoint", 0);
 
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_Z5],
+			 "Z5", "software-watchpoint", 0);
+
   add_packet_config_cmd (&remote_protocol_packets[PACKET_qXfer_auxv],
 			 "qXfer:auxv:read", "read-aux-vector", 0);
 
@@ -11861,6 +12609,9 @@ Show the maximum size of the address (in bits) in a memory packet."), NULL,
   add_packet_config_cmd (&remote_protocol_packets[PACKET_qXfer_threads],
 			 "qXfer:threads:read", "threads", 0);
 
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_ThreadListDelta],
+			 "ThreadListDelta", "thread-list-delta", 0);
+
   add_packet_config_cmd (&remote_protocol_packets[PACKET_qXfer_siginfo_read],
                          "qXfer:siginfo:read", "read-siginfo-object", 0);
 
@@ -11942,6 +12693,10 @@ Show the maximum size of the address (in bits) in a memory packet."), NULL,
   add_packet_config_cmd (&remote_protocol_packets[PACKET_FastTracepoints],
 			 "FastTracepoints", "fast-tracepoints", 0);
 
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_FastConditionalBreakpoints],
+			 "FastConditionalBreakpoints",
+			 "fast-conditional-breakpoints", 0);
+
   add_packet_config_cmd (&remote_protocol_packets[PACKET_TracepointSource],
 			 "TracepointSource", "TracepointSource", 0);
 
@@ -11969,6 +12724,9 @@ Show the maximum size of the address (in bits) in a memory packet."), NULL,
   add_packet_config_cmd (&remote_protocol_packets[PACKET_QTBuffer_size],
 			 "QTBuffer:size", "trace-buffer-size", 0);
 
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_qTDrain],
+			 "qTDrain", "drain-trace-buffer", 0);
+
   add_packet_config_cmd (&remote_protocol_packets[PACKET_Qbtrace_off],
        "Qbtrace:off", "disable-btrace", 0);
 
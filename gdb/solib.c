@@ -601,7 +601,12 @@ solib_read_symbols (struct so_list *so, int flags)
 		break;
 	    }
 	  if (so->objfile != NULL)
-	    break;
+	    {
+	      /* There is no new_objfile notification for an objfile we
+		 reuse, so re-set its breakpoints here.  */
+	      breakpoint_re_set_objfile (so->objfile);
+	      break;
+	    }
 
 	  sap = build_section_addr_info_from_section_table (so->sections,
 							    so->sections_end);
@@ -921,8 +926,8 @@ solib_add (char *pattern, int from_tty,
 	    }
 	}
 
-    if (loaded_any_symbols)
-      breakpoint_re_set ();
+    /* Breakpoints in the libraries just read were re-set by
+       breakpoint.c's new_objfile observer, as each was added.  */
 
     if (from_tty && pattern && ! any_matches)
       printf_unfiltered
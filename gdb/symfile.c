@@ -1054,7 +1054,9 @@ new_symfile_objfile (struct objfile *objfile, int add_flags)
 {
   /* If this is the main symbol file we have to clean up all users of the
      old main symbol file.  Otherwise it is sufficient to fixup all the
-     breakpoints that may have been redefined by this symbol file.  */
+     breakpoints that may have been redefined by this symbol file.  For
+     shared libraries, breakpoint.c's new_objfile observer does that,
+     looking only at the new objfile.  */
   if (add_flags & SYMFILE_MAINLINE)
     {
       /* OK, make it the "real" symbol file.  */
@@ -1062,7 +1064,8 @@ new_symfile_objfile (struct objfile *objfile, int add_flags)
 
       clear_symtab_users (add_flags);
     }
-  else if ((add_flags & SYMFILE_DEFER_BP_RESET) == 0)
+  else if ((add_flags & SYMFILE_DEFER_BP_RESET) == 0
+	   && (objfile->flags & OBJF_SHARED) == 0)
     {
       breakpoint_re_set ();
     }
@@ -246,18 +246,15 @@ iterate_over_some_symtabs (const char *name,
   return 0;
 }
 
-/* Check for a symtab of a specific name; first in symtabs, then in
-   psymtabs.  *If* there is no '/' in the name, a match after a '/'
-   in the symtab filename will also work.
+/* Worker for iterate_over_symtabs and iterate_over_objfile_symtabs.
+   If SEARCH_OBJFILE is not NULL, only the symtabs of SEARCH_OBJFILE
+   and of its separate debug objfiles are searched.  */
 
-   Calls CALLBACK with each symtab that is found and with the supplied
-   DATA.  If CALLBACK returns true, the search stops.  */
-
-void
-iterate_over_symtabs (const char *name,
-		      int (*callback) (struct symtab *symtab,
-				       void *data),
-		      void *data)
+static void
+iterate_over_symtabs_1 (struct objfile *search_objfile, const char *name,
+			int (*callback) (struct symtab *symtab,
+					 void *data),
+			void *data)
 {
   struct objfile *objfile;
   char *real_path = NULL;
@@ -274,6 +271,10 @@ iterate_over_symtabs (const char *name,
 
   ALL_OBJFILES (objfile)
   {
+    if (search_objfile != NULL && objfile != search_objfile
+	&& objfile->separate_debug_objfile_backlink != search_objfile)
+      continue;
+
     if (iterate_over_some_symtabs (name, real_path, callback, data,
 				   objfile->symtabs, NULL))
       {
@@ -287,6 +288,10 @@ iterate_over_symtabs (const char *name,
 
   ALL_OBJFILES (objfile)
   {
+    if (search_objfile != NULL && objfile != search_objfile
+	&& objfile->separate_debug_objfile_backlink != search_objfile)
+      continue;
+
     if (objfile->sf
 	&& objfile->sf->qf->map_symtabs_matching_filename (objfile,
 							   name,
@@ -302,6 +307,33 @@ iterate_over_symtabs (const char *name,
   do_cleanups (cleanups);
 }
 
+/* Check for a symtab of a specific name; first in symtabs, then in
+   psymtabs.  *If* there is no '/' in the name, a match after a '/'
+   in the symtab filename will also work.
+
+   Calls CALLBACK with each symtab that is found and with the supplied
+   DATA.  If CALLBACK returns true, the search stops.  */
+
+void
+iterate_over_symtabs (const char *name,
+		      int (*callback) (struct symtab *symtab,
+				       void *data),
+		      void *data)
+{
+  iterate_over_symtabs_1 (NULL, name, callback, data);
+}
+
+/* See symtab.h.  */
+
+void
+iterate_over_objfile_symtabs (struct objfile *objfile, const char *name,
+			      int (*callback) (struct symtab *symtab,
+					       void *data),
+			      void *data)
+{
+  iterate_over_symtabs_1 (objfile, name, callback, data);
+}
+
 /* The callback function used by lookup_symtab.  */
 
 static int
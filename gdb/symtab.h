@@ -1296,6 +1296,15 @@ void iterate_over_symtabs (const char *name,
 					    void *data),
 			   void *data);
 
+/* Like iterate_over_symtabs, but only search the symtabs of OBJFILE
+   and of its separate debug objfiles.  */
+
+void iterate_over_objfile_symtabs (struct objfile *objfile,
+				   const char *name,
+				   int (*callback) (struct symtab *symtab,
+						    void *data),
+				   void *data);
+
 DEF_VEC_I (CORE_ADDR);
 
 VEC (CORE_ADDR) *find_pcs_for_symtab_line (struct symtab *symtab, int line,
@@ -244,6 +244,45 @@ show_stack_cache_enabled_p (struct ui_file *file, int from_tty,
   fprintf_filtered (file, _("Cache use for stack accesses is %s.\n"), value);
 }
 
+/* Likewise, for "set string-cache".  */
+static int string_cache_enabled_p_1 = 1;
+static int string_cache_enabled_p = 1;
+
+static void
+set_string_cache_enabled_p (char *args, int from_tty,
+			    struct cmd_list_element *c)
+{
+  if (string_cache_enabled_p != string_cache_enabled_p_1)
+    target_dcache_invalidate ();
+
+  string_cache_enabled_p = string_cache_enabled_p_1;
+}
+
+static void
+show_string_cache_enabled_p (struct ui_file *file, int from_tty,
+			     struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Cache use for string accesses is %s.\n"),
+		    value);
+}
+
+/* Return non-zero if a string at MEMADDR is read through the data
+   cache.  The string cache only applies to memory outside the regions
+   of the memory map; the regions the user or the target defined keep
+   their own "cache" attribute.  */
+
+int
+target_string_cache_p (CORE_ADDR memaddr)
+{
+  struct mem_region *region;
+
+  if (!string_cache_enabled_p)
+    return 0;
+
+  region = lookup_mem_region (memaddr);
+  return default_mem_region_p (region) || region->attrib.cache;
+}
+
 /* Cache of memory operations, to speed up remote access.  */
 static DCACHE *target_dcache;
 
@@ -558,6 +597,14 @@ default_get_ada_task_ptid (long lwp, long tid)
   return ptid_build (ptid_get_pid (inferior_ptid), lwp, tid);
 }
 
+/* The default to_drain_trace_data: the target can't do it.  */
+
+static LONGEST
+default_drain_trace_data (gdb_byte *buf, LONGEST len)
+{
+  return -1;
+}
+
 static enum exec_direction_kind
 default_execution_direction (void)
 {
@@ -623,6 +670,8 @@ update_current_target (void)
       INHERIT (to_remove_watchpoint, t);
       /* Do not inherit to_insert_mask_watchpoint.  */
       /* Do not inherit to_remove_mask_watchpoint.  */
+      INHERIT (to_insert_sw_watchpoint, t);
+      INHERIT (to_remove_sw_watchpoint, t);
       INHERIT (to_stopped_data_address, t);
       INHERIT (to_have_steppable_watchpoint, t);
       INHERIT (to_have_continuable_watchpoint, t);
@@ -705,6 +754,7 @@ update_current_target (void)
       INHERIT (to_upload_tracepoints, t);
       INHERIT (to_upload_trace_state_variables, t);
       INHERIT (to_get_raw_trace_data, t);
+      INHERIT (to_drain_trace_data, t);
       INHERIT (to_get_min_fast_tracepoint_insn_len, t);
       INHERIT (to_set_disconnected_tracing, t);
       INHERIT (to_set_circular_trace_buffer, t);
@@ -772,6 +822,12 @@ update_current_target (void)
   de_fault (to_remove_watchpoint,
 	    (int (*) (CORE_ADDR, int, int, struct expression *))
 	    return_minus_one);
+  de_fault (to_insert_sw_watchpoint,
+	    (int (*) (CORE_ADDR, int))
+	    return_one);
+  de_fault (to_remove_sw_watchpoint,
+	    (int (*) (CORE_ADDR, int))
+	    return_minus_one);
   de_fault (to_stopped_by_watchpoint,
 	    (int (*) (void))
 	    return_zero);
@@ -919,6 +975,8 @@ update_current_target (void)
   de_fault (to_get_raw_trace_data,
 	    (LONGEST (*) (gdb_byte *, ULONGEST, LONGEST))
 	    tcomplain);
+  de_fault (to_drain_trace_data,
+	    default_drain_trace_data);
   de_fault (to_get_min_fast_tracepoint_insn_len,
 	    (int (*) (void))
 	    return_minus_one);
@@ -1564,7 +1622,10 @@ memory_xfer_partial_1 (struct target_ops *ops, enum target_object object,
 	 the collected memory range fails.  */
       && get_traceframe_number () == -1
       && (region->attrib.cache
-	  || (stack_cache_enabled_p && object == TARGET_OBJECT_STACK_MEMORY)))
+	  || (stack_cache_enabled_p && object == TARGET_OBJECT_STACK_MEMORY)
+	  || (string_cache_enabled_p
+	      && object == TARGET_OBJECT_STRING_MEMORY
+	      && default_mem_region_p (region))))
     {
       if (readbuf != NULL)
 	res = dcache_xfer_memory (ops, target_dcache, memaddr, readbuf,
@@ -1616,7 +1677,7 @@ memory_xfer_partial_1 (struct target_ops *ops, enum target_object object,
       && inf != NULL
       && writebuf != NULL
       && !region->attrib.cache
-      && stack_cache_enabled_p
+      && (stack_cache_enabled_p || string_cache_enabled_p)
       && object != TARGET_OBJECT_STACK_MEMORY)
     {
       dcache_update (target_dcache, memaddr, (void *) writebuf, res);
@@ -1704,7 +1765,9 @@ target_xfer_partial (struct target_ops *ops,
   /* If this is a memory transfer, let the memory-specific code
      have a look at it instead.  Memory transfers are more
      complicated.  */
-  if (object == TARGET_OBJECT_MEMORY || object == TARGET_OBJECT_STACK_MEMORY)
+  if (object == TARGET_OBJECT_MEMORY
+      || object == TARGET_OBJECT_STACK_MEMORY
+      || object == TARGET_OBJECT_STRING_MEMORY)
     retval = memory_xfer_partial (ops, object, readbuf,
 				  writebuf, offset, len);
   else
@@ -1806,6 +1869,43 @@ target_read_stack (CORE_ADDR memaddr, gdb_byte *myaddr, ssize_t len)
     return EIO;
 }
 
+/* Like target_read_memory, but specify that this is a read of a string
+   being printed.  This may be served from the data cache.  */
+
+int
+target_read_string_memory (CORE_ADDR memaddr, gdb_byte *myaddr, ssize_t len)
+{
+  if (target_read (current_target.beneath, TARGET_OBJECT_STRING_MEMORY, NULL,
+		   myaddr, memaddr, len) == len)
+    return 0;
+  else
+    return EIO;
+}
+
+/* Load LEN bytes of memory at MEMADDR, which hold strings GDB is about
+   to print, into the data cache with a single transfer.  Errors are
+   ignored; the strings will be read again, and report them, when they
+   are printed.  */
+
+void
+target_prefetch_string_memory (CORE_ADDR memaddr, ssize_t len)
+{
+  gdb_byte *buf;
+  struct cleanup *old_chain;
+  volatile struct gdb_exception ex;
+
+  if (len <= 0 || !target_string_cache_p (memaddr))
+    return;
+
+  buf = xmalloc (len);
+  old_chain = make_cleanup (xfree, buf);
+  TRY_CATCH (ex, RETURN_MASK_ERROR)
+    {
+      target_read_string_memory (memaddr, buf, len);
+    }
+  do_cleanups (old_chain);
+}
+
 /* Write LEN bytes from MYADDR to target memory at address MEMADDR.
    Returns either 0 for success or an errno value if any error occurs.
    If an error occurs, no guarantee is made about how much data got written.
@@ -5170,6 +5270,19 @@ By default, caching for stack access is on."),
 			   show_stack_cache_enabled_p,
 			   &setlist, &showlist);
 
+  add_setshow_boolean_cmd ("string-cache", class_support,
+			   &string_cache_enabled_p_1, _("\
+Set cache use for reading strings being printed."), _("\
+Show cache use for reading strings being printed."), _("\
+When on, read the strings pointed to by the values being printed through\n\
+the data cache, unless they lie in a memory region defined with \"mem\" or\n\
+by the target, which is cached according to its own attributes.  Cached\n\
+strings are read ahead in larger blocks, which saves round trips when\n\
+debugging remotely.  By default, caching for string access is on."),
+			   set_string_cache_enabled_p,
+			   show_string_cache_enabled_p,
+			   &setlist, &showlist);
+
   add_setshow_boolean_cmd ("may-write-registers", class_support,
 			   &may_write_registers_1, _("\
 Set permission to write into registers."), _("\
@@ -240,6 +240,9 @@ enum target_object
      if it is not in a region marked as such, since it is known to be
      "normal" RAM.  */
   TARGET_OBJECT_STACK_MEMORY,
+  /* Memory holding a string GDB is printing.  This is cached like
+     stack memory, since strings are read a few bytes at a time.  */
+  TARGET_OBJECT_STRING_MEMORY,
   /* Kernel Unwind Table.  See "ia64-tdep.c".  */
   TARGET_OBJECT_UNWIND_TABLE,
   /* Transfer auxilliary vector.  */
@@ -476,6 +479,12 @@ struct target_ops
 				      CORE_ADDR, CORE_ADDR, int);
     int (*to_remove_mask_watchpoint) (struct target_ops *,
 				      CORE_ADDR, CORE_ADDR, int);
+
+    /* Documentation of what the two routines below are expected to do is
+       provided with the corresponding target_* macros.  */
+    int (*to_insert_sw_watchpoint) (CORE_ADDR, int);
+    int (*to_remove_sw_watchpoint) (CORE_ADDR, int);
+
     int (*to_stopped_by_watchpoint) (void);
     int to_have_steppable_watchpoint;
     int to_have_continuable_watchpoint;
@@ -799,6 +808,14 @@ struct target_ops
     LONGEST (*to_get_raw_trace_data) (gdb_byte *buf,
 				      ULONGEST offset, LONGEST len);
 
+    /* Move up to LEN bytes of raw trace data from the start of the
+       target's trace buffer to BUF, while tracing goes on.  The
+       target discards the traceframes it has sent completely; a
+       traceframe may be split over several calls.  Return the number
+       of bytes read, 0 if there is nothing to read yet, or -1 if the
+       target does not support draining.  */
+    LONGEST (*to_drain_trace_data) (gdb_byte *buf, LONGEST len);
+
     /* Get the minimum length of instruction on which a fast tracepoint
        may be set on the target.  If this operation is unsupported,
        return -1.  If for some reason the minimum length cannot be
@@ -1104,6 +1121,13 @@ extern int target_read_memory (CORE_ADDR memaddr, gdb_byte *myaddr,
 
 extern int target_read_stack (CORE_ADDR memaddr, gdb_byte *myaddr, ssize_t len);
 
+extern int target_read_string_memory (CORE_ADDR memaddr, gdb_byte *myaddr,
+				      ssize_t len);
+
+extern void target_prefetch_string_memory (CORE_ADDR memaddr, ssize_t len);
+
+extern int target_string_cache_p (CORE_ADDR memaddr);
+
 extern int target_write_memory (CORE_ADDR memaddr, const gdb_byte *myaddr,
 				ssize_t len);
 
@@ -1585,6 +1609,19 @@ extern char *target_thread_name (struct thread_info *);
 #define	target_remove_watchpoint(addr, len, type, cond) \
      (*current_target.to_remove_watchpoint) (addr, len, type, cond)
 
+/* Ask the target to watch the LEN bytes at ADDR for a software
+   watchpoint: while the program runs, the target single-steps it and
+   only reports a stop when the contents of the region change, instead
+   of GDB single-stepping the program and reading the region after
+   each step.  Returns 0 for success, 1 if the target can't do this,
+   -1 for failure.  */
+
+#define target_insert_sw_watchpoint(addr, len) \
+     (*current_target.to_insert_sw_watchpoint) (addr, len)
+
+#define target_remove_sw_watchpoint(addr, len) \
+     (*current_target.to_remove_sw_watchpoint) (addr, len)
+
 /* Insert a new masked watchpoint at ADDR using the mask MASK.
    RW may be hw_read for a read watchpoint, hw_write for a write watchpoint
    or hw_access for an access watchpoint.  Returns 0 for success, 1 if
@@ -1771,6 +1808,9 @@ extern char *target_fileio_read_stralloc (const char *filename);
 #define target_get_raw_trace_data(buf,offset,len) \
   (*current_target.to_get_raw_trace_data) ((buf), (offset), (len))
 
+#define target_drain_trace_data(buf,len) \
+  (*current_target.to_drain_trace_data) ((buf), (len))
+
 #define target_get_min_fast_tracepoint_insn_len() \
   (*current_target.to_get_min_fast_tracepoint_insn_len) ()
 
@@ -0,0 +1,26 @@
+--  Copyright 2013 Free Software Foundation, Inc.
+--
+--  This program is free software; you can redistribute it and/or modify
+--  it under the terms of the GNU General Public License as published by
+--  the Free Software Foundation; either version 3 of the License, or
+--  (at your option) any later version.
+--
+--  This program is distributed in the hope that it will be useful,
+--  but WITHOUT ANY WARRANTY; without even the implied warranty of
+--  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+--  GNU General Public License for more details.
+--
+--  You should have received a copy of the GNU General Public License
+--  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+with Pck; use Pck;
+
+procedure Foo is
+   R : Rec := (A => 1, B => 2, C => 3, D => 4);
+   Arr : Int_Array := (1, 2, 3, 4, 5, 6, 7, 8);
+begin
+   Do_Nothing (R'Address);  -- START
+   R.B := 20;
+   Arr (3) := 30;
+   Do_Nothing (Arr'Address);  -- STOP
+end Foo;
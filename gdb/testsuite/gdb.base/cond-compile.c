@@ -0,0 +1,47 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2013 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+struct point
+{
+  int x;
+  short y;
+};
+
+struct point points[4] = { { 1, -1 }, { 2, -2 }, { 3, -3 }, { 4, -4 } };
+struct point *ppoint = &points[2];
+double dval = 1.5;
+volatile int sink;
+
+void
+func (int i)
+{
+  sink = i;	/* func breakpoint here */
+}
+
+int
+main (void)
+{
+  int i;
+
+  for (i = 0; i < 10; i++)
+    func (i);
+
+  for (i = 0; i < 10; i++)
+    func (i);
+
+  return 0;
+}
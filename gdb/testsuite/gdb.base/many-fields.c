@@ -0,0 +1,67 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2013 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* A structure with enough fields for GDB to index them by name.  */
+
+struct many_fields
+{
+  int f0;
+  int f1;
+  int f2;
+  int f3;
+  int f4;
+  int f5;
+  int f6;
+  int f7;
+  int f8;
+  int f9;
+  int f10;
+  int f11;
+  union
+  {
+    int u_int;
+    char u_char;
+  };
+  int f12;
+  int f13;
+  int f14;
+  int f15;
+  int f16;
+  int f17;
+  int f18;
+  int f19;
+  int f20;
+  int f21;
+  int f22;
+  int f23;
+  struct
+  {
+    int s_first;
+    int s_last;
+  };
+};
+
+struct many_fields many = {
+  0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, { 1200 }, 12, 13, 14, 15, 16,
+  17, 18, 19, 20, 21, 22, 23, { 2400, 2401 }
+};
+
+int
+main (void)
+{
+  return 0;
+}
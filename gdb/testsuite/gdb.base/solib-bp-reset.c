@@ -0,0 +1,57 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2013 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <dlfcn.h>
+#include <stdlib.h>
+
+typedef int (*func_ptr) (int);
+
+static func_ptr
+load (const char *name, const char *func)
+{
+  void *handle = dlopen (name, RTLD_NOW);
+
+  if (handle == NULL)
+    abort ();
+  return (func_ptr) dlsym (handle, func);
+}
+
+void
+after_first (void)
+{
+}
+
+void
+after_second (void)
+{
+}
+
+int
+main (void)
+{
+  func_ptr f1, f2, c1, c2;
+
+  f1 = load (SHLIB_NAME1, "lib1_func");
+  c1 = load (SHLIB_NAME1, "common_func");
+  after_first ();
+
+  f2 = load (SHLIB_NAME2, "lib2_func");
+  c2 = load (SHLIB_NAME2, "common_func");
+  after_second ();
+
+  return f1 (1) + c1 (2) + f2 (3) + c2 (4);
+}
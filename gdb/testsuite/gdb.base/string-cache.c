@@ -0,0 +1,46 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2013 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+char *names[5] = { "alpha", "bravo", "charlie", 0,
+		   "a string long enough to span several lines of GDB's "
+		   "data cache, which are sixty-four bytes long by default" };
+
+/* A string that ends just before an unmapped page.  */
+
+char *edge;
+
+int
+main (void)
+{
+  long pagesize = sysconf (_SC_PAGESIZE);
+  char *p;
+
+  p = mmap (0, 2 * pagesize, PROT_READ | PROT_WRITE,
+	    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p != MAP_FAILED)
+    {
+      munmap (p + pagesize, pagesize);
+      memset (p, 'x', pagesize);
+      edge = p + pagesize - 6;
+    }
+
+  return 0; /* break here */
+}
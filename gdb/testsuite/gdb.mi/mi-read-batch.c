@@ -0,0 +1,33 @@
+/* Copyright 2013 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+static unsigned char bytes[64];
+
+static unsigned char other[16];
+
+int
+main (void)
+{
+  int i;
+
+  for (i = 0; i < sizeof (bytes); i++)
+    bytes[i] = i;
+  for (i = 0; i < sizeof (other); i++)
+    other[i] = 0xf0 + i;
+
+  return 0; /* stop here */
+}
@@ -0,0 +1,48 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2013 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+struct inner
+{
+  int x;
+  int y;
+};
+
+struct outer
+{
+  int a;
+  struct inner in;
+  int arr[3];
+  int *p;
+  int other;
+};
+
+struct outer o;
+
+int target1 = 5;
+
+int
+main (void)
+{
+  o.p = &o.other;
+  o.a = 1;		/* start here */
+  o.in.y = 2;		/* after a */
+  o.arr[1] = 3;		/* after in.y */
+  o.other = 4;		/* after arr */
+  o.p = &target1;	/* after other */
+  target1 = 7;		/* after p */
+  return 0;		/* after target1 */
+}
@@ -32,6 +32,8 @@ struct function_lookup_test
   int x,y;
 };
 
+struct function_lookup_test flts[4];
+
 void
 init_flt (struct function_lookup_test *p, int x, int y)
 {
@@ -70,8 +72,11 @@ main ()
 {
   struct function_lookup_test flt;
   struct ss ss;
+  int i;
 
   init_flt (&flt, 42, 43);
+  for (i = 0; i < 4; i++)
+    init_flt (&flts[i], i, 2 * i);
   init_ss (&ss, 1, 2);
   
   return 0;      /* break to inspect */
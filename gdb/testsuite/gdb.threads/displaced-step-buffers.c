@@ -0,0 +1,61 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2013 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <pthread.h>
+
+#define NTHREADS 8
+#define ITERS 200
+
+volatile int counter[NTHREADS];
+int total;
+
+void
+hit (int i)
+{
+  counter[i]++;
+}
+
+void *
+worker (void *arg)
+{
+  int i = (int) (long) arg, j;
+
+  for (j = 0; j < ITERS; j++)
+    hit (i);
+  return NULL;
+}
+
+void
+all_done (void)
+{
+}
+
+int
+main (void)
+{
+  pthread_t t[NTHREADS];
+  long i;
+
+  for (i = 0; i < NTHREADS; i++)
+    pthread_create (&t[i], NULL, worker, (void *) i);
+  for (i = 0; i < NTHREADS; i++)
+    pthread_join (t[i], NULL);
+  for (i = 0; i < NTHREADS; i++)
+    total += counter[i];
+  all_done ();
+  return 0;
+}
@@ -197,6 +197,65 @@ write_error_trace_file (void)
   finish_trace_file (fd);
 }
 
+/* The number of traceframes in multi.tf.  */
+
+#define MULTI_FRAMES 10
+
+void
+write_multi_trace_file (void)
+{
+  int fd, int_x, i;
+  short short_x;
+
+  fd = start_trace_file ("multi.tf");
+
+  /* Dump the size of the R (register) blocks in traceframes.  */
+  snprintf (spbuf, sizeof spbuf, "R %x\n", 500 /* FIXME get from arch */);
+  write (fd, spbuf, strlen (spbuf));
+
+  /* Dump trace status, in the general form of the qTstatus reply.  */
+  snprintf (spbuf, sizeof spbuf,
+	    "status 0;tstop:0;tframes:%x;tcreated:%x;tfree:100;tsize:1000\n",
+	    MULTI_FRAMES, MULTI_FRAMES);
+  write (fd, spbuf, strlen (spbuf));
+
+  /* Two tracepoints, which collected the even and the odd traceframes
+     respectively.  */
+  snprintf (spbuf, sizeof spbuf, "tp T1:%lx:E:0:0\n",
+	    (long) &write_basic_trace_file);
+  write (fd, spbuf, strlen (spbuf));
+  snprintf (spbuf, sizeof spbuf, "tp T2:%lx:E:0:0\n",
+	    (long) &write_error_trace_file);
+  write (fd, spbuf, strlen (spbuf));
+
+  /* Empty line marks the end of the definition section.  */
+  write (fd, "\n", 1);
+
+  /* Each traceframe has TESTGLOB set to the traceframe's number.  */
+  for (i = 0; i < MULTI_FRAMES; i++)
+    {
+      trptr = trbuf;
+      short_x = (i % 2) + 1;
+      memcpy (trptr, &short_x, 2);
+      trptr += 2;
+      tfsizeptr = trptr;
+      trptr += 4;
+      testglob = i;
+      add_memory_block (&testglob, sizeof (testglob));
+      /* Go back and patch in the frame size.  */
+      int_x = trptr - tfsizeptr - sizeof (int);
+      memcpy (tfsizeptr, &int_x, 4);
+
+      write (fd, trbuf, trptr - trbuf);
+    }
+
+  /* Write end of tracebuffer marker.  */
+  memset (trbuf, 0, 6);
+  write (fd, trbuf, 6);
+
+  finish_trace_file (fd);
+}
+
 void
 done_making_trace_files (void)
 {
@@ -209,6 +268,8 @@ main (int argc, char **argv, char **envp)
 
   write_error_trace_file ();
 
+  write_multi_trace_file ();
+
   done_making_trace_files ();
 
   return 0;
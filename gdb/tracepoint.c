@@ -53,6 +53,7 @@
 #include "exceptions.h"
 #include "cli/cli-utils.h"
 #include "probe.h"
+#include "event-loop.h"
 
 /* readline include files */
 #include "readline/readline.h"
@@ -211,6 +212,8 @@ static void add_register (struct collection_list *collection,
 static void free_uploaded_tps (struct uploaded_tp **utpp);
 static void free_uploaded_tsvs (struct uploaded_tsv **utsvp);
 
+static void trace_stream_finish (void);
+
 
 extern void _initialize_tracepoint (void);
 
@@ -1738,6 +1741,9 @@ start_tracing (char *notes)
   int any_enabled = 0, num_to_download = 0;
   int ret;
 
+  /* The new run clears the trace buffer.  */
+  trace_stream_finish ();
+
   tp_vec = all_tracepoints ();
 
   /* No point in tracing without any tracepoints...  */
@@ -1933,6 +1939,8 @@ stop_tracing (char *note)
 
   /* Should change in response to reply?  */
   current_trace_status ()->running = 0;
+
+  trace_stream_finish ();
 }
 
 /* tstatus command */
@@ -2253,6 +2261,8 @@ disconnect_tracing (int from_tty)
   set_current_traceframe (-1);
   set_tracepoint_num (-1);
   set_traceframe_context (NULL);
+
+  trace_stream_finish ();
 }
 
 /* Worker function for the various flavors of the tfind command.  */
@@ -2989,51 +2999,78 @@ encode_source_string (int tpnum, ULONGEST addr,
 
 extern int trace_regblock_size;
 
-/* Save tracepoint data to file named FILENAME.  If TARGET_DOES_SAVE is
-   non-zero, the save is performed on the target, otherwise GDB obtains all
-   trace data and saves it locally.  */
+/* Return the "status" line of a trace file describing the tracing
+   run TS, newline included, in a string the caller must free.  If
+   WIDTH is positive, pad the line to WIDTH characters if it is
+   shorter, so that it can be rewritten in place later.  */
 
-void
-trace_save (const char *filename, int target_does_save)
+static char *
+trace_file_status_line (struct trace_status *ts, int width)
+{
+  struct ui_file *stb = mem_fileopen ();
+  struct cleanup *old_chain = make_cleanup_ui_file_delete (stb);
+  char *line;
+  long len;
+
+  fprintf_unfiltered (stb, "status %c;%s",
+		      (ts->running ? '1' : '0'),
+		      stop_reason_names[ts->stop_reason]);
+  if (ts->stop_reason == tracepoint_error)
+    {
+      char *buf = (char *) alloca (strlen (ts->stop_desc) * 2 + 1);
+
+      bin2hex ((gdb_byte *) ts->stop_desc, buf, 0);
+      fprintf_unfiltered (stb, ":%s", buf);
+    }
+  fprintf_unfiltered (stb, ":%x", ts->stopping_tracepoint);
+  if (ts->traceframe_count >= 0)
+    fprintf_unfiltered (stb, ";tframes:%x", ts->traceframe_count);
+  if (ts->traceframes_created >= 0)
+    fprintf_unfiltered (stb, ";tcreated:%x", ts->traceframes_created);
+  if (ts->buffer_free >= 0)
+    fprintf_unfiltered (stb, ";tfree:%x", ts->buffer_free);
+  if (ts->buffer_size >= 0)
+    fprintf_unfiltered (stb, ";tsize:%x", ts->buffer_size);
+  if (ts->disconnected_tracing)
+    fprintf_unfiltered (stb, ";disconn:%x", ts->disconnected_tracing);
+  if (ts->circular_buffer)
+    fprintf_unfiltered (stb, ";circular:%x", ts->circular_buffer);
+
+  line = ui_file_xstrdup (stb, &len);
+  xfree (line);
+
+  /* Pad with a field readers skip, since they don't know it.  */
+  if (width > 0 && len + strlen (";pad:\n") < width)
+    {
+      fputs_unfiltered (";pad:", stb);
+      for (len += strlen (";pad:\n"); len < width; len++)
+	fputs_unfiltered ("0", stb);
+    }
+  fputs_unfiltered ("\n", stb);
+
+  line = ui_file_xstrdup (stb, NULL);
+  do_cleanups (old_chain);
+  return line;
+}
+
+/* Write the header and the definition section of a trace file to FP,
+   open on PATHNAME, for the tracing run TS.  Pad the status line to
+   STATUS_WIDTH characters if positive, and return its offset in the
+   file.  */
+
+static long
+trace_file_write_definitions (FILE *fp, const char *pathname,
+			      struct trace_status *ts, int status_width)
 {
-  struct cleanup *cleanup;
-  char *pathname;
-  struct trace_status *ts = current_trace_status ();
-  int err, status;
-  FILE *fp;
   struct uploaded_tp *uploaded_tps = NULL, *utp;
   struct uploaded_tsv *uploaded_tsvs = NULL, *utsv;
   int a;
   char *act;
-  LONGEST gotten = 0;
-  ULONGEST offset = 0;
 #define MAX_TRACE_UPLOAD 2000
   gdb_byte buf[MAX_TRACE_UPLOAD];
   int written;
-
-  /* If the target is to save the data to a file on its own, then just
-     send the command and be done with it.  */
-  if (target_does_save)
-    {
-      err = target_save_trace_data (filename);
-      if (err < 0)
-	error (_("Target failed to save trace data to '%s'."),
-	       filename);
-      return;
-    }
-
-  /* Get the trace status first before opening the file, so if the
-     target is losing, we can get out without touching files.  */
-  status = target_get_trace_status (ts);
-
-  pathname = tilde_expand (filename);
-  cleanup = make_cleanup (xfree, pathname);
-
-  fp = fopen (pathname, "wb");
-  if (!fp)
-    error (_("Unable to open file '%s' for saving trace data (%s)"),
-	   filename, safe_strerror (errno));
-  make_cleanup_fclose (fp);
+  long status_offset;
+  char *line;
 
   /* Write a file header, with a high-bit-set char to indicate a
      binary file, plus a hint as what this file is, and a version
@@ -3048,29 +3085,10 @@ trace_save (const char *filename, int target_does_save)
   fprintf (fp, "R %x\n", trace_regblock_size);
 
   /* Write out status of the tracing run (aka "tstatus" info).  */
-  fprintf (fp, "status %c;%s",
-	   (ts->running ? '1' : '0'), stop_reason_names[ts->stop_reason]);
-  if (ts->stop_reason == tracepoint_error)
-    {
-      char *buf = (char *) alloca (strlen (ts->stop_desc) * 2 + 1);
-
-      bin2hex ((gdb_byte *) ts->stop_desc, buf, 0);
-      fprintf (fp, ":%s", buf);
-    }
-  fprintf (fp, ":%x", ts->stopping_tracepoint);
-  if (ts->traceframe_count >= 0)
-    fprintf (fp, ";tframes:%x", ts->traceframe_count);
-  if (ts->traceframes_created >= 0)
-    fprintf (fp, ";tcreated:%x", ts->traceframes_created);
-  if (ts->buffer_free >= 0)
-    fprintf (fp, ";tfree:%x", ts->buffer_free);
-  if (ts->buffer_size >= 0)
-    fprintf (fp, ";tsize:%x", ts->buffer_size);
-  if (ts->disconnected_tracing)
-    fprintf (fp, ";disconn:%x", ts->disconnected_tracing);
-  if (ts->circular_buffer)
-    fprintf (fp, ";circular:%x", ts->circular_buffer);
-  fprintf (fp, "\n");
+  status_offset = ftell (fp);
+  line = trace_file_status_line (ts, status_width);
+  fputs (line, fp);
+  xfree (line);
 
   /* Note that we want to upload tracepoints and save those, rather
      than simply writing out the local ones, because the user may have
@@ -3157,6 +3175,52 @@ trace_save (const char *filename, int target_does_save)
   /* Mark the end of the definition section.  */
   fprintf (fp, "\n");
 
+  return status_offset;
+}
+
+/* Save tracepoint data to file named FILENAME.  If TARGET_DOES_SAVE is
+   non-zero, the save is performed on the target, otherwise GDB obtains all
+   trace data and saves it locally.  */
+
+void
+trace_save (const char *filename, int target_does_save)
+{
+  struct cleanup *cleanup;
+  char *pathname;
+  struct trace_status *ts = current_trace_status ();
+  int err, status;
+  FILE *fp;
+  LONGEST gotten = 0;
+  ULONGEST offset = 0;
+  gdb_byte buf[MAX_TRACE_UPLOAD];
+  int written;
+
+  /* If the target is to save the data to a file on its own, then just
+     send the command and be done with it.  */
+  if (target_does_save)
+    {
+      err = target_save_trace_data (filename);
+      if (err < 0)
+	error (_("Target failed to save trace data to '%s'."),
+	       filename);
+      return;
+    }
+
+  /* Get the trace status first before opening the file, so if the
+     target is losing, we can get out without touching files.  */
+  status = target_get_trace_status (ts);
+
+  pathname = tilde_expand (filename);
+  cleanup = make_cleanup (xfree, pathname);
+
+  fp = fopen (pathname, "wb");
+  if (!fp)
+    error (_("Unable to open file '%s' for saving trace data (%s)"),
+	   filename, safe_strerror (errno));
+  make_cleanup_fclose (fp);
+
+  trace_file_write_definitions (fp, pathname, ts, 0);
+
   /* Get and write the trace data proper.  We ask for big blocks, in
      the hopes of efficiency, but will take less if the target has
      packet size limitations or some such.  */
@@ -3217,6 +3281,327 @@ trace_save_command (char *args, int from_tty)
   do_cleanups (back_to);
 }
 
+/* Streaming of trace data to a trace file while tracing goes on.  The
+   target sends us the traceframes at the start of its buffer and then
+   discards them, so a long run doesn't need a buffer holding all of
+   it, and "tsave" at the end doesn't have to download it all.  */
+
+/* The trace file we stream to, or NULL if not streaming.  */
+static FILE *trace_stream_fp;
+static char *trace_stream_filename;
+
+/* The offset of the status line in the trace file, which we rewrite
+   when the run ends.  */
+static long trace_stream_status_offset;
+
+/* Trace data of a traceframe we only have part of.  */
+static gdb_byte *trace_stream_pending;
+static LONGEST trace_stream_pending_len;
+static LONGEST trace_stream_pending_size;
+
+/* The number of traceframes written to the trace file.  */
+static int trace_stream_frames;
+
+/* The timer that polls the target for trace data, or -1.  */
+static int trace_stream_timer = -1;
+
+/* The width of the status line, which leaves room for the final
+   status of the run.  */
+#define TRACE_STREAM_STATUS_WIDTH 512
+
+/* How often to poll the target for trace data, in milliseconds.  */
+#define TRACE_STREAM_INTERVAL 500
+
+/* How much trace data to ask for at once.  */
+#define TRACE_STREAM_CHUNK 65536
+
+/* The most data to read from the target in a single poll, so that a
+   busy run doesn't keep GDB from the user.  */
+#define TRACE_STREAM_POLL_MAX (16 * TRACE_STREAM_CHUNK)
+
+/* Write an end of trace data marker at the current position of the
+   trace file, and position the file back on it, so that the file is
+   valid at all times.  */
+
+static void
+trace_stream_write_end_marker (void)
+{
+  static const gdb_byte zero[4];
+
+  if (fwrite (zero, sizeof (zero), 1, trace_stream_fp) < 1
+      || fflush (trace_stream_fp) != 0
+      || fseek (trace_stream_fp, -(long) sizeof (zero), SEEK_CUR) != 0)
+    perror_with_name (trace_stream_filename);
+}
+
+/* Append LEN bytes of trace data at DATA to the trace file.  Only
+   whole traceframes are written; the rest is kept until the target
+   sends the end of the traceframe.  */
+
+static void
+trace_stream_write (const gdb_byte *data, LONGEST len)
+{
+  enum bfd_endian byte_order = gdbarch_byte_order (target_gdbarch ());
+  LONGEST complete = 0;
+
+  if (trace_stream_pending_len + len > trace_stream_pending_size)
+    {
+      trace_stream_pending_size = 2 * (trace_stream_pending_len + len);
+      trace_stream_pending = xrealloc (trace_stream_pending,
+				       trace_stream_pending_size);
+    }
+  memcpy (trace_stream_pending + trace_stream_pending_len, data, len);
+  trace_stream_pending_len += len;
+
+  /* Each traceframe starts with its tracepoint number and the size of
+     its data, like in the file.  */
+  while (trace_stream_pending_len - complete >= 6)
+    {
+      ULONGEST data_size
+	= extract_unsigned_integer (trace_stream_pending + complete + 2, 4,
+				    byte_order);
+
+      if (trace_stream_pending_len - complete < 6 + data_size)
+	break;
+      complete += 6 + data_size;
+      trace_stream_frames++;
+    }
+
+  if (complete == 0)
+    return;
+
+  if (fwrite (trace_stream_pending, complete, 1, trace_stream_fp) < 1)
+    perror_with_name (trace_stream_filename);
+  trace_stream_write_end_marker ();
+
+  trace_stream_pending_len -= complete;
+  memmove (trace_stream_pending, trace_stream_pending + complete,
+	   trace_stream_pending_len);
+}
+
+/* Move the trace data the target has to the trace file, reading at
+   most MAX bytes if positive.  Return how much was read, or -1 if the
+   target can't stream trace data, e.g. because it went away.  */
+
+static LONGEST
+trace_stream_drain (LONGEST max)
+{
+  gdb_byte *buf = xmalloc (TRACE_STREAM_CHUNK);
+  struct cleanup *old_chain = make_cleanup (xfree, buf);
+  LONGEST total = 0;
+
+  while (max <= 0 || total < max)
+    {
+      LONGEST gotten = target_drain_trace_data (buf, TRACE_STREAM_CHUNK);
+
+      if (gotten < 0)
+	{
+	  total = -1;
+	  break;
+	}
+      if (gotten == 0)
+	break;
+      trace_stream_write (buf, gotten);
+      total += gotten;
+    }
+
+  do_cleanups (old_chain);
+  return total;
+}
+
+/* Stop streaming, recording the final status of the run in the trace
+   file.  */
+
+static void
+trace_stream_close (void)
+{
+  struct trace_status ts = *current_trace_status ();
+  char *line;
+
+  if (trace_stream_timer != -1)
+    {
+      delete_timer (trace_stream_timer);
+      trace_stream_timer = -1;
+    }
+
+  if (trace_stream_pending_len > 0)
+    warning (_("Trace file '%s' is missing the last traceframe, "
+	       "which was only partially received."),
+	     trace_stream_filename);
+
+  ts.traceframe_count = trace_stream_frames;
+  line = trace_file_status_line (&ts, TRACE_STREAM_STATUS_WIDTH);
+  if (strlen (line) == TRACE_STREAM_STATUS_WIDTH)
+    {
+      if (fseek (trace_stream_fp, trace_stream_status_offset, SEEK_SET) != 0
+	  || fputs (line, trace_stream_fp) == EOF)
+	warning (_("Couldn't write the status of the run to '%s': %s"),
+		 trace_stream_filename, safe_strerror (errno));
+    }
+  xfree (line);
+
+  if (fclose (trace_stream_fp) != 0)
+    warning (_("Couldn't write trace file '%s': %s"),
+	     trace_stream_filename, safe_strerror (errno));
+  printf_filtered (_("Streamed %d traceframes to file '%s'.\n"),
+		   trace_stream_frames, trace_stream_filename);
+
+  trace_stream_fp = NULL;
+  xfree (trace_stream_filename);
+  trace_stream_filename = NULL;
+  xfree (trace_stream_pending);
+  trace_stream_pending = NULL;
+  trace_stream_pending_len = trace_stream_pending_size = 0;
+  trace_stream_frames = 0;
+}
+
+/* Called when the tracing run ends, or before GDB leaves the target.
+   Get the rest of the trace data and close the trace file.  */
+
+static void
+trace_stream_finish (void)
+{
+  volatile struct gdb_exception ex;
+
+  if (trace_stream_fp == NULL)
+    return;
+
+  TRY_CATCH (ex, RETURN_MASK_ERROR)
+    {
+      if (traceframe_number == -1)
+	trace_stream_drain (0);
+      target_get_trace_status (current_trace_status ());
+    }
+  if (ex.reason < 0)
+    warning (_("Error streaming trace data: %s"), ex.message);
+
+  trace_stream_close ();
+}
+
+/* Read the trace data the target has, if we can talk to it now.
+   Return 0 if the tracing run is over.  */
+
+static int
+trace_stream_poll (void)
+{
+  volatile struct gdb_exception ex;
+  int running = 1;
+
+  /* The target numbers traceframes from the start of its buffer, so
+     leave it alone while the user looks at one.  */
+  if (traceframe_number != -1 || (!non_stop && any_running ()))
+    return 1;
+
+  TRY_CATCH (ex, RETURN_MASK_ERROR)
+    {
+      LONGEST gotten = trace_stream_drain (TRACE_STREAM_POLL_MAX);
+
+      if (gotten < 0)
+	{
+	  /* Nothing more to get.  */
+	  trace_stream_close ();
+	  running = 0;
+	}
+      else if (gotten == 0)
+	{
+	  struct trace_status *ts = current_trace_status ();
+
+	  if (target_get_trace_status (ts) < 0 || !ts->running)
+	    {
+	      trace_stream_finish ();
+	      running = 0;
+	    }
+	}
+    }
+  if (ex.reason < 0)
+    {
+      warning (_("Error streaming trace data: %s"), ex.message);
+      trace_stream_close ();
+      return 0;
+    }
+
+  return running;
+}
+
+static void
+trace_stream_timer_handler (gdb_client_data data)
+{
+  trace_stream_timer = -1;
+
+  if (trace_stream_fp != NULL && trace_stream_poll ())
+    trace_stream_timer = create_timer (TRACE_STREAM_INTERVAL,
+				       trace_stream_timer_handler, NULL);
+}
+
+/* Drain the target when the program stops, in case the timer can't
+   run while it is running.  */
+
+static void
+trace_stream_normal_stop (struct bpstats *bs, int print_frame)
+{
+  if (trace_stream_fp != NULL)
+    trace_stream_poll ();
+}
+
+static void
+trace_stream_command (char *args, int from_tty)
+{
+  struct trace_status *ts = current_trace_status ();
+  struct cleanup *cleanup;
+  char *pathname;
+  FILE *fp;
+
+  if (args == NULL || *args == '\0')
+    {
+      if (trace_stream_fp != NULL)
+	printf_filtered (_("Streaming trace data to file '%s', "
+			   "%d traceframes so far.\n"),
+			 trace_stream_filename, trace_stream_frames);
+      else
+	printf_filtered (_("Not streaming trace data.\n"));
+      return;
+    }
+
+  if (trace_stream_fp != NULL)
+    error (_("Already streaming trace data to file '%s'."),
+	   trace_stream_filename);
+
+  if (target_get_trace_status (ts) < 0 || !ts->running)
+    error (_("Trace is not running."));
+
+  if (traceframe_number != -1)
+    error (_("Cannot start streaming while looking at a traceframe."));
+
+  /* Ask for nothing, just to know if the target can do it.  */
+  if (target_drain_trace_data (NULL, 0) < 0)
+    error (_("Target does not support streaming trace data."));
+
+  pathname = tilde_expand (args);
+  cleanup = make_cleanup (xfree, pathname);
+
+  fp = fopen (pathname, "wb");
+  if (!fp)
+    error (_("Unable to open file '%s' for saving trace data (%s)"),
+	   args, safe_strerror (errno));
+  make_cleanup_fclose (fp);
+
+  trace_stream_status_offset
+    = trace_file_write_definitions (fp, pathname, ts,
+				    TRACE_STREAM_STATUS_WIDTH);
+
+  discard_cleanups (cleanup);
+  trace_stream_fp = fp;
+  trace_stream_filename = pathname;
+  trace_stream_write_end_marker ();
+
+  if (from_tty)
+    printf_filtered (_("Streaming trace data to file '%s'.\n"), args);
+
+  if (trace_stream_poll ())
+    trace_stream_timer = create_timer (TRACE_STREAM_INTERVAL,
+				       trace_stream_timer_handler, NULL);
+}
+
 /* Tell the target what to do with an ongoing tracing run if GDB
    disconnects for some reason.  */
 
@@ -3703,9 +4088,83 @@ static off_t cur_offset;
 static int cur_data_size;
 int trace_regblock_size;
 
+/* An entry of the index of the traceframes in the trace file.  */
+
+typedef struct tfile_frame
+{
+  /* The offset in the file of the traceframe's data, just past its
+     header.  */
+  off_t offset;
+
+  /* The size of the traceframe's data.  */
+  unsigned int data_size;
+
+  /* The number on the target of the tracepoint that collected the
+     traceframe.  */
+  short tpnum;
+} tfile_frame_s;
+
+DEF_VEC_O(tfile_frame_s);
+
+DEF_VEC_I(int);
+
+/* The traceframes of a tracepoint.  */
+
+typedef struct tfile_tp_frames
+{
+  /* The number on the target of the tracepoint.  */
+  short tpnum;
+
+  /* The numbers of the traceframes it collected, in increasing
+     order.  */
+  VEC(int) *frames;
+} tfile_tp_frames_s;
+
+DEF_VEC_O(tfile_tp_frames_s);
+
+/* The index of the traceframes in the trace file, indexed by
+   traceframe number, and the traceframes of each tracepoint.  Both
+   are built by tfile_build_index when first needed, so that tfind
+   does not have to scan the file from its start each time.  */
+
+static VEC(tfile_frame_s) *tfile_frames;
+static VEC(tfile_tp_frames_s) *tfile_tp_frames;
+static int tfile_index_built;
+
+/* A block of the traceframe at CUR_OFFSET.  */
+
+typedef struct tfile_block
+{
+  /* The block type.  */
+  char type;
+
+  /* The position of the block's contents, just past its type,
+     relative to the start of the traceframe.  */
+  int pos;
+
+  /* For 'M' blocks, the address and length of the memory.  */
+  ULONGEST maddr;
+  unsigned short mlen;
+} tfile_block_s;
+
+DEF_VEC_O(tfile_block_s);
+
+/* The blocks of the traceframe at TFILE_BLOCKS_OFFSET, so that
+   reading registers and memory from the current traceframe does not
+   walk all its blocks each time.  */
+
+static VEC(tfile_block_s) *tfile_blocks;
+static off_t tfile_blocks_offset = -1;
+
+/* Whether TFILE_BLOCKS has all the blocks of its traceframe.  It
+   doesn't if walking them hit an error.  */
+
+static int tfile_blocks_complete;
+
 static void tfile_interp_line (char *line,
 			       struct uploaded_tp **utpp,
 			       struct uploaded_tsv **utsvp);
+static void tfile_free_index (void);
 
 /* Read SIZE bytes into READBUF from the trace frame, starting at
    TRACE_FD's current position.  Note that this call `read'
@@ -4228,6 +4687,8 @@ tfile_close (int quitting)
   trace_fd = -1;
   xfree (trace_filename);
   trace_filename = NULL;
+
+  tfile_free_index ();
 }
 
 static void
@@ -4254,54 +4715,153 @@ tfile_get_tracepoint_status (struct breakpoint *tp, struct uploaded_tp *utp)
      trace files, so nothing to do here.  */
 }
 
-/* Given the position of a traceframe in the file, figure out what
-   address the frame was collected at.  This would normally be the
-   value of a collected PC register, but if not available, we
-   improvise.  */
+/* Free the index of the trace file's traceframes and blocks.  */
+
+static void
+tfile_free_index (void)
+{
+  struct tfile_tp_frames *tpf;
+  int ix;
+
+  for (ix = 0; VEC_iterate (tfile_tp_frames_s, tfile_tp_frames, ix, tpf);
+       ix++)
+    VEC_free (int, tpf->frames);
+  VEC_free (tfile_tp_frames_s, tfile_tp_frames);
+  VEC_free (tfile_frame_s, tfile_frames);
+  tfile_index_built = 0;
+
+  VEC_free (tfile_block_s, tfile_blocks);
+  tfile_blocks_offset = -1;
+}
+
+/* Cleanup wrapper for tfile_free_index.  */
+
+static void
+tfile_free_index_cleanup (void *arg)
+{
+  tfile_free_index ();
+}
+
+/* Read the headers of all the traceframes in the trace file, and
+   record where each traceframe is, and which traceframes each
+   tracepoint collected.  */
+
+static void
+tfile_build_index (void)
+{
+  enum bfd_endian byte_order = gdbarch_byte_order (target_gdbarch ());
+  struct cleanup *old_chain;
+  off_t offset;
+
+  if (tfile_index_built)
+    return;
+
+  /* Don't leave a partial index behind on errors.  */
+  old_chain = make_cleanup (tfile_free_index_cleanup, NULL);
+
+  lseek (trace_fd, trace_frames_offset, SEEK_SET);
+  offset = trace_frames_offset;
+  while (1)
+    {
+      struct tfile_frame *frame;
+      struct tfile_tp_frames *tpf;
+      gdb_byte buf[4];
+      short tpnum;
+      int tfnum, ix;
+
+      tfile_read (buf, 2);
+      tpnum = (short) extract_signed_integer (buf, 2, byte_order);
+      offset += 2;
+      if (tpnum == 0)
+	break;
+
+      tfnum = VEC_length (tfile_frame_s, tfile_frames);
+      frame = VEC_safe_push (tfile_frame_s, tfile_frames, NULL);
+      frame->tpnum = tpnum;
+      tfile_read (buf, 4);
+      frame->data_size
+	= (unsigned int) extract_unsigned_integer (buf, 4, byte_order);
+      offset += 4;
+      frame->offset = offset;
+
+      /* There are usually few tracepoints, so a linear search is
+	 fine here.  */
+      for (ix = 0;
+	   VEC_iterate (tfile_tp_frames_s, tfile_tp_frames, ix, tpf);
+	   ix++)
+	if (tpf->tpnum == tpnum)
+	  break;
+      if (tpf == NULL)
+	{
+	  tpf = VEC_safe_push (tfile_tp_frames_s, tfile_tp_frames, NULL);
+	  tpf->tpnum = tpnum;
+	  tpf->frames = NULL;
+	}
+      VEC_safe_push (int, tpf->frames, tfnum);
+
+      /* Skip past the traceframe's data.  */
+      offset += frame->data_size;
+      lseek (trace_fd, offset, SEEK_SET);
+    }
+
+  discard_cleanups (old_chain);
+  tfile_index_built = 1;
+}
+
+/* Figure out what address the traceframes of tracepoint TPNUM were
+   collected at.  This would normally be the value of a collected PC
+   register, but if not available, we improvise.  */
 
 static ULONGEST
-tfile_get_traceframe_address (off_t tframe_offset)
+tfile_get_traceframe_address (short tpnum)
 {
   ULONGEST addr = 0;
-  short tpnum;
   struct tracepoint *tp;
-  off_t saved_offset = cur_offset;
 
   /* FIXME dig pc out of collected registers.  */
 
   /* Fall back to using tracepoint address.  */
-  lseek (trace_fd, tframe_offset, SEEK_SET);
-  tfile_read ((gdb_byte *) &tpnum, 2);
-  tpnum = (short) extract_signed_integer ((gdb_byte *) &tpnum, 2,
-					  gdbarch_byte_order
-					      (target_gdbarch ()));
-
   tp = get_tracepoint_by_number_on_target (tpnum);
   /* FIXME this is a poor heuristic if multiple locations.  */
   if (tp && tp->base.loc)
     addr = tp->base.loc->address;
 
-  /* Restore our seek position.  */
-  cur_offset = saved_offset;
-  lseek (trace_fd, cur_offset, SEEK_SET);
   return addr;
 }
 
-/* Given a type of search and some parameters, scan the collection of
-   traceframes in the file looking for a match.  When found, return
-   both the traceframe and tracepoint number, otherwise -1 for
-   each.  */
+/* Return the first of the traceframes collected by the tracepoint of
+   TPF whose number is greater than AFTER, or -1 if there's none.  */
+
+static int
+tfile_tp_frames_next (struct tfile_tp_frames *tpf, int after)
+{
+  int *frames = VEC_address (int, tpf->frames);
+  int lo = 0, hi = VEC_length (int, tpf->frames);
+
+  while (lo < hi)
+    {
+      int mid = lo + (hi - lo) / 2;
+
+      if (frames[mid] <= after)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+
+  return lo < VEC_length (int, tpf->frames) ? frames[lo] : -1;
+}
+
+/* Given a type of search and some parameters, look in the index of
+   the traceframes in the file for a match.  When found, return both
+   the traceframe and tracepoint number, otherwise -1 for each.  */
 
 static int
 tfile_trace_find (enum trace_find_type type, int num,
 		  ULONGEST addr1, ULONGEST addr2, int *tpp)
 {
-  short tpnum;
-  int tfnum = 0, found = 0;
-  unsigned int data_size;
-  struct tracepoint *tp;
-  off_t offset, tframe_offset;
-  ULONGEST tfaddr;
+  struct tfile_tp_frames *tpf;
+  struct tfile_frame *frame;
+  int tfnum = -1, ix;
 
   if (num == -1)
     {
@@ -4310,82 +4870,72 @@ tfile_trace_find (enum trace_find_type type, int num,
       return -1;
     }
 
-  lseek (trace_fd, trace_frames_offset, SEEK_SET);
-  offset = trace_frames_offset;
-  while (1)
-    {
-      tframe_offset = offset;
-      tfile_read ((gdb_byte *) &tpnum, 2);
-      tpnum = (short) extract_signed_integer ((gdb_byte *) &tpnum, 2,
-					      gdbarch_byte_order
-						  (target_gdbarch ()));
-      offset += 2;
-      if (tpnum == 0)
-	break;
-      tfile_read ((gdb_byte *) &data_size, 4);
-      data_size = (unsigned int) extract_unsigned_integer
-                                     ((gdb_byte *) &data_size, 4,
-				      gdbarch_byte_order (target_gdbarch ()));
-      offset += 4;
+  tfile_build_index ();
 
-      if (type == tfind_number)
-	{
-	  /* Looking for a specific trace frame.  */
-	  if (tfnum == num)
-	    found = 1;
-	}
-      else
+  if (type == tfind_number)
+    {
+      /* Looking for a specific trace frame.  */
+      if (num >= 0 && num < VEC_length (tfile_frame_s, tfile_frames))
+	tfnum = num;
+    }
+  else
+    {
+      /* Start from the _next_ trace frame, and take the first one
+	 collected by any of the tracepoints that match.  */
+      for (ix = 0;
+	   VEC_iterate (tfile_tp_frames_s, tfile_tp_frames, ix, tpf);
+	   ix++)
 	{
-	  /* Start from the _next_ trace frame.  */
-	  if (tfnum > traceframe_number)
+	  struct tracepoint *tp;
+	  ULONGEST tfaddr;
+	  int match = 0, next;
+
+	  switch (type)
 	    {
-	      switch (type)
-		{
-		case tfind_pc:
-		  tfaddr = tfile_get_traceframe_address (tframe_offset);
-		  if (tfaddr == addr1)
-		    found = 1;
-		  break;
-		case tfind_tp:
-		  tp = get_tracepoint (num);
-		  if (tp && tpnum == tp->number_on_target)
-		    found = 1;
-		  break;
-		case tfind_range:
-		  tfaddr = tfile_get_traceframe_address (tframe_offset);
-		  if (addr1 <= tfaddr && tfaddr <= addr2)
-		    found = 1;
-		  break;
-		case tfind_outside:
-		  tfaddr = tfile_get_traceframe_address (tframe_offset);
-		  if (!(addr1 <= tfaddr && tfaddr <= addr2))
-		    found = 1;
-		  break;
-		default:
-		  internal_error (__FILE__, __LINE__, _("unknown tfind type"));
-		}
+	    case tfind_pc:
+	      tfaddr = tfile_get_traceframe_address (tpf->tpnum);
+	      match = (tfaddr == addr1);
+	      break;
+	    case tfind_tp:
+	      tp = get_tracepoint (num);
+	      match = (tp && tpf->tpnum == tp->number_on_target);
+	      break;
+	    case tfind_range:
+	      tfaddr = tfile_get_traceframe_address (tpf->tpnum);
+	      match = (addr1 <= tfaddr && tfaddr <= addr2);
+	      break;
+	    case tfind_outside:
+	      tfaddr = tfile_get_traceframe_address (tpf->tpnum);
+	      match = !(addr1 <= tfaddr && tfaddr <= addr2);
+	      break;
+	    default:
+	      internal_error (__FILE__, __LINE__, _("unknown tfind type"));
 	    }
-	}
 
-      if (found)
-	{
-	  if (tpp)
-	    *tpp = tpnum;
-	  cur_offset = offset;
-	  cur_data_size = data_size;
+	  if (!match)
+	    continue;
 
-	  return tfnum;
+	  next = tfile_tp_frames_next (tpf, traceframe_number);
+	  if (next >= 0 && (tfnum < 0 || next < tfnum))
+	    tfnum = next;
 	}
-      /* Skip past the traceframe's data.  */
-      lseek (trace_fd, data_size, SEEK_CUR);
-      offset += data_size;
-      /* Update our own count of traceframes.  */
-      ++tfnum;
     }
-  /* Did not find what we were looking for.  */
+
+  if (tfnum < 0)
+    {
+      /* Did not find what we were looking for.  */
+      if (tpp)
+	*tpp = -1;
+      return -1;
+    }
+
+  frame = VEC_index (tfile_frame_s, tfile_frames, tfnum);
   if (tpp)
-    *tpp = -1;
-  return -1;
+    *tpp = frame->tpnum;
+  cur_offset = frame->offset;
+  cur_data_size = frame->data_size;
+
+  return tfnum;
 }
 
 /* Prototype of the callback passed to tframe_walk_blocks.  */
@@ -4472,6 +5022,96 @@ traceframe_find_block_type (char type_wanted, int pos)
   return traceframe_walk_blocks (match_blocktype, pos, &type_wanted);
 }
 
+/* Callback for traceframe_walk_blocks.  Records the blocks of the
+   current traceframe in TFILE_BLOCKS.  */
+
+static int
+record_block (char blocktype, void *data)
+{
+  enum bfd_endian byte_order = gdbarch_byte_order (target_gdbarch ());
+  struct tfile_block *block;
+
+  block = VEC_safe_push (tfile_block_s, tfile_blocks, NULL);
+  block->type = blocktype;
+  block->pos = lseek (trace_fd, 0, SEEK_CUR) - cur_offset;
+  block->maddr = 0;
+  block->mlen = 0;
+
+  if (blocktype == 'M')
+    {
+      gdb_byte buf[8];
+
+      tfile_read (buf, 8);
+      block->maddr = extract_unsigned_integer (buf, 8, byte_order);
+      tfile_read (buf, 2);
+      block->mlen
+	= (unsigned short) extract_unsigned_integer (buf, 2, byte_order);
+    }
+
+  return 0;
+}
+
+/* Callback for traceframe_walk_blocks that matches no block.  */
+
+static int
+match_no_block (char blocktype, void *data)
+{
+  return 0;
+}
+
+/* Make TFILE_BLOCKS list the blocks of the current traceframe, unless
+   it already does.  */
+
+static void
+tfile_read_blocks (void)
+{
+  volatile struct gdb_exception ex;
+
+  if (tfile_blocks_offset == cur_offset)
+    return;
+
+  VEC_truncate (tfile_block_s, tfile_blocks, 0);
+  tfile_blocks_offset = -1;
+
+  /* Keep the blocks before one we can't walk over, they may still be
+     what we are looking for.  */
+  TRY_CATCH (ex, RETURN_MASK_ERROR)
+    {
+      traceframe_walk_blocks (record_block, 0, NULL);
+    }
+  tfile_blocks_complete = (ex.reason == 0);
+  tfile_blocks_offset = cur_offset;
+}
+
+/* Return the first block of type TYPE of the current traceframe, or
+   NULL if there's none.  */
+
+static struct tfile_block *
+tfile_find_block (char type)
+{
+  struct tfile_block *block;
+  int ix;
+
+  tfile_read_blocks ();
+
+  for (ix = 0; VEC_iterate (tfile_block_s, tfile_blocks, ix, block); ix++)
+    if (block->type == type)
+      return block;
+
+  return NULL;
+}
+
+/* Called when the block looked for is not in TFILE_BLOCKS.  If the
+   traceframe's blocks could not all be walked, throw the error that
+   stopped us, as looking for the block in the file would.  */
+
+static void
+tfile_blocks_check_complete (void)
+{
+  if (!tfile_blocks_complete)
+    traceframe_walk_blocks (match_no_block, 0, NULL);
+}
+
 /* Look for a block of saved registers in the traceframe, and get the
    requested register from it.  */
 
@@ -4482,6 +5122,7 @@ tfile_fetch_registers (struct target_ops *ops,
   struct gdbarch *gdbarch = get_regcache_arch (regcache);
   int offset, regn, regsize, pc_regno;
   char *regs;
+  struct tfile_block *block;
 
   /* An uninitialized reg size says we're not going to be
      successful at getting register blocks.  */
@@ -4490,8 +5131,12 @@ tfile_fetch_registers (struct target_ops *ops,
 
   regs = alloca (trace_regblock_size);
 
-  if (traceframe_find_block_type ('R', 0) >= 0)
+  block = tfile_find_block ('R');
+  if (block == NULL)
+    tfile_blocks_check_complete ();
+  else
     {
+      lseek (trace_fd, cur_offset + block->pos, SEEK_SET);
       tfile_read (regs, trace_regblock_size);
 
       /* Assume the block is laid out in GDB register number order,
@@ -4573,22 +5218,19 @@ tfile_xfer_partial (struct target_ops *ops, enum target_object object,
 
  if (traceframe_number != -1)
     {
-      int pos = 0;
+      struct tfile_block *block;
+      int ix;
 
       /* Iterate through the traceframe's blocks, looking for
 	 memory.  */
-      while ((pos = traceframe_find_block_type ('M', pos)) >= 0)
+      tfile_read_blocks ();
+      for (ix = 0; VEC_iterate (tfile_block_s, tfile_blocks, ix, block); ix++)
 	{
-	  ULONGEST maddr, amt;
-	  unsigned short mlen;
-	  enum bfd_endian byte_order = gdbarch_byte_order (target_gdbarch ());
+	  ULONGEST maddr = block->maddr, amt;
+	  unsigned short mlen = block->mlen;
 
-	  tfile_read ((gdb_byte *) &maddr, 8);
-	  maddr = extract_unsigned_integer ((gdb_byte *) &maddr, 8,
-					    byte_order);
-	  tfile_read ((gdb_byte *) &mlen, 2);
-	  mlen = (unsigned short)
-	    extract_unsigned_integer ((gdb_byte *) &mlen, 2, byte_order);
+	  if (block->type != 'M')
+	    continue;
 
 	  /* If the block includes the first part of the desired
 	     range, return as much it has; GDB will re-request the
@@ -4600,15 +5242,13 @@ tfile_xfer_partial (struct target_ops *ops, enum target_object object,
 	      if (amt > len)
 		amt = len;
 
-	      if (maddr != offset)
-	        lseek (trace_fd, offset - maddr, SEEK_CUR);
+	      lseek (trace_fd, cur_offset + block->pos + 8 + 2
+		     + (offset - maddr), SEEK_SET);
 	      tfile_read (readbuf, amt);
 	      return amt;
 	    }
-
-	  /* Skip over this block.  */
-	  pos += (8 + 2 + mlen);
 	}
+      tfile_blocks_check_complete ();
     }
 
   /* It's unduly pedantic to refuse to look at the executable for
@@ -5282,6 +5922,16 @@ Save the trace data to a file.\n\
 Use the '-r' option to direct the target to save directly to the file,\n\
 using its own filesystem."));
 
+  c = add_com ("tstream", class_trace, trace_stream_command, _("\
+Stream the trace data to a file while tracing goes on.\n\
+Usage: tstream FILE\n\
+The target discards the trace data GDB has streamed, making room for more.\n\
+The file is completed when the run stops.  Without argument, show where\n\
+trace data is streamed to."));
+  set_cmd_completer (c, filename_completer);
+
+  observer_attach_normal_stop (trace_stream_normal_stop);
+
   c = add_com ("tvariable", class_trace, trace_variable_command,_("\
 Define a trace state variable.\n\
 Argument is a $-prefixed name, optionally followed\n\
@@ -382,6 +382,10 @@ struct mem_file
     int length_buffer;
   };
 
+/* The largest buffer a mem_file keeps for reuse when it is rewound.  */
+
+#define MEM_FILE_KEEP_SIZE (64 * 1024)
+
 static ui_file_rewind_ftype mem_file_rewind;
 static ui_file_put_ftype mem_file_put;
 static ui_file_write_ftype mem_file_write;
@@ -434,6 +438,15 @@ mem_file_rewind (struct ui_file *file)
     internal_error (__FILE__, __LINE__,
 		    _("mem_file_rewind: bad magic number"));
   stream->length_buffer = 0;
+
+  /* Don't hold on to the memory of an unusually large output once it
+     has been consumed.  */
+  if (stream->sizeof_buffer > MEM_FILE_KEEP_SIZE)
+    {
+      xfree (stream->buffer);
+      stream->buffer = NULL;
+      stream->sizeof_buffer = 0;
+    }
 }
 
 static void
@@ -473,7 +486,9 @@ mem_file_write (struct ui_file *file,
 
       if (new_length >= stream->sizeof_buffer)
 	{
-	  stream->sizeof_buffer = new_length;
+	  /* Grow geometrically, so that building a large output a few
+	     bytes at a time does not reallocate the buffer each time.  */
+	  stream->sizeof_buffer = max (new_length, stream->sizeof_buffer * 2);
 	  stream->buffer = xrealloc (stream->buffer, stream->sizeof_buffer);
 	}
       memcpy (stream->buffer + stream->length_buffer, buffer, length_buffer);
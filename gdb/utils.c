@@ -1582,15 +1582,15 @@ parse_escape (struct gdbarch *gdbarch, char **string_ptr)
   return target_char;
 }
 
-/* Print the character C on STREAM as part of the contents of a literal
-   string whose delimiter is QUOTER.  Note that this routine should only
-   be call for printing things which are independent of the language
-   of the program being debugged.  */
+/* Store in BUF the text that represents the character C as part of
+   the contents of a literal string whose delimiter is QUOTER, and
+   return its length.  BUF must have room for at least
+   MAX_ESCAPED_CHAR_LEN characters; it is not NUL-terminated.  */
 
-static void
-printchar (int c, void (*do_fputs) (const char *, struct ui_file *),
-	   void (*do_fprintf) (struct ui_file *, const char *, ...)
-	   ATTRIBUTE_FPTR_PRINTF_2, struct ui_file *stream, int quoter)
+#define MAX_ESCAPED_CHAR_LEN 4
+
+static int
+escape_char (int c, int quoter, char *buf)
 {
   c &= 0xFF;			/* Avoid sign bit follies */
 
@@ -1598,42 +1598,65 @@ printchar (int c, void (*do_fputs) (const char *, struct ui_file *),
       (c >= 0x7F && c < 0xA0) ||	/* DEL, High controls */
       (sevenbit_strings && c >= 0x80))
     {				/* high order bit set */
+      buf[0] = '\\';
       switch (c)
 	{
 	case '\n':
-	  do_fputs ("\\n", stream);
-	  break;
+	  buf[1] = 'n';
+	  return 2;
 	case '\b':
-	  do_fputs ("\\b", stream);
-	  break;
+	  buf[1] = 'b';
+	  return 2;
 	case '\t':
-	  do_fputs ("\\t", stream);
-	  break;
+	  buf[1] = 't';
+	  return 2;
 	case '\f':
-	  do_fputs ("\\f", stream);
-	  break;
+	  buf[1] = 'f';
+	  return 2;
 	case '\r':
-	  do_fputs ("\\r", stream);
-	  break;
+	  buf[1] = 'r';
+	  return 2;
 	case '\033':
-	  do_fputs ("\\e", stream);
-	  break;
+	  buf[1] = 'e';
+	  return 2;
 	case '\007':
-	  do_fputs ("\\a", stream);
-	  break;
+	  buf[1] = 'a';
+	  return 2;
 	default:
-	  do_fprintf (stream, "\\%.3o", (unsigned int) c);
-	  break;
+	  buf[1] = '0' + ((c >> 6) & 07);
+	  buf[2] = '0' + ((c >> 3) & 07);
+	  buf[3] = '0' + (c & 07);
+	  return 4;
 	}
     }
+  else if (c == '\\' || c == quoter)
+    {
+      buf[0] = '\\';
+      buf[1] = c;
+      return 2;
+    }
   else
     {
-      if (c == '\\' || c == quoter)
-	do_fputs ("\\", stream);
-      do_fprintf (stream, "%c", c);
+      buf[0] = c;
+      return 1;
     }
 }
 
+/* Print the character C on STREAM as part of the contents of a literal
+   string whose delimiter is QUOTER.  Note that this routine should only
+   be call for printing things which are independent of the language
+   of the program being debugged.  */
+
+static void
+printchar (int c, void (*do_fputs) (const char *, struct ui_file *),
+	   struct ui_file *stream, int quoter)
+{
+  char buf[MAX_ESCAPED_CHAR_LEN + 1];
+
+  buf[escape_char (c, quoter, buf)] = '\0';
+  do_fputs (buf, stream);
+}
+
 /* Print the character C on STREAM as part of the contents of a
    literal string whose delimiter is QUOTER.  Note that these routines
    should only be call for printing things which are independent of
@@ -1643,14 +1666,13 @@ void
 fputstr_filtered (const char *str, int quoter, struct ui_file *stream)
 {
   while (*str)
-    printchar (*str++, fputs_filtered, fprintf_filtered, stream, quoter);
+    printchar (*str++, fputs_filtered, stream, quoter);
 }
 
 void
 fputstr_unfiltered (const char *str, int quoter, struct ui_file *stream)
 {
-  while (*str)
-    printchar (*str++, fputs_unfiltered, fprintf_unfiltered, stream, quoter);
+  fputstrn_unfiltered (str, strlen (str), quoter, stream);
 }
 
 void
@@ -1660,17 +1682,38 @@ fputstrn_filtered (const char *str, int n, int quoter,
   int i;
 
   for (i = 0; i < n; i++)
-    printchar (str[i], fputs_filtered, fprintf_filtered, stream, quoter);
+    printchar (str[i], fputs_filtered, stream, quoter);
 }
 
+/* The unfiltered variants are not subject to paging, so they escape
+   the string into a bounded buffer and write it out one chunk at a
+   time.  This matters for MI, which quotes every field this way.  */
+
+#define ESCAPED_CHUNK_SIZE 1024
+
 void
 fputstrn_unfiltered (const char *str, int n, int quoter,
 		     struct ui_file *stream)
 {
-  int i;
+  char buf[ESCAPED_CHUNK_SIZE + MAX_ESCAPED_CHAR_LEN + 1];
+  int i, len = 0;
 
   for (i = 0; i < n; i++)
-    printchar (str[i], fputs_unfiltered, fprintf_unfiltered, stream, quoter);
+    {
+      len += escape_char (str[i], quoter, buf + len);
+      if (len >= ESCAPED_CHUNK_SIZE)
+	{
+	  buf[len] = '\0';
+	  fputs_unfiltered (buf, stream);
+	  len = 0;
+	}
+    }
+
+  if (len > 0)
+    {
+      buf[len] = '\0';
+      fputs_unfiltered (buf, stream);
+    }
 }
 
 
@@ -1108,6 +1108,94 @@ value_fetch_lazy (struct value *val)
   return 0;
 }
 
+/* Return the number of bytes value_fetch_lazy reads from memory for
+   VAL, or zero if VAL is not a lazy memory value value_prefetch_lazy
+   can fetch.  */
+
+static ULONGEST
+prefetchable_value_length (struct value *val)
+{
+  if (!value_lazy (val)
+      || VALUE_LVAL (val) != lval_memory
+      || value_bitsize (val) != 0)
+    return 0;
+
+  return TYPE_LENGTH (check_typedef (value_enclosing_type (val)));
+}
+
+/* See value.h.  */
+
+void
+value_prefetch_lazy (struct value **values, int count)
+{
+  int i, j;
+
+  /* Let value_fetch_lazy sort out which parts of a traceframe's memory
+     are available.  */
+  if (get_traceframe_number () >= 0)
+    return;
+
+  for (i = 0; i < count; i = j)
+    {
+      ULONGEST len, total;
+      CORE_ADDR start;
+      gdb_byte *buffer;
+      struct cleanup *old_chain;
+      int stack, status;
+
+      len = prefetchable_value_length (values[i]);
+      if (len == 0)
+	{
+	  j = i + 1;
+	  continue;
+	}
+
+      /* Find the run of values that follow each other in memory.  */
+      start = value_address (values[i]);
+      stack = value_stack (values[i]);
+      total = len;
+      for (j = i + 1; j < count; j++)
+	{
+	  len = prefetchable_value_length (values[j]);
+	  if (len == 0
+	      || value_address (values[j]) != start + total
+	      || value_stack (values[j]) != stack)
+	    break;
+	  total += len;
+	}
+
+      if (j - i < 2)
+	continue;
+
+      buffer = xmalloc (total);
+      old_chain = make_cleanup (xfree, buffer);
+
+      if (stack)
+	status = target_read_stack (start, buffer, total);
+      else
+	status = target_read_memory (start, buffer, total);
+
+      /* If the run can't be read in one go, leave the values lazy;
+	 value_fetch_lazy reports the error for the one that fails.  */
+      if (status == 0)
+	{
+	  ULONGEST offset = 0;
+	  int k;
+
+	  for (k = i; k < j; k++)
+	    {
+	      len = prefetchable_value_length (values[k]);
+	      memcpy (value_contents_all_raw (values[k]), buffer + offset,
+		      len);
+	      set_value_lazy (values[k], 0);
+	      offset += len;
+	    }
+	}
+
+      do_cleanups (old_chain);
+    }
+}
+
 void
 read_value_memory (struct value *val, int embedded_offset,
 		   int stack, CORE_ADDR memaddr,
@@ -2007,28 +2095,39 @@ do_search_struct_field (const char *name, struct value *arg1, int offset,
   nbases = TYPE_N_BASECLASSES (type);
 
   if (!looking_for_baseclass)
-    for (i = TYPE_NFIELDS (type) - 1; i >= nbases; i--)
+    {
+      int found = struct_field_by_name (type, name);
+
+      /* Search the fields from the last one, looking into the
+	 anonymous structures and unions that come after the last field
+	 named NAME before settling for it.  */
+      for (i = struct_prev_anonymous_field (type, TYPE_NFIELDS (type));
+	   ;
+	   i = struct_prev_anonymous_field (type, i))
       {
-	const char *t_field_name = TYPE_FIELD_NAME (type, i);
+	const char *t_field_name;
 
-	if (t_field_name && (strcmp_iw (t_field_name, name) == 0))
+	if (found >= 0 && found >= i)
 	  {
 	    struct value *v;
 
-	    if (field_is_static (&TYPE_FIELD (type, i)))
+	    if (field_is_static (&TYPE_FIELD (type, found)))
 	      {
-		v = value_static_field (type, i);
+		v = value_static_field (type, found);
 		if (v == 0)
 		  error (_("field %s is nonexistent or "
 			   "has been optimized out"),
 			 name);
 	      }
 	    else
-	      v = value_primitive_field (arg1, offset, i, type);
+	      v = value_primitive_field (arg1, offset, found, type);
 	    *result_ptr = v;
 	    return;
 	  }
+	if (i < 0)
+	  break;
 
+	t_field_name = TYPE_FIELD_NAME (type, i);
 	if (t_field_name
 	    && (t_field_name[0] == '\0'
 		|| (TYPE_CODE (type) == TYPE_CODE_UNION
@@ -2078,6 +2177,7 @@ do_search_struct_field (const char *name, struct value *arg1, int offset,
 	      }
 	  }
       }
+    }
 
   for (i = 0; i < nbases; i++)
     {
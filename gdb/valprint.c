@@ -1719,7 +1719,7 @@ partial_memory_read (CORE_ADDR memaddr, gdb_byte *myaddr,
   int errcode;			/* Error from last read.  */
 
   /* First try a complete read.  */
-  errcode = target_read_memory (memaddr, myaddr, len);
+  errcode = target_read_string_memory (memaddr, myaddr, len);
   if (errcode == 0)
     {
       /* Got it all.  */
@@ -1730,7 +1730,7 @@ partial_memory_read (CORE_ADDR memaddr, gdb_byte *myaddr,
       /* Loop, reading one byte at a time until we get as much as we can.  */
       for (errcode = 0, nread = 0; len > 0 && errcode == 0; nread++, len--)
 	{
-	  errcode = target_read_memory (memaddr++, myaddr++, 1);
+	  errcode = target_read_string_memory (memaddr++, myaddr++, 1);
 	}
       /* If an error, the last read was unsuccessful, so adjust count.  */
       if (errcode != 0)
@@ -1767,6 +1767,43 @@ partial_memory_read (CORE_ADDR memaddr, gdb_byte *myaddr,
    so it is more tested.  Perhaps callers of target_read_string should use
    this function instead?  */
 
+/* When strings are read through the data cache, read_string reads
+   NUL-terminated strings in chunks of up to STRING_READ_AHEAD bytes,
+   which usually covers the whole string in a single transfer.  A chunk
+   never crosses a STRING_READ_PAGE_SIZE boundary, so that reading past
+   the end of a string near the end of mapped memory does not fail, nor
+   the end of the memory region holding the string.  */
+
+#define STRING_READ_AHEAD 256
+#define STRING_READ_PAGE_SIZE 4096
+
+/* Return the number of characters of WIDTH bytes that read_string
+   should fetch from ADDR at once, when looking for a NUL terminator.
+   At most LIMIT characters are wanted.  */
+
+static unsigned int
+string_chunk_size (CORE_ADDR addr, int width, unsigned int limit)
+{
+  struct mem_region *region;
+  unsigned int chunk;
+
+  if (!target_string_cache_p (addr))
+    return min (8, limit);
+
+  chunk = STRING_READ_PAGE_SIZE - (addr & (STRING_READ_PAGE_SIZE - 1));
+  chunk = min (chunk, STRING_READ_AHEAD);
+
+  region = lookup_mem_region (addr);
+  if (region->hi != 0 && region->hi - addr < chunk)
+    chunk = region->hi - addr;
+
+  chunk /= width;
+  if (chunk == 0)
+    chunk = 1;
+
+  return min (chunk, limit);
+}
+
 int
 read_string (CORE_ADDR addr, int len, int width, unsigned int fetchlimit,
 	     enum bfd_endian byte_order, gdb_byte **buffer, int *bytes_read)
@@ -1774,7 +1811,6 @@ read_string (CORE_ADDR addr, int len, int width, unsigned int fetchlimit,
   int found_nul;		/* Non-zero if we found the nul char.  */
   int errcode;			/* Errno returned from bad reads.  */
   unsigned int nfetch;		/* Chars to fetch / chars fetched.  */
-  unsigned int chunksize;	/* Size of each fetch, in chars.  */
   gdb_byte *bufptr;		/* Pointer to next available byte in
 				   buffer.  */
   gdb_byte *limit;		/* First location past end of fetch buffer.  */
@@ -1787,9 +1823,9 @@ read_string (CORE_ADDR addr, int len, int width, unsigned int fetchlimit,
      well read in blocks that are large enough to be efficient, but not so
      large as to be slow if fetchlimit happens to be large.  So we choose the
      minimum of 8 and fetchlimit.  We used to use 200 instead of 8 but
-     200 is way too big for remote debugging over a serial line.  */
-
-  chunksize = (len == -1 ? min (8, fetchlimit) : fetchlimit);
+     200 is way too big for remote debugging over a serial line.  When
+     reads go through the data cache, the cache reads whole lines anyway,
+     so string_chunk_size reads further ahead.  */
 
   /* Loop until we either have all the characters, or we encounter
      some error, such as bumping into the end of the address space.  */
@@ -1816,7 +1852,7 @@ read_string (CORE_ADDR addr, int len, int width, unsigned int fetchlimit,
       do
 	{
 	  QUIT;
-	  nfetch = min (chunksize, fetchlimit - bufsize);
+	  nfetch = string_chunk_size (addr, width, fetchlimit - bufsize);
 
 	  if (*buffer == NULL)
 	    *buffer = (gdb_byte *) xmalloc (nfetch * width);
@@ -1877,6 +1913,78 @@ read_string (CORE_ADDR addr, int len, int width, unsigned int fetchlimit,
   return errcode;
 }
 
+/* Strings whose read-ahead blocks are closer than this many bytes
+   are prefetched by a single transfer, up to STRING_PREFETCH_MAX
+   bytes at a time.  */
+
+#define STRING_PREFETCH_GAP 256
+#define STRING_PREFETCH_MAX (4 * STRING_READ_PAGE_SIZE)
+
+/* qsort comparison function for CORE_ADDRs.  */
+
+static int
+compare_core_addr (const void *a, const void *b)
+{
+  CORE_ADDR aa = *(const CORE_ADDR *) a;
+  CORE_ADDR bb = *(const CORE_ADDR *) b;
+
+  if (aa < bb)
+    return -1;
+  else if (aa > bb)
+    return 1;
+  return 0;
+}
+
+/* Load into the data cache the beginning of the COUNT strings of
+   characters WIDTH bytes wide found at ADDRS, as read_string would
+   read them, with as few transfers as possible.  Strings that lie
+   close to each other, like the strings pointed to by argv, are read
+   together.  ADDRS is sorted in place.  */
+
+void
+prefetch_strings (CORE_ADDR *addrs, int count, int width)
+{
+  CORE_ADDR start = 0, end = 0, region_end = 0;
+  int i;
+
+  if (count < 2)
+    return;
+
+  qsort (addrs, count, sizeof (CORE_ADDR), compare_core_addr);
+
+  for (i = 0; i < count; i++)
+    {
+      CORE_ADDR addr = addrs[i];
+      CORE_ADDR block_end;
+
+      if (addr == 0 || !target_string_cache_p (addr))
+	continue;
+
+      block_end = addr + string_chunk_size (addr, width, UINT_MAX) * width;
+
+      /* Don't merge strings from different memory regions, or the
+	 transfer would read the memory in between.  */
+      if (end != 0
+	  && addr <= end + STRING_PREFETCH_GAP
+	  && (region_end == 0 || addr < region_end)
+	  && block_end - start <= STRING_PREFETCH_MAX)
+	{
+	  if (block_end > end)
+	    end = block_end;
+	  continue;
+	}
+
+      if (end != 0)
+	target_prefetch_string_memory (start, end - start);
+      start = addr;
+      end = block_end;
+      region_end = lookup_mem_region (addr)->hi;
+    }
+
+  if (end != 0)
+    target_prefetch_string_memory (start, end - start);
+}
+
 /* Return true if print_wchar can display W without resorting to a
    numeric escape, false otherwise.  */
 
@@ -2495,7 +2603,7 @@ val_print_string (struct type *elttype, const char *encoding,
 
       peekbuf = (gdb_byte *) alloca (width);
 
-      if (target_read_memory (addr, peekbuf, width) == 0
+      if (target_read_string_memory (addr, peekbuf, width) == 0
 	  && extract_unsigned_integer (peekbuf, width, byte_order) != 0)
 	force_ellipsis = 1;
     }
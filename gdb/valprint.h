@@ -158,6 +158,8 @@ extern int read_string (CORE_ADDR addr, int len, int width,
 			enum bfd_endian byte_order, gdb_byte **buffer,
 			int *bytes_read);
 
+extern void prefetch_strings (CORE_ADDR *addrs, int count, int width);
+
 extern void val_print_optimized_out (struct ui_file *stream);
 
 extern void val_print_unavailable (struct ui_file *stream);
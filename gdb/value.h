@@ -316,6 +316,12 @@ extern const gdb_byte *
   value_contents_for_printing_const (const struct value *value);
 
 extern int value_fetch_lazy (struct value *val);
+
+/* Fetch the contents of those of the COUNT lazy values in VALUES
+   that are laid out one after the other in memory, reading the memory
+   of each such run of values in a single transfer.  Values that
+   can't be fetched this way are left lazy.  */
+extern void value_prefetch_lazy (struct value **values, int count);
 extern int value_contents_equal (struct value *val1, struct value *val2);
 
 /* If nonzero, this is the value of a variable which does not actually
@@ -33,6 +33,8 @@
 #include "vec.h"
 #include "gdbthread.h"
 #include "inferior.h"
+#include "tracepoint.h"
+#include "observer.h"
 #include "ada-varobj.h"
 #include "ada-lang.h"
 
@@ -57,6 +59,24 @@ show_varobjdebug (struct ui_file *file, int from_tty,
   fprintf_filtered (file, _("Varobj debugging is %s.\n"), value);
 }
 
+/* Non-zero if -var-update should read the memory of each root varobj
+   in one go and skip the children whose bytes did not change.  */
+
+static int varobj_memory_diff = 0;
+static void
+show_varobj_memory_diff (struct ui_file *file, int from_tty,
+			 struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file, _("Comparing the memory of variable objects "
+			    "on update is %s.\n"),
+		    value);
+}
+
+/* The largest root varobj, in bytes, whose memory is compared on
+   update when varobj_memory_diff is set.  */
+
+#define VAROBJ_SNAPSHOT_MAX 65536
+
 /* String representations of gdb's format codes.  */
 char *varobj_format_string[] =
   { "natural", "binary", "decimal", "hexadecimal", "octal" };
@@ -112,6 +132,13 @@ struct varobj_root
   /* The varobj for this root node.  */
   struct varobj *rootvar;
 
+  /* When varobj_memory_diff is set, the contents of the root value's
+     memory as read by the last update, its address and its length.
+     SNAPSHOT is NULL if the root value is not in memory.  */
+  gdb_byte *snapshot;
+  CORE_ADDR snapshot_address;
+  int snapshot_length;
+
   /* Next root variable */
   struct varobj_root *next;
 };
@@ -276,6 +303,8 @@ static int update_type_if_necessary (struct varobj *var,
 static int install_new_value (struct varobj *var, struct value *value, 
 			      int initial);
 
+static int fetch_from_snapshot_blocks (struct value *value);
+
 /* Language-specific routines.  */
 
 static enum varobj_languages variable_language (struct varobj *var);
@@ -1029,10 +1058,19 @@ install_dynamic_child (struct varobj *var,
 		       const char *name,
 		       struct value *value)
 {
-  if (VEC_length (varobj_p, var->children) < index + 1)
+  if (VEC_length (varobj_p, var->children) < index + 1
+      || VEC_index (varobj_p, var->children, index) == NULL)
     {
       /* There's no child yet.  */
-      struct varobj *child = varobj_add_child (var, name, value);
+      struct varobj *child;
+
+      if (VEC_length (varobj_p, var->children) < index + 1)
+	child = varobj_add_child (var, name, value);
+      else
+	{
+	  child = create_child_with_value (var, index, name, value);
+	  VEC_replace (varobj_p, var->children, index, child);
+	}
 
       if (new)
 	{
@@ -1060,6 +1098,82 @@ install_dynamic_child (struct varobj *var,
     }
 }
 
+/* Create the children of the dynamic varobj VAR between FROM
+   (inclusive) and TO (exclusive) that are not yet instantiated.  Such
+   holes are left by update_dynamic_varobj_children for children
+   outside the range the front end asked for, and by -var-delete.
+   This uses a fresh iterator, so that VAR->child_iter is left where it
+   was.  */
+
+static void
+fill_dynamic_child_holes (struct varobj *var, int from, int to)
+{
+  struct cleanup *back_to;
+  PyObject *children, *iter;
+  int i;
+
+  for (i = from; i < to; ++i)
+    if (VEC_index (varobj_p, var->children, i) == NULL)
+      break;
+  if (i == to)
+    return;
+
+  back_to = varobj_ensure_python_env (var);
+
+  children = PyObject_CallMethodObjArgs (var->pretty_printer,
+					 gdbpy_children_cst, NULL);
+  if (!children)
+    {
+      gdbpy_print_stack ();
+      error (_("Null value returned for children"));
+    }
+  make_cleanup_py_decref (children);
+
+  iter = PyObject_GetIter (children);
+  if (!iter)
+    {
+      gdbpy_print_stack ();
+      error (_("Could not get children iterator"));
+    }
+  make_cleanup_py_decref (iter);
+
+  for (i = 0; i < to; ++i)
+    {
+      PyObject *item, *py_v;
+      const char *name;
+      struct value *v;
+      struct cleanup *inner;
+
+      item = PyIter_Next (iter);
+      if (!item)
+	{
+	  if (PyErr_Occurred ())
+	    gdbpy_print_stack ();
+	  break;
+	}
+      inner = make_cleanup_py_decref (item);
+
+      if (i >= from && VEC_index (varobj_p, var->children, i) == NULL)
+	{
+	  if (!PyArg_ParseTuple (item, "sO", &name, &py_v))
+	    {
+	      gdbpy_print_stack ();
+	      error (_("Invalid item from the child list"));
+	    }
+
+	  v = convert_value_from_python (py_v);
+	  if (v == NULL)
+	    gdbpy_print_stack ();
+	  VEC_replace (varobj_p, var->children, i,
+		       create_child_with_value (var, i, name, v));
+	}
+
+      do_cleanups (inner);
+    }
+
+  do_cleanups (back_to);
+}
+
 static int
 dynamic_varobj_has_child_method (struct varobj *var)
 {
@@ -1207,6 +1321,21 @@ update_dynamic_varobj_children (struct varobj *var,
 	      error (_("Invalid item from the child list"));
 	    }
 
+	  /* Do not instantiate children before the requested range;
+	     leave a hole that fill_dynamic_child_holes can fill if
+	     the front end asks for them later.  */
+	  if (!can_mention
+	      && (VEC_length (varobj_p, var->children) <= i
+		  || VEC_index (varobj_p, var->children, i) == NULL))
+	    {
+	      if (VEC_length (varobj_p, var->children) <= i)
+		VEC_safe_push (varobj_p, var->children, NULL);
+	      do_cleanups (inner);
+	      if (force_done)
+		break;
+	      continue;
+	    }
+
 	  v = convert_value_from_python (py_v);
 	  if (v == NULL)
 	    gdbpy_print_stack ();
@@ -1237,7 +1366,8 @@ update_dynamic_varobj_children (struct varobj *var,
 
       *cchanged = 1;
       for (j = i; j < VEC_length (varobj_p, var->children); ++j)
-	varobj_delete (VEC_index (varobj_p, var->children, j), NULL, 0);
+	if (VEC_index (varobj_p, var->children, j) != NULL)
+	  varobj_delete (VEC_index (varobj_p, var->children, j), NULL, 0);
       VEC_truncate (varobj_p, var->children, i);
     }
 
@@ -1294,8 +1424,11 @@ varobj_list_children (struct varobj *var, int *from, int *to)
 	 frontend noticing.  But well, calling -var-list-children on the same
 	 varobj twice is not something a sane frontend would do.  */
       update_dynamic_varobj_children (var, NULL, NULL, NULL, NULL,
-				      &children_changed, 0, 0, *to);
+				      &children_changed, 0, *from, *to);
       restrict_range (var->children, from, to);
+#if HAVE_PYTHON
+      fill_dynamic_child_holes (var, *from, *to);
+#endif
       return var->children;
     }
 
@@ -1311,7 +1444,10 @@ varobj_list_children (struct varobj *var, int *from, int *to)
   while (VEC_length (varobj_p, var->children) < var->num_children)
     VEC_safe_push (varobj_p, var->children, NULL);
 
-  for (i = 0; i < var->num_children; i++)
+  /* Only instantiate the children in the requested range.  */
+  restrict_range (var->children, from, to);
+
+  for (i = *from; i < *to; i++)
     {
       varobj_p existing = VEC_index (varobj_p, var->children, i);
 
@@ -1326,7 +1462,6 @@ varobj_list_children (struct varobj *var, int *from, int *to)
 	}
     }
 
-  restrict_range (var->children, from, to);
   return var->children;
 }
 
@@ -1758,7 +1893,8 @@ install_new_value (struct varobj *var, struct value *value, int initial)
 
 	  TRY_CATCH (except, RETURN_MASK_ERROR)
 	    {
-	      value_fetch_lazy (value);
+	      if (!fetch_from_snapshot_blocks (value))
+		value_fetch_lazy (value);
 	    }
 
 	  if (except.reason < 0)
@@ -1951,6 +2087,323 @@ varobj_value_has_mutated (struct varobj *var, struct value *new_value,
     return 0;
 }
 
+/* A range of target memory read in one transfer before the root
+   varobjs are updated, covering the snapshots of one or more roots.  */
+
+struct snapshot_block
+{
+  CORE_ADDR address;
+  ULONGEST length;
+  gdb_byte *contents;
+};
+
+typedef struct snapshot_block snapshot_block_s;
+DEF_VEC_O (snapshot_block_s);
+
+/* The blocks read by varobj_prefetch_root_snapshots, sorted by
+   address.  No two blocks overlap or are adjacent.  */
+
+static VEC (snapshot_block_s) *snapshot_blocks;
+
+/* qsort comparison function ordering snapshot blocks by address.  */
+
+static int
+compare_snapshot_blocks (const void *a, const void *b)
+{
+  const struct snapshot_block *block_a = a;
+  const struct snapshot_block *block_b = b;
+
+  if (block_a->address < block_b->address)
+    return -1;
+  else if (block_a->address > block_b->address)
+    return 1;
+  return 0;
+}
+
+/* Free the blocks read by varobj_prefetch_root_snapshots.  */
+
+static void
+discard_snapshot_blocks (void *ignore)
+{
+  struct snapshot_block *block;
+  int ix;
+
+  for (ix = 0;
+       VEC_iterate (snapshot_block_s, snapshot_blocks, ix, block);
+       ++ix)
+    xfree (block->contents);
+  VEC_free (snapshot_block_s, snapshot_blocks);
+}
+
+/* See varobj.h.  */
+
+struct cleanup *
+varobj_prefetch_root_snapshots (int only_floating)
+{
+  VEC (snapshot_block_s) *ranges = NULL;
+  struct cleanup *back_to;
+  struct varobj_root *root;
+  struct snapshot_block *range;
+  int ix;
+
+  discard_snapshot_blocks (NULL);
+
+  /* Running threads could change the memory between the bulk read and
+     the update of each root, and a traceframe may have only part of
+     the memory collected.  */
+  if (!varobj_memory_diff
+      || any_running ()
+      || get_traceframe_number () != -1)
+    return make_cleanup (null_cleanup, NULL);
+
+  back_to = make_cleanup (VEC_cleanup (snapshot_block_s), &ranges);
+
+  /* The previous snapshot of each root tells where its value will most
+     likely be found again.  */
+  for (root = rootlist; root != NULL; root = root->next)
+    {
+      struct snapshot_block r;
+
+      if (root->snapshot == NULL
+	  || root->rootvar->frozen
+	  || (only_floating && !root->floating))
+	continue;
+
+      r.address = root->snapshot_address;
+      r.length = root->snapshot_length;
+      r.contents = NULL;
+      VEC_safe_push (snapshot_block_s, ranges, &r);
+    }
+
+  if (VEC_length (snapshot_block_s, ranges) > 1)
+    qsort (VEC_address (snapshot_block_s, ranges),
+	   VEC_length (snapshot_block_s, ranges),
+	   sizeof (struct snapshot_block), compare_snapshot_blocks);
+
+  /* Merge the ranges that overlap or touch.  */
+  for (ix = 0; VEC_iterate (snapshot_block_s, ranges, ix, range); ++ix)
+    {
+      struct snapshot_block *last = NULL;
+
+      if (!VEC_empty (snapshot_block_s, snapshot_blocks))
+	last = VEC_last (snapshot_block_s, snapshot_blocks);
+
+      if (last != NULL
+	  && range->address - last->address <= last->length)
+	{
+	  ULONGEST end = range->address - last->address + range->length;
+
+	  if (end > last->length)
+	    last->length = end;
+	}
+      else
+	VEC_safe_push (snapshot_block_s, snapshot_blocks, range);
+    }
+
+  do_cleanups (back_to);
+
+  /* Read each block with one transfer.  A block that cannot be read
+     is dropped, and its roots are read separately as usual.  */
+  ix = 0;
+  while (ix < VEC_length (snapshot_block_s, snapshot_blocks))
+    {
+      struct snapshot_block *block
+	= VEC_index (snapshot_block_s, snapshot_blocks, ix);
+
+      block->contents = xmalloc (block->length);
+      if (target_read_memory (block->address, block->contents,
+			      block->length) != 0)
+	{
+	  xfree (block->contents);
+	  VEC_ordered_remove (snapshot_block_s, snapshot_blocks, ix);
+	}
+      else
+	++ix;
+    }
+
+  return make_cleanup (discard_snapshot_blocks, NULL);
+}
+
+/* If the memory of the lazy value VALUE was read by
+   varobj_prefetch_root_snapshots, fill in the contents of VALUE from
+   there and return non-zero.  Otherwise, return zero.  */
+
+static int
+fetch_from_snapshot_blocks (struct value *value)
+{
+  struct snapshot_block *block;
+  CORE_ADDR address;
+  ULONGEST length;
+  int ix;
+
+  if (VEC_empty (snapshot_block_s, snapshot_blocks)
+      || VALUE_LVAL (value) != lval_memory
+      || value_bitsize (value) != 0
+      || value_embedded_offset (value) != 0)
+    return 0;
+
+  address = value_address (value);
+  length = TYPE_LENGTH (check_typedef (value_enclosing_type (value)));
+  if (length != TYPE_LENGTH (check_typedef (value_type (value))))
+    return 0;
+
+  for (ix = 0;
+       VEC_iterate (snapshot_block_s, snapshot_blocks, ix, block);
+       ++ix)
+    {
+      if (address < block->address)
+	break;
+
+      if (address - block->address <= block->length
+	  && length <= block->length - (address - block->address))
+	{
+	  memcpy (value_contents_raw (value),
+		  block->contents + (address - block->address), length);
+	  set_value_lazy (value, 0);
+	  return 1;
+	}
+    }
+
+  return 0;
+}
+
+/* Observers for the target_resumed and memory_changed events.  The
+   memory read by varobj_prefetch_root_snapshots is stale once the
+   inferior runs or GDB writes to it, which evaluating the expression
+   of a root may do.  */
+
+static void
+varobj_target_resumed (ptid_t ptid)
+{
+  discard_snapshot_blocks (NULL);
+}
+
+static void
+varobj_memory_changed (struct inferior *inferior, CORE_ADDR addr,
+		       ssize_t len, const bfd_byte *data)
+{
+  discard_snapshot_blocks (NULL);
+}
+
+/* Read the memory of the value of the root varobj VAR, which has just
+   been updated, and save it as VAR's new snapshot.  If the previous
+   snapshot covered the same memory, return it; the caller must free
+   it.  Otherwise, return NULL.  */
+
+static gdb_byte *
+update_root_snapshot (struct varobj *var)
+{
+  struct varobj_root *root = var->root;
+  struct value *value = var->value;
+  gdb_byte *old_snapshot = root->snapshot;
+  CORE_ADDR old_address = root->snapshot_address;
+  int old_length = root->snapshot_length;
+  volatile struct gdb_exception except;
+  int length;
+
+  root->snapshot = NULL;
+  root->snapshot_address = 0;
+  root->snapshot_length = 0;
+
+  if (value == NULL
+      || var->not_fetched
+      || VALUE_LVAL (value) != lval_memory
+      || value_bitsize (value) != 0
+      || value_embedded_offset (value) != 0)
+    {
+      xfree (old_snapshot);
+      return NULL;
+    }
+
+  length = TYPE_LENGTH (check_typedef (value_type (value)));
+  if (length == 0 || length > VAROBJ_SNAPSHOT_MAX)
+    {
+      xfree (old_snapshot);
+      return NULL;
+    }
+
+  /* Fetching the whole root value reads it with a single transfer,
+     or none if -var-update already read it together with the other
+     roots, and lets the children copy their contents from it rather
+     than reading each one from the target separately.  */
+  TRY_CATCH (except, RETURN_MASK_ERROR)
+    {
+      if (value_lazy (value) && !fetch_from_snapshot_blocks (value))
+	value_fetch_lazy (value);
+    }
+
+  if (except.reason < 0 || !value_bytes_available (value, 0, length))
+    {
+      xfree (old_snapshot);
+      return NULL;
+    }
+
+  root->snapshot = xmalloc (length);
+  memcpy (root->snapshot, value_contents (value), length);
+  root->snapshot_address = value_address (value);
+  root->snapshot_length = length;
+
+  if (old_snapshot != NULL
+      && (old_address != root->snapshot_address
+	  || old_length != root->snapshot_length))
+    {
+      xfree (old_snapshot);
+      old_snapshot = NULL;
+    }
+
+  return old_snapshot;
+}
+
+/* Return non-zero if the value of the varobj VAR lies within the
+   memory of its root value and has the same bytes in OLD_SNAPSHOT, the
+   previous snapshot of that memory, as in the current one.  Such a
+   varobj need not be re-evaluated.  */
+
+static int
+varobj_snapshot_unchanged_p (struct varobj *var, const gdb_byte *old_snapshot)
+{
+  struct varobj_root *root = var->root;
+  struct varobj *parent;
+  CORE_ADDR address;
+  int length;
+  int offset;
+
+  if (var->pretty_printer != NULL
+      || var->updated
+      || var->not_fetched
+      || var->value == NULL
+      || value_lazy (var->value)
+      || VALUE_LVAL (var->value) != lval_memory
+      || value_bitsize (var->value) != 0
+      || value_embedded_offset (var->value) != 0)
+    return 0;
+
+  /* The address of a child reached through a pointer or reference
+     depends on memory outside the snapshot.  */
+  for (parent = var->parent; parent != NULL; parent = parent->parent)
+    {
+      struct type *type;
+
+      if (parent->type == NULL)
+	continue;
+
+      type = check_typedef (parent->type);
+      if (TYPE_CODE (type) == TYPE_CODE_PTR
+	  || TYPE_CODE (type) == TYPE_CODE_REF)
+	return 0;
+    }
+
+  address = value_address (var->value);
+  length = TYPE_LENGTH (check_typedef (value_type (var->value)));
+  if (address < root->snapshot_address
+      || address - root->snapshot_address > root->snapshot_length
+      || length > root->snapshot_length - (address - root->snapshot_address))
+    return 0;
+
+  offset = address - root->snapshot_address;
+  return memcmp (old_snapshot + offset, root->snapshot + offset, length) == 0;
+}
+
 /* Update the values for a variable and its children.  This is a
    two-pronged attack.  First, re-parse the value for the root's
    expression to see if it's changed.  Then go all the way
@@ -1974,6 +2427,7 @@ varobj_update (struct varobj **varp, int explicit)
   struct value *new;
   VEC (varobj_update_result) *stack = NULL;
   VEC (varobj_update_result) *result = NULL;
+  gdb_byte *old_snapshot = NULL;
 
   /* Frozen means frozen -- we don't check for any change in
      this varobj, including its going out of scope, or
@@ -2023,6 +2477,21 @@ varobj_update (struct varobj **varp, int explicit)
 	    VEC_safe_push (varobj_update_result, result, &r);
 	  return result;
 	}
+
+      if (varobj_memory_diff)
+	{
+	  old_snapshot = update_root_snapshot (*varp);
+	  if (r.type_changed)
+	    {
+	      xfree (old_snapshot);
+	      old_snapshot = NULL;
+	    }
+	}
+      else
+	{
+	  xfree ((*varp)->root->snapshot);
+	  (*varp)->root->snapshot = NULL;
+	}
             
       VEC_safe_push (varobj_update_result, stack, &r);
     }
@@ -2042,6 +2511,12 @@ varobj_update (struct varobj **varp, int explicit)
 
       VEC_pop (varobj_update_result, stack);
 
+      /* If the bytes of this variable did not change since the last
+	 update, its old value is still good.  */
+      if (!r.value_installed && old_snapshot != NULL
+	  && varobj_snapshot_unchanged_p (v, old_snapshot))
+	r.value_installed = 1;
+
       /* Update this variable, unless it's a root, which is already
 	 updated.  */
       if (!r.value_installed)
@@ -2197,6 +2672,7 @@ varobj_update (struct varobj **varp, int explicit)
     }
 
   VEC_free (varobj_update_result, stack);
+  xfree (old_snapshot);
 
   return result;
 }
@@ -2504,6 +2980,9 @@ new_root_variable (void)
   var->root->floating = 0;
   var->root->rootvar = NULL;
   var->root->is_valid = 1;
+  var->root->snapshot = NULL;
+  var->root->snapshot_address = 0;
+  var->root->snapshot_length = 0;
 
   return var;
 }
@@ -2530,6 +3009,7 @@ free_variable (struct varobj *var)
   if (is_root_p (var))
     {
       xfree (var->root->exp);
+      xfree (var->root->snapshot);
       xfree (var->root);
     }
 
@@ -4131,14 +4611,20 @@ ada_value_has_mutated (struct varobj *var, struct value *new_val,
      If only part (or none!) of the children have been fetched,
      then only check the ones we fetched.  It does not matter
      to the frontend whether a child that it has not fetched yet
-     has mutated or not. So just assume it hasn't.  */
+     has mutated or not. So just assume it hasn't.  Children that
+     were not listed yet have a NULL slot.  */
 
   restrict_range (var->children, &from, &to);
   for (i = from; i < to; i++)
-    if (strcmp (ada_varobj_get_name_of_child (new_val, new_type,
-					      var->name, i),
-		VEC_index (varobj_p, var->children, i)->name) != 0)
-      return 1;
+    {
+      varobj_p child = VEC_index (varobj_p, var->children, i);
+
+      if (child != NULL
+	  && strcmp (ada_varobj_get_name_of_child (new_val, new_type,
+						   var->name, i),
+		     child->name) != 0)
+	return 1;
+    }
 
   return 0;
 }
@@ -4170,6 +4656,9 @@ _initialize_varobj (void)
   varobj_table = xmalloc (sizeof_table);
   memset (varobj_table, 0, sizeof_table);
 
+  observer_attach_target_resumed (varobj_target_resumed);
+  observer_attach_memory_changed (varobj_memory_changed);
+
   add_setshow_zuinteger_cmd ("debugvarobj", class_maintenance,
 			     &varobjdebug,
 			     _("Set varobj debugging."),
@@ -4177,6 +4666,16 @@ _initialize_varobj (void)
 			     _("When non-zero, varobj debugging is enabled."),
 			     NULL, show_varobjdebug,
 			     &setlist, &showlist);
+
+  add_setshow_boolean_cmd ("mi-varobj-memory-diff", class_obscure,
+			   &varobj_memory_diff, _("\
+Set whether variable objects are updated by comparing their memory."), _("\
+Show whether variable objects are updated by comparing their memory."), _("\
+When on, -var-update reads the memory of each root variable object in a\n\
+single transfer and compares it with the memory read by the previous\n\
+update.  Children whose bytes did not change are not re-evaluated."),
+			   NULL, show_varobj_memory_diff,
+			   &setlist, &showlist);
 }
 
 /* Invalidate varobj VAR if it is tied to locals and re-create it if it is
@@ -160,6 +160,14 @@ extern void all_root_varobjs (void (*func) (struct varobj *var, void *data),
 extern VEC(varobj_update_result) *varobj_update (struct varobj **varp, 
 						 int explicit);
 
+/* When "set mi-varobj-memory-diff" is on, read the memory of all root
+   varobjs (only the floating ones if ONLY_FLOATING), merging
+   overlapping and adjacent ranges, so that the following updates of
+   the roots need not read it one root at a time.  Returns a cleanup
+   that discards the memory read.  */
+
+extern struct cleanup *varobj_prefetch_root_snapshots (int only_floating);
+
 extern void varobj_invalidate (void);
 
 extern int varobj_editable_p (struct varobj *var);